@@ -32,7 +32,7 @@ static void print_usage(char *bin_name) {
 #if USE_ASSEMBLYLINE
          ".asm,"
 #endif
-         ".bin,.o,.so}\n\
+         ".bin,.o,.a,.so}\n\
           -w N --width N        Number of elements in each array. Defaults to %d.\n\
           -o N --out N          Number of out-arrays. Defaults to %d.\n\
           -i N --in N           Number of in-arrays. Defaults to %d.\n\
@@ -40,6 +40,7 @@ static void print_usage(char *bin_name) {
           -b N --batch_size N   Number of iterations of each function per batch. Defaults to %d.\n\
           -s SYM --symbol SYM   SYM is the symbol being looked for in all .so and .o files.\n\
                                 Required for .so-files. Will resort in the first found symbol in .o files if SYM omitted.\n\
+                                Loaded from each member of .a files that defines it, or all functions if SYM omitted.\n\
                                 Will be ignored for .bin"
 #if USE_ASSEMBLYLINE
          " and .asm"
@@ -96,6 +97,12 @@ static int load(measuresuite_t ms, const char *filename, char *sym) {
     valid = 1;
   }
 
+  if (strcmp(dot, "a") == 0) {
+    int first_id = -1;
+    size_t num_loaded = 0;
+    return ms_load_archive(ms, filename, sym, &first_id, &num_loaded);
+  }
+
   if (!valid) {
     fprintf(stderr, "File >>%s<<must have a valid extention.\n", filename);
     return -1;
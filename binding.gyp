@@ -8,22 +8,32 @@
       "type": "static_library",
       "sources": [
         "./lib/src/alloc_helper.c",
+        "./lib/src/asm_cache.c",
+        "./lib/src/asm_incremental.c",
         "./lib/src/checker.c",
+        "./lib/src/code_arena.c",
+        "./lib/src/data_arena.c",
         "./lib/src/error/description.c",
         "./lib/src/evaluator.c",
         "./lib/src/fisher_yates.c",
-        "./lib/src/io/elf_file.c",
-        "./lib/src/io/elf_memory.c",
+        "./lib/src/hash.c",
+        "./lib/src/io/archive.c",
+        "./lib/src/io/elf_linker.c",
         "./lib/src/io/elf_parser.c",
         "./lib/src/io/file.c",
         "./lib/src/io/shared_object.c",
         "./lib/src/json.c",
+        "./lib/src/layout.c",
         "./lib/src/loader.c",
+        "./lib/src/memory.c",
         "./lib/src/measuresuite.c",
         "./lib/src/printer.c",
         "./lib/src/randomizer.c",
+        "./lib/src/result_cache.c",
         "./lib/src/struct_helpers.c",
-        "./lib/src/timer.c"
+        "./lib/src/sweep.c",
+        "./lib/src/timer.c",
+        "./lib/src/working_set.c"
       ],
       "include_dirs": [
         "./lib/src/include",
@@ -0,0 +1,168 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clock_gettime, strdup
+#define _POSIX_C_SOURCE 200809L
+
+// benchmarks generate_json against the previous snprintf-based generator, for
+// 100 functions x 100k batches
+#include "alloc_helper.h"
+#include "json.h"
+#include "struct_measuresuite.h"
+#include <inttypes.h>
+#include <measuresuite.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const size_t num_functions = 100;
+static const size_t num_batches = 100000;
+static const int rounds = 5;
+
+#define PRINT(...)                                                             \
+  size = json_end - json;                                                      \
+  len = snprintf(json, size, ##__VA_ARGS__);                                   \
+  if (len >= size) {                                                           \
+    goto enlarge;                                                              \
+  }                                                                            \
+  json += len;
+
+// the generator as it was before, reading from ms->results: snprintf per
+// number, restarting from scratch with twice the buffer when it is too small
+static int generate_json_snprintf(struct measuresuite *ms) {
+  const struct ms_results *res = &ms->results;
+  char *json = ms->json;
+  char *json_end = ms->json + ms->json_len - 1;
+
+  size_t size = 0; // available
+  size_t len = 0;  // written
+
+  PRINT("{\"stats\":{\"numFunctions\":%zu,\"runtime\":%" PRIu64
+        ",\"incorrect\":%zu,\"timer\":\"%s\"},\"functions\":[",
+        res->num_functions, res->runtime, res->incorrect,
+        res->timer == PMC ? "PMC" : "RDTSCP");
+  for (size_t i = 0; i < res->num_functions; i++) {
+    PRINT("{\"type\":\"BIN\",\"codeSize\":%zu},",
+          res->functions[i].code_size);
+  }
+  json--;
+  PRINT("],\"cycles\":[");
+  for (size_t i = 0; i < res->num_functions; i++) {
+    PRINT("[");
+    for (size_t run_i = 0; run_i < res->num_batches; run_i++) {
+      PRINT("%" PRIu64 ",", res->functions[i].cycles[run_i]);
+    }
+    json--;
+    PRINT("],");
+  }
+  json -= 1;
+  PRINT("]}");
+  return 0;
+
+enlarge:
+  ms->json_len *= 2;
+  if (realloc_or_fail(ms, (void **)&(ms->json), ms->json_len)) {
+    return 1;
+  }
+  return generate_json_snprintf(ms);
+}
+#undef PRINT
+
+static double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// @returns the best of some rounds of @param generate in ms, each starting
+// with the buffer size the previous init_json allocated
+static double bench(struct measuresuite *ms,
+                    int (*generate)(struct measuresuite *),
+                    size_t initial_len, char **copy) {
+  double best = 0;
+  for (int r = 0; r < rounds; r++) {
+    free(ms->json);
+    ms->json_len = initial_len;
+    ms->json = calloc(ms->json_len, 1);
+
+    const double start = now_ms();
+    if (ms->json == NULL || generate(ms)) {
+      fprintf(stderr, "generating the json failed\n");
+      exit(1);
+    }
+    const double elapsed = now_ms() - start;
+    best = r == 0 || elapsed < best ? elapsed : best;
+  }
+  *copy = strdup(ms->json);
+  return best;
+}
+
+int main() {
+  measuresuite_t ms = NULL;
+  if (ms_initialize(&ms, 1, 2, 1)) {
+    return 1;
+  }
+
+  // cycle counts as they usually are, 3 to 5 digits with some outliers
+  uint64_t *cycles = malloc(num_functions * num_batches * sizeof(uint64_t));
+  struct ms_function_result *functions =
+      calloc(num_functions, sizeof(struct ms_function_result));
+  if (cycles == NULL || functions == NULL) {
+    return 1;
+  }
+  srand(1);
+  for (size_t i = 0; i < num_functions * num_batches; i++) {
+    cycles[i] = 500 + rand() % 20000 + (rand() % 1000 == 0) * 1000000;
+  }
+  for (size_t i = 0; i < num_functions; i++) {
+    functions[i].type = BIN;
+    functions[i].cycles = &cycles[i * num_batches];
+  }
+  ms->results = (struct ms_results){
+      .version = MS_RESULTS_VERSION,
+      .num_functions = num_functions,
+      .num_batches = num_batches,
+      .timer = RDTSCP,
+      .functions = functions,
+  };
+
+  // what init_json allocated before: 1025 + 10 chars per function (of
+  // size_functions) and default batch (101)
+  const size_t old_initial_len = 1025 + 10 * ms->size_functions * 101;
+
+  char *old_json = NULL;
+  char *new_json = NULL;
+  const double old_ms =
+      bench(ms, generate_json_snprintf, old_initial_len, &old_json);
+  const double new_ms = bench(ms, generate_json, 1, &new_json);
+
+  const int same = strcmp(old_json, new_json) == 0;
+  printf("%zu functions x %zu batches, %zu bytes of json\n", num_functions,
+         num_batches, strlen(new_json));
+  printf("snprintf, grow and restart: %8.1f ms\n", old_ms);
+  printf("exact size, u64_to_dec:     %8.1f ms (%.1fx)\n", new_ms,
+         old_ms / new_ms);
+  printf("outputs are %s\n", same ? "identical" : "DIFFERENT");
+
+  free(old_json);
+  free(new_json);
+  free(cycles);
+  free(functions);
+  ms->results.version = 0;
+  ms_terminate(ms);
+  return same ? 0 : 1;
+}
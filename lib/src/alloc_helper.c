@@ -16,14 +16,12 @@
 #include "alloc_helper.h"
 #include "debug.h"
 #include "error/error.h"
+#include "memory.h"
 #include "struct_measuresuite.h"
 #include <errno.h> // errno
-#include <fcntl.h> // open
 #include <stdint.h>
-#include <stdlib.h>   // realloc
-#include <string.h>   // strerror
-#include <sys/mman.h> // mmap...
-#include <unistd.h>   // close
+#include <stdlib.h> // realloc
+#include <string.h> // strerror
 
 int realloc_or_fail(struct measuresuite *ms, void **dest, size_t new_len) {
 
@@ -40,95 +38,26 @@ int realloc_or_fail(struct measuresuite *ms, void **dest, size_t new_len) {
   return 0;
 }
 
-int map_rwx(struct measuresuite *ms, void **dest, size_t new_len) {
-  int fd_zero = open("/dev/zero", O_RDWR);
-  if (fd_zero == -1) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  *dest = mmap(NULL, new_len, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE,
-               fd_zero, 0);
-  // NOLINTNEXTLINE
-  if (*dest == MAP_FAILED) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  if (close(fd_zero) == -1) { /*No longer needed*/
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  return 0;
-}
-
-int realloc_rwx_or_fail(struct measuresuite *ms, void **dest, size_t old_len,
-                        size_t new_len) {
-  // not using mremap here, because it may clash with errno (and USE_GNU)
-  if (munmap(*dest, old_len)) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  return map_rwx(ms, *dest, new_len);
-}
-
-int unmap(struct measuresuite *ms, void *dest, size_t old_len) {
-  if (dest == NULL) {
-    return 0;
-  }
-  if (munmap(dest, old_len)) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  return 0;
-}
-
-int init_arithmetic_results(measuresuite_t ms, struct function_tuple *fct) {
-
-  /** Arithmetic Res */
-  /** +---------------------------------------------------------+ */
-  /** |         out1 , out2, ... , out[#numArgOut]              | */
-  /** +---------------------------------------------------------+ */
-  /**     ^---   out1 * arg_width */
-
-  /** Out1  each sizeof(u64)*/
-  /** +---------------------------------------------------------+ */
-  /** |         out1[0] , out1[1], ... , out1[#arg_width]       | */
-  /** +---------------------------------------------------------+ */
-
-  size_t size = ms->arg_width * ms->num_arg_out * sizeof(uint64_t);
-  DEBUG("init_arithmetic_results, size: %lu\n", size);
-
-  fct->arithmetic_results = malloc(size);
-
-  if (fct->arithmetic_results == NULL) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
-
-  return 0;
-}
-
 int init_cycle_results(struct measuresuite *ms) {
 
-  FOR_EACH_FUNCTION {
-
-    fct->cycle_results = malloc(ms->num_batches * sizeof(uint64_t));
-
-    if (fct->cycle_results == 0) {
-      ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
-      ms->additional_info = strerror(errno);
+  // the block of the previous measurement is reused, if large enough
+  const size_t needed = ms->num_functions * ms->num_batches;
+  if (ms->cycle_results == NULL || ms->cycle_results_size_u64 < needed) {
+    // at least one element, such that an empty block is not NULL
+    if (realloc_or_fail(ms, (void **)&ms->cycle_results,
+                        (needed + 1) * sizeof(uint64_t))) {
+      ms->cycle_results_size_u64 = 0;
       return 1;
     }
+    ms->cycle_results_size_u64 = needed;
+  }
+  // written after each batch, must not fault then
+  memory_lock(ms, ms->cycle_results, (needed + 1) * sizeof(uint64_t));
+
+  uint64_t *row = ms->cycle_results;
+  FOR_EACH_FUNCTION {
+    fct->cycle_results = row;
+    row += ms->num_batches;
   }
 
   return 0;
@@ -136,16 +65,9 @@ int init_cycle_results(struct measuresuite *ms) {
 
 int init_json(struct measuresuite *ms) {
 
-  const unsigned long char_per_long = 10;
-  // at max, every function poduces one long per batch
-  const unsigned long char_per_batch = char_per_long * ms->size_functions;
-
-  // every batch produces char_per_batch' chars
-  const unsigned long dynamic_length = char_per_batch * ms->num_batches;
-
-  // the static stuff...
-  const int len_other_stats = 1025;
-  ms->json_len = len_other_stats + dynamic_length;
+  // an empty string until the first measurement. generate_json grows it to
+  // the exact size needed.
+  ms->json_len = 1;
 
   ms->json = calloc(ms->json_len, sizeof(char));
   if (ms->json == NULL) {
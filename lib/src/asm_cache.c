@@ -0,0 +1,170 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "asm_cache.h"
+#include "debug.h"
+#include "error/error.h"
+#include "hash.h"
+#include "struct_measuresuite.h"
+#include <errno.h>  // errno
+#include <stdint.h> // SIZE_MAX
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy, memcmp, strerror
+
+static size_t bucket_of(const struct asm_cache *cache, uint64_t hash) {
+  return hash & (cache->num_buckets - 1);
+}
+
+static void lru_unlink(struct asm_cache *cache, size_t i) {
+  struct asm_cache_entry *e = &cache->entries[i];
+  if (e->lru_prev == ASM_CACHE_NONE) {
+    cache->lru_head = e->lru_next;
+  } else {
+    cache->entries[e->lru_prev].lru_next = e->lru_next;
+  }
+  if (e->lru_next == ASM_CACHE_NONE) {
+    cache->lru_tail = e->lru_prev;
+  } else {
+    cache->entries[e->lru_next].lru_prev = e->lru_prev;
+  }
+}
+
+static void lru_push_front(struct asm_cache *cache, size_t i) {
+  struct asm_cache_entry *e = &cache->entries[i];
+  e->lru_prev = ASM_CACHE_NONE;
+  e->lru_next = cache->lru_head;
+  if (cache->lru_head != ASM_CACHE_NONE) {
+    cache->entries[cache->lru_head].lru_prev = i;
+  }
+  cache->lru_head = i;
+  if (cache->lru_tail == ASM_CACHE_NONE) {
+    cache->lru_tail = i;
+  }
+}
+
+static void bucket_remove(struct asm_cache *cache, size_t i) {
+  size_t *link = &cache->buckets[bucket_of(cache, cache->entries[i].hash)];
+  while (*link != i) {
+    link = &cache->entries[*link].bucket_next;
+  }
+  *link = cache->entries[i].bucket_next;
+}
+
+void end_asm_cache(struct asm_cache *cache) {
+  for (size_t i = 0; i < cache->num; i++) {
+    free(cache->entries[i].text);
+  }
+  free(cache->entries);
+  free(cache->buckets);
+  memset(cache, 0, sizeof(*cache));
+  cache->lru_head = cache->lru_tail = ASM_CACHE_NONE;
+}
+
+int asm_cache_resize(struct measuresuite *ms, struct asm_cache *cache,
+                     size_t capacity) {
+  end_asm_cache(cache);
+  if (capacity == 0) {
+    return 0;
+  }
+
+  size_t num_buckets = 1;
+  while (num_buckets < capacity) {
+    num_buckets <<= 1;
+  }
+
+  cache->entries = malloc(capacity * sizeof(struct asm_cache_entry));
+  cache->buckets = malloc(num_buckets * sizeof(size_t));
+  if (cache->entries == NULL || cache->buckets == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    end_asm_cache(cache);
+    return 1;
+  }
+  for (size_t b = 0; b < num_buckets; b++) {
+    cache->buckets[b] = ASM_CACHE_NONE;
+  }
+  cache->capacity = capacity;
+  cache->num_buckets = num_buckets;
+  DEBUG("asm cache: %lu entries, %lu buckets\n", capacity, num_buckets);
+  return 0;
+}
+
+const struct asm_cache_entry *asm_cache_lookup(struct asm_cache *cache,
+                                               const char *text, size_t len,
+                                               size_t chunk_size) {
+  if (cache->capacity == 0) {
+    return NULL;
+  }
+
+  uint64_t hash = hash_bytes(text, len, chunk_size);
+  for (size_t i = cache->buckets[bucket_of(cache, hash)]; i != ASM_CACHE_NONE;
+       i = cache->entries[i].bucket_next) {
+    struct asm_cache_entry *e = &cache->entries[i];
+    if (e->hash == hash && e->chunk_size == chunk_size &&
+        e->text_len == len && memcmp(e->text, text, len) == 0) {
+      cache->hits++;
+      lru_unlink(cache, i);
+      lru_push_front(cache, i);
+      return e;
+    }
+  }
+  cache->misses++;
+  return NULL;
+}
+
+int asm_cache_insert(struct measuresuite *ms, struct asm_cache *cache,
+                     const char *text, size_t len, size_t chunk_size,
+                     const void *code, size_t code_len, int chunks) {
+  if (cache->capacity == 0) {
+    return 0;
+  }
+
+  char *blob = malloc(len + code_len);
+  if (blob == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  memcpy(blob, text, len);
+  memcpy(blob + len, code, code_len);
+
+  // take a fresh entry, or evict the least recently used one
+  size_t i = cache->num;
+  if (cache->num < cache->capacity) {
+    cache->num++;
+  } else {
+    i = cache->lru_tail;
+    DEBUG("asm cache: evicting entry %lu\n", i);
+    lru_unlink(cache, i);
+    bucket_remove(cache, i);
+    free(cache->entries[i].text);
+  }
+
+  struct asm_cache_entry *e = &cache->entries[i];
+  e->hash = hash_bytes(text, len, chunk_size);
+  e->chunk_size = chunk_size;
+  e->text = blob;
+  e->text_len = len;
+  e->code = (uint8_t *)blob + len;
+  e->code_len = code_len;
+  e->chunks = chunks;
+
+  size_t *bucket = &cache->buckets[bucket_of(cache, e->hash)];
+  e->bucket_next = *bucket;
+  *bucket = i;
+  lru_push_front(cache, i);
+  return 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ASM_CACHE_H
+#define ASM_CACHE_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * An asm cache maps an assembly string (and the chunk size it was assembled
+ * with) to the resulting machine code and chunk count, such that assembling the
+ * same string again is a memcpy instead of another run of AssemblyLine.
+ * It holds a fixed number of entries and evicts the least recently used one.
+ * A capacity of 0 disables it.
+ * ms->asm_cache holds whole ASM strings, ms->incremental.lines single lines.
+ */
+
+/**
+ * drops all entries of @param cache and makes room for @param capacity
+ * entries.
+ */
+int asm_cache_resize(struct measuresuite *ms, struct asm_cache *cache,
+                     size_t capacity);
+void end_asm_cache(struct asm_cache *cache);
+
+/**
+ * @returns the entry for @param len bytes of @param text assembled with
+ * @param chunk_size, or NULL if there is none. Counts a hit or miss.
+ */
+const struct asm_cache_entry *asm_cache_lookup(struct asm_cache *cache,
+                                               const char *text, size_t len,
+                                               size_t chunk_size);
+
+/**
+ * stores @param code_len bytes of @param code and @param chunks as the result
+ * of assembling @param text with @param chunk_size. No-op if @param cache is
+ * disabled.
+ */
+int asm_cache_insert(struct measuresuite *ms, struct asm_cache *cache,
+                     const char *text, size_t len, size_t chunk_size,
+                     const void *code, size_t code_len, int chunks);
+
+#endif
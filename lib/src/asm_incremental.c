@@ -0,0 +1,383 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "asm_incremental.h"
+#include "alloc_helper.h"
+#include "asm_cache.h"
+#include "debug.h"
+#include "error/error.h"
+#include "struct_measuresuite.h"
+#include <ctype.h>  // isspace, isalnum, tolower
+#include <stdint.h> // SIZE_MAX
+#include <stdlib.h> // free
+#include <string.h> // memchr, memcmp, memcpy
+
+int asm_incremental_resize(struct measuresuite *ms, size_t num_lines) {
+  struct asm_incremental *inc = &ms->incremental;
+  if (asm_cache_resize(ms, &inc->lines, num_lines)) {
+    return 1;
+  }
+#ifdef USE_ASSEMBLYLINE
+  if (num_lines > 0 && inc->al == NULL) {
+    inc->al = asm_create_instance(inc->line_code, sizeof(inc->line_code));
+  }
+#endif
+  return 0;
+}
+
+int end_asm_incremental(struct measuresuite *ms) {
+  struct asm_incremental *inc = &ms->incremental;
+  int ret = 0;
+#ifdef USE_ASSEMBLYLINE
+  if (inc->al != NULL && asm_destroy_instance(inc->al)) {
+    ms->errorno = E_LOAD__AL_FREE;
+    ret = 1;
+  }
+  inc->al = NULL;
+#endif
+  end_asm_cache(&inc->lines);
+  free(inc->line);
+  free(inc->code);
+  free(inc->labels);
+  free(inc->fixups);
+  memset(inc, 0, sizeof(*inc));
+  return ret;
+}
+
+#ifdef USE_ASSEMBLYLINE
+
+// makes sure that @param *buf holds at least @param needed elements of
+// @param elem_size bytes. @param *size is the current number of elements.
+static int grow(struct measuresuite *ms, void **buf, size_t *size,
+                size_t needed, size_t elem_size) {
+  if (*size >= needed) {
+    return 0;
+  }
+  size_t new_size = *size == 0 ? 64 : *size;
+  while (new_size < needed) {
+    new_size *= 2;
+  }
+  if (realloc_or_fail(ms, buf, new_size * elem_size)) {
+    *size = 0;
+    return 1;
+  }
+  *size = new_size;
+  return 0;
+}
+
+static int append_code(struct measuresuite *ms, const void *bytes, size_t len) {
+  struct asm_incremental *inc = &ms->incremental;
+  if (len == 0) {
+    return 0;
+  }
+  if (grow(ms, (void **)&inc->code, &inc->code_size, inc->code_len + len,
+           sizeof(uint8_t))) {
+    return 1;
+  }
+  memcpy(inc->code + inc->code_len, bytes, len);
+  inc->code_len += len;
+  return 0;
+}
+
+static int is_ident_char(char c) {
+  return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$' ||
+         c == '@';
+}
+
+// removes the comment and surrounding whitespace of [*begin, *end)
+static void strip(const char **begin, const char **end) {
+  const char *comment = memchr(*begin, ';', *end - *begin);
+  if (comment != NULL) {
+    *end = comment;
+  }
+  while (*begin < *end && isspace((unsigned char)**begin)) {
+    (*begin)++;
+  }
+  while (*end > *begin && isspace((unsigned char)*(*end - 1))) {
+    (*end)--;
+  }
+}
+
+// @returns the end of the identifier starting at @param begin
+static const char *ident_end(const char *begin, const char *end) {
+  while (begin < end && is_ident_char(*begin)) {
+    begin++;
+  }
+  return begin;
+}
+
+// if [*begin, end) starts with a label definition ('name:'), sets @param *name
+// and @param *name_len to it and advances *begin past the colon.
+static int take_label(const char **begin, const char *end, const char **name,
+                      size_t *name_len) {
+  const char *colon = ident_end(*begin, end);
+  if (colon == *begin || colon == end || *colon != ':') {
+    return 0;
+  }
+  *name = *begin;
+  *name_len = colon - *begin;
+  *begin = colon + 1;
+  strip(begin, &end);
+  return 1;
+}
+
+static size_t find_label(const struct asm_incremental *inc, const char *name,
+                         size_t name_len) {
+  for (size_t i = 0; i < inc->num_labels; i++) {
+    if (inc->labels[i].name_len == name_len &&
+        memcmp(inc->labels[i].name, name, name_len) == 0) {
+      return i;
+    }
+  }
+  return SIZE_MAX;
+}
+
+// @returns 1 if any identifier in [begin, end) is a label
+static int mentions_label(const struct asm_incremental *inc, const char *begin,
+                          const char *end) {
+  while (begin < end) {
+    const char *token_end = ident_end(begin, end);
+    if (token_end == begin) {
+      begin++;
+      continue;
+    }
+    if (find_label(inc, begin, token_end - begin) != SIZE_MAX) {
+      return 1;
+    }
+    begin = token_end;
+  }
+  return 0;
+}
+
+static const struct {
+  const char *suffix;
+  uint8_t cc;
+} condition_codes[] = {
+    {"o", 0x0},  {"no", 0x1},  {"b", 0x2},   {"c", 0x2},  {"nae", 0x2},
+    {"ae", 0x3}, {"nb", 0x3},  {"nc", 0x3},  {"e", 0x4},  {"z", 0x4},
+    {"ne", 0x5}, {"nz", 0x5},  {"be", 0x6},  {"na", 0x6}, {"a", 0x7},
+    {"nbe", 0x7}, {"s", 0x8},  {"ns", 0x9},  {"p", 0xa},  {"pe", 0xa},
+    {"np", 0xb}, {"po", 0xb},  {"l", 0xc},   {"nge", 0xc}, {"ge", 0xd},
+    {"nl", 0xd}, {"le", 0xe},  {"ng", 0xe},  {"g", 0xf},  {"nle", 0xf},
+};
+
+// writes the opcode of a rel32 branch with @param mnemonic to @param opcode.
+// @returns the length of the opcode, 0 if it is no such branch.
+static size_t branch_opcode(const char *mnemonic, size_t len,
+                            uint8_t opcode[2]) {
+  char lower[8] = {0};
+  if (len >= sizeof(lower)) {
+    return 0;
+  }
+  for (size_t i = 0; i < len; i++) {
+    lower[i] = (char)tolower((unsigned char)mnemonic[i]);
+  }
+
+  if (strcmp(lower, "jmp") == 0) {
+    opcode[0] = 0xe9;
+    return 1;
+  }
+  if (strcmp(lower, "call") == 0) {
+    opcode[0] = 0xe8;
+    return 1;
+  }
+  if (lower[0] != 'j') {
+    return 0;
+  }
+  for (size_t i = 0; i < sizeof(condition_codes) / sizeof(*condition_codes);
+       i++) {
+    if (strcmp(lower + 1, condition_codes[i].suffix) == 0) {
+      opcode[0] = 0x0f;
+      opcode[1] = 0x80 | condition_codes[i].cc;
+      return 2;
+    }
+  }
+  return 0;
+}
+
+// sets @param *emitted if [begin, end) is a branch to a label and has been
+// emitted as such.
+static int emit_branch(struct measuresuite *ms, const char *begin,
+                       const char *end, int *emitted) {
+  struct asm_incremental *inc = &ms->incremental;
+  *emitted = 0;
+
+  const char *mnemonic_end = ident_end(begin, end);
+  const char *operand = mnemonic_end;
+  const char *operand_end = end;
+  strip(&operand, &operand_end);
+  if (operand == operand_end ||
+      ident_end(operand, operand_end) != operand_end) {
+    return 0;
+  }
+  size_t label = find_label(inc, operand, operand_end - operand);
+  uint8_t opcode[2] = {0};
+  size_t opcode_len = branch_opcode(begin, mnemonic_end - begin, opcode);
+  if (label == SIZE_MAX || opcode_len == 0) {
+    return 0;
+  }
+
+  const uint8_t rel32[4] = {0};
+  if (grow(ms, (void **)&inc->fixups, &inc->size_fixups, inc->num_fixups + 1,
+           sizeof(struct asm_fixup)) ||
+      append_code(ms, opcode, opcode_len) ||
+      append_code(ms, rel32, sizeof(rel32))) {
+    return 1;
+  }
+  inc->fixups[inc->num_fixups++] = (struct asm_fixup){
+      .offset = inc->code_len - sizeof(rel32),
+      .label = label,
+  };
+  *emitted = 1;
+  return 0;
+}
+
+// appends the encoding of the instruction in [begin, end), either from the
+// memo or from AssemblyLine. Sets @param *unsupported if AL fails.
+static int emit_line(struct measuresuite *ms, const char *begin,
+                     const char *end, int *unsupported) {
+  struct asm_incremental *inc = &ms->incremental;
+  size_t len = end - begin;
+
+  const struct asm_cache_entry *memo =
+      asm_cache_lookup(&inc->lines, begin, len, 0);
+  if (memo != NULL) {
+    return append_code(ms, memo->code, memo->code_len);
+  }
+
+  // AL wants a NUL-terminated string
+  if (grow(ms, (void **)&inc->line, &inc->line_size, len + 2, sizeof(char))) {
+    return 1;
+  }
+  memcpy(inc->line, begin, len);
+  inc->line[len] = '\n';
+  inc->line[len + 1] = '\0';
+
+  asm_set_offset(inc->al, 0);
+  if (assemble_str(inc->al, inc->line)) {
+    DEBUG("incremental: cannot assemble '%s' on its own\n", inc->line);
+    *unsupported = 1;
+    return 0;
+  }
+  size_t code_len = asm_get_offset(inc->al);
+  return asm_cache_insert(ms, &inc->lines, begin, len, 0, inc->line_code,
+                          code_len, 0) ||
+         append_code(ms, inc->line_code, code_len);
+}
+
+// first pass: find all label definitions
+static int collect_labels(struct measuresuite *ms, const char *text,
+                          const char *text_end, int *unsupported) {
+  struct asm_incremental *inc = &ms->incremental;
+  for (const char *line = text; line < text_end;) {
+    const char *eol = memchr(line, '\n', text_end - line);
+    eol = eol == NULL ? text_end : eol;
+    const char *begin = line;
+    const char *end = eol;
+    line = eol + 1;
+
+    strip(&begin, &end);
+    const char *name = NULL;
+    size_t name_len = 0;
+    if (!take_label(&begin, end, &name, &name_len)) {
+      continue;
+    }
+    if (find_label(inc, name, name_len) != SIZE_MAX) {
+      *unsupported = 1; // let AL complain about the duplicate
+      return 0;
+    }
+    if (grow(ms, (void **)&inc->labels, &inc->size_labels,
+             inc->num_labels + 1, sizeof(struct asm_label))) {
+      return 1;
+    }
+    inc->labels[inc->num_labels++] = (struct asm_label){
+        .name = name,
+        .name_len = name_len,
+        .offset = SIZE_MAX,
+    };
+  }
+  return 0;
+}
+
+int asm_incremental_assemble(struct measuresuite *ms, const char *text,
+                             size_t len, const uint8_t **code,
+                             size_t *code_len) {
+  struct asm_incremental *inc = &ms->incremental;
+  inc->code_len = 0;
+  inc->num_labels = 0;
+  inc->num_fixups = 0;
+  *code = NULL;
+  *code_len = 0;
+
+  const char *text_end = text + len;
+  int unsupported = 0;
+  if (collect_labels(ms, text, text_end, &unsupported)) {
+    return 1;
+  }
+
+  // second pass: lay out the code
+  for (const char *line = text; line < text_end && !unsupported;) {
+    const char *eol = memchr(line, '\n', text_end - line);
+    eol = eol == NULL ? text_end : eol;
+    const char *begin = line;
+    const char *end = eol;
+    line = eol + 1;
+
+    strip(&begin, &end);
+    const char *name = NULL;
+    size_t name_len = 0;
+    if (take_label(&begin, end, &name, &name_len)) {
+      inc->labels[find_label(inc, name, name_len)].offset = inc->code_len;
+    }
+    if (begin == end) {
+      continue;
+    }
+
+    int emitted = 0;
+    if (emit_branch(ms, begin, end, &emitted)) {
+      return 1;
+    }
+    if (emitted) {
+      continue;
+    }
+    // e.g. 'lea rax, [rel label]' depends on the layout
+    if (mentions_label(inc, begin, end)) {
+      unsupported = 1;
+      break;
+    }
+    if (emit_line(ms, begin, end, &unsupported)) {
+      return 1;
+    }
+  }
+  if (unsupported) {
+    return 0;
+  }
+
+  // third pass: patch the branches
+  for (size_t i = 0; i < inc->num_fixups; i++) {
+    const struct asm_fixup *fixup = &inc->fixups[i];
+    const int64_t next_instruction = (int64_t)fixup->offset + 4;
+    const int32_t rel32 =
+        (int32_t)((int64_t)inc->labels[fixup->label].offset - next_instruction);
+    memcpy(inc->code + fixup->offset, &rel32, sizeof(rel32));
+  }
+
+  *code = inc->code;
+  *code_len = inc->code_len;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ASM_INCREMENTAL_H
+#define ASM_INCREMENTAL_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Incremental assembly builds the code for an ASM string line by line from
+ * memoized encodings of single lines (an asm cache, see asm_cache.h), such that
+ * only lines which have not been seen before are passed to AssemblyLine.
+ * Branches (jmp, jcc, call) to labels defined in the string are emitted with
+ * rel32 displacements and fixed up once all labels are placed. Thus, the code
+ * may be larger than what AssemblyLine would emit for the whole string (which
+ * may use rel8), but it computes the same.
+ */
+
+/**
+ * memoizes up to @param num_lines lines; 0 disables incremental assembly.
+ */
+int asm_incremental_resize(struct measuresuite *ms, size_t num_lines);
+int end_asm_incremental(struct measuresuite *ms);
+
+#ifdef USE_ASSEMBLYLINE
+/**
+ * lays out the code for @param len chars of @param text and sets @param *code
+ * and @param *code_len to it. The code stays valid until the next call.
+ * If the text cannot be assembled line by line (e.g. a line does not assemble
+ * on its own, or refers to a label other than as a branch target), @param
+ * *code is set to NULL and the caller has to assemble the whole string.
+ * @returns 1 only if memory could not be allocated.
+ */
+int asm_incremental_assemble(struct measuresuite *ms, const char *text,
+                             size_t len, const uint8_t **code,
+                             size_t *code_len);
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// madvise is not part of strict C17 / POSIX
+#define _DEFAULT_SOURCE
+
+#include "code_arena.h"
+#include "alloc_helper.h"
+#include "debug.h"
+#include "error/error.h"
+#include "memory.h"
+#include "struct_measuresuite.h"
+#include <stdlib.h>   // free
+#include <string.h>   // memset
+#include <sys/mman.h> // madvise
+
+// one chunk is mapped at init, more are mapped if that one is used up
+static const size_t code_arena_chunk_size = (size_t)2 << 20; // 2 MiB
+// smallest slot is one cache line. Slots are bumped in multiples of it from
+// page-aligned chunks, hence all are aligned to it.
+static const size_t code_arena_min_class_size = CODE_ARENA_SLOT_ALIGNMENT;
+
+static size_t class_size(size_t class) {
+  return code_arena_min_class_size << class;
+}
+
+static const size_t code_arena_max_class_size =
+    (size_t)64 << (CODE_ARENA_NUM_CLASSES - 1);
+
+// @returns the smallest class which can hold @param size bytes
+static size_t size_to_class(size_t size) {
+  size_t class = 0;
+  while (class_size(class) < size) {
+    class++;
+  }
+  return class;
+}
+
+// puts the unused tail of the current chunk onto the free lists, largest
+// classes first, such that no memory is lost when starting a new chunk.
+static void retire_chunk(struct code_arena *arena) {
+  size_t class = CODE_ARENA_NUM_CLASSES;
+  while (class-- > 0) {
+    while ((size_t)(arena->bump_end - arena->bump) >= class_size(class)) {
+      *(void **)arena->bump = arena->free_lists[class];
+      arena->free_lists[class] = arena->bump;
+      arena->bump += class_size(class);
+    }
+  }
+}
+
+static int add_chunk(struct measuresuite *ms) {
+  struct code_arena *arena = &ms->code_arena;
+
+  void *chunk = NULL;
+  size_t len = code_arena_chunk_size;
+  if (memory_map(ms, &len, 1, &chunk) ||
+      realloc_or_fail(ms, (void **)&arena->chunks,
+                      (arena->num_chunks + 1) * sizeof(void *))) {
+    return 1;
+  }
+  DEBUG("code arena: new chunk #%lu at %p\n", arena->num_chunks, chunk);
+
+  retire_chunk(arena);
+  arena->chunks[arena->num_chunks++] = chunk;
+  arena->bump = chunk;
+  arena->bump_end = (char *)chunk + code_arena_chunk_size;
+  return 0;
+}
+
+int init_code_arena(struct measuresuite *ms) {
+  memset(&ms->code_arena, 0, sizeof(ms->code_arena));
+  return add_chunk(ms);
+}
+
+int end_code_arena(struct measuresuite *ms) {
+  struct code_arena *arena = &ms->code_arena;
+  int ret = 0;
+  for (size_t i = 0; i < arena->num_chunks; i++) {
+    ret |= memory_unmap(ms, arena->chunks[i], code_arena_chunk_size);
+  }
+  free(arena->chunks);
+  memset(arena, 0, sizeof(*arena));
+  return ret;
+}
+
+int code_arena_alloc(struct measuresuite *ms, size_t size, void **dest,
+                     size_t *capacity) {
+  struct code_arena *arena = &ms->code_arena;
+
+  // too large for any class, those get their own mapping
+  if (size > code_arena_max_class_size) {
+    *capacity = size;
+    if (memory_map(ms, capacity, 1, dest)) {
+      return 1;
+    }
+    DEBUG("code arena: dedicated mapping of %lu bytes\n", *capacity);
+    return 0;
+  }
+
+  size_t class = size_to_class(size);
+  *capacity = class_size(class);
+
+  // recycle
+  if (arena->free_lists[class] != NULL) {
+    *dest = arena->free_lists[class];
+    arena->free_lists[class] = *(void **)*dest;
+    return 0;
+  }
+
+  // or bump
+  if ((size_t)(arena->bump_end - arena->bump) < *capacity && add_chunk(ms)) {
+    return 1;
+  }
+  *dest = arena->bump;
+  arena->bump += *capacity;
+  return 0;
+}
+
+int code_arena_free(struct measuresuite *ms, void *region, size_t capacity) {
+  if (region == NULL) {
+    return 0;
+  }
+  if (capacity > code_arena_max_class_size) {
+    return memory_unmap(ms, region, capacity);
+  }
+
+  size_t class = size_to_class(capacity);
+  *(void **)region = ms->code_arena.free_lists[class];
+  ms->code_arena.free_lists[class] = region;
+  return 0;
+}
+
+// @returns 1 if a loaded function has its code in a slot of the arena
+static int in_use(struct measuresuite *ms) {
+  for (size_t i = 0; i < ms->num_functions; i++) {
+    const struct function_tuple *fct = &ms->functions[i];
+    if (fct->type != SHARED_OBJECT && fct->code != NULL) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int code_arena_remap(struct measuresuite *ms) {
+  if (!in_use(ms)) {
+    return end_code_arena(ms) || init_code_arena(ms);
+  }
+
+  // the code cannot move, so the chunks only get what can be done in place
+  struct code_arena *arena = &ms->code_arena;
+  for (size_t i = 0; i < arena->num_chunks; i++) {
+    if (ms->memory_flags & MS_MEMORY_HUGE_PAGES) {
+      // not an error if the kernel has no transparent huge pages
+      madvise(arena->chunks[i], code_arena_chunk_size, MADV_HUGEPAGE);
+    }
+    memory_lock(ms, arena->chunks[i], code_arena_chunk_size);
+  }
+  return 0;
+}
+
+int code_arena_status(struct measuresuite *ms, enum ms_page_size *pages,
+                      int *locked) {
+  struct code_arena *arena = &ms->code_arena;
+  *pages = MS_PAGES_HUGE;
+  *locked = 1;
+  for (size_t i = 0; i < arena->num_chunks; i++) {
+    enum ms_page_size chunk_pages = MS_PAGES_SMALL;
+    int chunk_locked = 0;
+    if (memory_status(ms, arena->chunks[i], code_arena_chunk_size,
+                      &chunk_pages, &chunk_locked)) {
+      return 1;
+    }
+    if (chunk_pages < *pages) {
+      *pages = chunk_pages;
+    }
+    *locked &= chunk_locked;
+  }
+  return 0;
+}
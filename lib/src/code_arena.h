@@ -0,0 +1,63 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODE_ARENA_H
+#define CODE_ARENA_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * The code arena hands out the RWX memory for ASM/BIN/ELF functions.
+ * It mmaps (and pre-faults) one large chunk and bump-allocates slots from it,
+ * see memory_map.
+ * Slots come in power-of-two size classes (64 bytes up to 1 MiB); freed slots
+ * are put on a free list per class and handed out again without any syscall.
+ * Requests larger than the largest class get a dedicated mapping.
+ * Every slot starts at a multiple of CODE_ARENA_SLOT_ALIGNMENT.
+ */
+#define CODE_ARENA_SLOT_ALIGNMENT 64
+
+int init_code_arena(struct measuresuite *ms);
+int end_code_arena(struct measuresuite *ms);
+
+/**
+ * sets @param *dest to a slot of at least @param size bytes and
+ * @param *capacity to the actual size of that slot.
+ */
+int code_arena_alloc(struct measuresuite *ms, size_t size, void **dest,
+                     size_t *capacity);
+
+/**
+ * returns the slot at @param region to the arena. @param capacity must be the
+ * capacity reported by code_arena_alloc.
+ */
+int code_arena_free(struct measuresuite *ms, void *region, size_t capacity);
+
+/**
+ * applies the memory options to the arena: maps it anew if no function has
+ * code in it, else asks for transparent huge pages and locks it in place.
+ */
+int code_arena_remap(struct measuresuite *ms);
+
+/**
+ * sets @param *pages to the smallest pages backing any chunk, and
+ * @param *locked to 1 if all are locked. Dedicated mappings are not counted.
+ */
+int code_arena_status(struct measuresuite *ms, enum ms_page_size *pages,
+                      int *locked);
+
+#endif
@@ -0,0 +1,135 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "data_arena.h"
+#include "debug.h"  // DEBUG
+#include "memory.h" // memory_{map,unmap}
+#include <string.h> // memcpy
+
+// bytes every region of the arena starts at a multiple of
+#define DATA_ARENA_ALIGNMENT 64
+
+static size_t round_up(size_t len, size_t to) {
+  return (len + to - 1) / to * to;
+}
+
+// sets where the inputs and outputs go in @param arena, as its offsets say,
+// see struct data_arena
+static void set_geometry(const struct measuresuite *ms,
+                         struct data_arena *arena) {
+  const size_t in_bytes = ms->random_data_len * sizeof(uint64_t);
+  const size_t out_bytes = ms->arg_width * ms->num_arg_out * sizeof(uint64_t);
+  if (!arena->placed) {
+    arena->in_start = 0;
+    arena->in_size = round_up(in_bytes, DATA_ARENA_ALIGNMENT);
+    arena->out_start = 0;
+    arena->out_stride = round_up(out_bytes, DATA_ARENA_ALIGNMENT);
+    return;
+  }
+  // the outputs of each function in pages of their own
+  arena->in_start = arena->in_offset;
+  arena->in_size = round_up(arena->in_offset + in_bytes, MS_DATA_PAGE_SIZE);
+  arena->out_start = arena->out_offset;
+  arena->out_stride =
+      round_up(arena->out_offset + out_bytes, MS_DATA_PAGE_SIZE);
+}
+
+// moves the arena to a mapping with room for @param capacity functions, laid
+// out as set_geometry says in @param geometry. The arena stays as it is if
+// that cannot be mapped.
+static int move_to(struct measuresuite *ms, const struct data_arena *geometry,
+                   size_t capacity) {
+  struct data_arena next = *geometry;
+  size_t len = next.in_size + capacity * next.out_stride;
+  uint8_t *base = NULL;
+  if (memory_map(ms, &len, 0, (void **)&base)) {
+    return 1;
+  }
+  DEBUG("data arena: %lu bytes at %p\n", len, (void *)base);
+
+  // the old arena may be laid out differently, copy piece by piece
+  struct data_arena *arena = &ms->data_arena;
+  uint8_t *old_base = arena->base;
+  const size_t old_len = arena->len;
+  next.base = base;
+  next.len = len;
+  // whatever fits into the mapping, which is rounded up to pages
+  next.capacity = (len - next.in_size) / next.out_stride;
+  *arena = next;
+
+  uint64_t *inputs = (uint64_t *)(base + arena->in_start);
+  if (old_base != NULL) {
+    memcpy(inputs, ms->random_data, ms->random_data_len * sizeof(uint64_t));
+  }
+  ms->random_data = inputs;
+  const size_t out_bytes = ms->arg_width * ms->num_arg_out * sizeof(uint64_t);
+  for (size_t i = 0; i < ms->num_functions; i++) {
+    struct function_tuple *fct = &ms->functions[i];
+    uint64_t *outputs = data_arena_outputs(ms, i);
+    memcpy(outputs, fct->arithmetic_results, out_bytes);
+    fct->arithmetic_results = outputs;
+  }
+  return memory_unmap(ms, old_base, old_len);
+}
+
+int init_data_arena(struct measuresuite *ms) {
+  struct data_arena *arena = &ms->data_arena;
+  memset(arena, 0, sizeof(*arena));
+  set_geometry(ms, arena);
+  // one for each of the default a / b functions
+  return move_to(ms, arena, ms->size_functions);
+}
+
+int end_data_arena(struct measuresuite *ms) {
+  struct data_arena *arena = &ms->data_arena;
+  const int ret = memory_unmap(ms, arena->base, arena->len);
+  memset(arena, 0, sizeof(*arena));
+  ms->random_data = NULL;
+  return ret;
+}
+
+int data_arena_reserve(struct measuresuite *ms, size_t num_functions) {
+  struct data_arena *arena = &ms->data_arena;
+  if (num_functions <= arena->capacity) {
+    return 0;
+  }
+  size_t capacity = 2 * arena->capacity;
+  if (capacity < num_functions) {
+    capacity = num_functions;
+  }
+  return move_to(ms, arena, capacity);
+}
+
+uint64_t *data_arena_outputs(struct measuresuite *ms, size_t id) {
+  struct data_arena *arena = &ms->data_arena;
+  return (uint64_t *)(arena->base + arena->in_size + id * arena->out_stride +
+                      arena->out_start);
+}
+
+int data_arena_remap(struct measuresuite *ms) {
+  return move_to(ms, &ms->data_arena, ms->data_arena.capacity);
+}
+
+int data_arena_set_offsets(struct measuresuite *ms, int placed,
+                           size_t in_offset, size_t out_offset) {
+  // only taken over once the new arena is mapped
+  struct data_arena geometry = ms->data_arena;
+  geometry.placed = placed;
+  geometry.in_offset = placed ? in_offset : 0;
+  geometry.out_offset = placed ? out_offset : 0;
+  set_geometry(ms, &geometry);
+  return move_to(ms, &geometry, ms->data_arena.capacity);
+}
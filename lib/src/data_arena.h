@@ -0,0 +1,62 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DATA_ARENA_H
+#define DATA_ARENA_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * The data arena holds the arguments the functions are called with: the
+ * inputs (ms->random_data) and, after them, the outputs of each function
+ * (fct->arithmetic_results), each starting at a cache line. It is one mapping,
+ * backed as ms_set_memory_options asks for.
+ *
+ * +--------+-------------------+-------------------+-----
+ * | inputs | outputs of fct 0  | outputs of fct 1  | ...
+ * +--------+-------------------+-------------------+-----
+ * The outputs of each function are out1[0..arg_width), out2[..), ...
+ * With ms_set_data_offsets, the inputs and the outputs of each function get
+ * pages of their own, and start at the offsets into them.
+ */
+int init_data_arena(struct measuresuite *ms);
+int end_data_arena(struct measuresuite *ms);
+
+/**
+ * makes room for the outputs of @param num_functions functions. Moving the
+ * arena repoints the inputs and the outputs of all loaded functions.
+ */
+int data_arena_reserve(struct measuresuite *ms, size_t num_functions);
+
+// @returns the outputs of function @param id, which must be reserved
+uint64_t *data_arena_outputs(struct measuresuite *ms, size_t id);
+
+/**
+ * moves the arena to a new mapping of the same size, e.g. after the memory
+ * options changed.
+ */
+int data_arena_remap(struct measuresuite *ms);
+
+/**
+ * lays the arena out compactly if @param placed is 0, else with the inputs
+ * @param in_offset bytes and the outputs @param out_offset bytes into pages,
+ * see ms_set_data_offsets.
+ */
+int data_arena_set_offsets(struct measuresuite *ms, int placed,
+                           size_t in_offset, size_t out_offset);
+
+#endif
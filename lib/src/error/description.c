@@ -34,7 +34,14 @@ static struct error_desc {
     {E_INVALID_INPUT__NUM_IDX_OOB, "The provided index is too large. There is not that many functions loaded."},
     {E_INVALID_INPUT__FILE, "The given file is cannot be stat'ed."},
     {E_INVALID_INPUT__IN_TOO_LARGE, "The product of num_arg_in and arg_width is too large."},
-    {E_INVALID_INPUT__SO_FROM_MEMORY,"Shared objects cannot be loaded from memory. Use `load_file` for this."},
+    {E_INVALID_INPUT__NO_MEASUREMENT, "There are no results (anymore). Measure first, cycles can only be taken once per measurement."},
+    {E_INVALID_INPUT__RESULTS_VERSION, "The requested version of struct ms_results is newer than the one of this library."},
+    {E_INVALID_INPUT__PLACEMENT, "Invalid placement. The alignment must be a power of two up to 4096 (or 0 for the default), the offset below it, and the code must be movable (no SHARED_OBJECT, no ELF with absolute addresses into itself, offsets of ELF code a multiple of its largest section alignment)."},
+    {E_INVALID_INPUT__LAYOUT, "Invalid layout randomization. The code window must be 0 or a power of two up to 4096, the data window 0 or a power of two from 64 to 4096. The code (data) cannot be swept while it is randomized."},
+    {E_INVALID_INPUT__DATA_OFFSET, "Invalid data offsets. Both must be multiples of 8 below 4096 (or both MS_DATA_OFFSET_COMPACT), and a data sweep needs between 1 and 512 offsets."},
+    {E_INVALID_INPUT__ALIASING, "Invalid aliasing. Each out argument can alias one in argument (0 up to num_arg_in - 1) or none (MS_ALIAS_NONE), and each in argument can be aliased by one out argument at most."},
+    {E_INVALID_INPUT__WORKING_SET, "Invalid working set. It must hold at least one set of inputs and outputs, rounded up to a cache line."},
+    {E_INVALID_INPUT__SO_FROM_MEMORY,"Shared objects can only be loaded from memory with their size and a symbol, and cannot replace code."},
     {E_INTERNAL_RANDOMNESS__AI__MALLOC, "Cannot malloc memory for random data."},
     {E_INTERNAL_RANDOMNESS__AI__OPEN_FILE, "Cannot open randomness file."},
     {E_INTERNAL_RANDOMNESS__AI__READ, "Cannot read randomness file."},
@@ -46,17 +53,28 @@ static struct error_desc {
     {E_INTERNAL_MEASURE__AI__DLSYM, "Failed to dlsym."},
     {E_INTERNAL_MEASURE__AI__DLOPEN, "Failed to dlopen."},
     {E_INTERNAL_MEASURE__AI__ALLOC, "Failed to allocate memory."},
+    {E_INTERNAL_MEASURE__AI__SMAPS, "Failed to read /proc/self/smaps."},
+    {E_INTERNAL_MEASURE__AI__CACHE_INFO, "Failed to read the cache sizes from /sys/devices/system/cpu/cpu0/cache."},
     {E_INTERNAL_FUNCTIONS__NOTHING_TO_UNLOAD, "Failed to unload function, because none have been loaded. "},
     {E_INTERNAL_INITIALIZE__ALLOC, "Failed to allocate memory internally. Out Of Memory?"},
     {E_LOAD__ASM_FILE, "Cannot load ASM_FILE."},
     {E_LOAD__ASM_DATA, "Cannot load ASM_DATA."},
     {E_LOAD__SO_FILE, "Cannot load Shared object file."},
+    {E_LOAD__SO_MEMFD, "Cannot write the shared object to a memfd (memfd_create or write failed)."},
     {E_LOAD__AL_FREE, "Cannot unload Assemblyline. Maybe is has been unloaded alraedy."},
     {E_LOAD__ELF_FILE_IO, "An File I/O error occurred while loading the ELF file."},
     {E_LOAD__ELF_FILE_INVALID_ELF, "The ELF file does not have the expected format."},
     {E_LOAD__ELF_MEM_INVALID_ELF, "The ELF file (memory) does not have the expected format."},
     {E_LOAD__ELF_FILE_MALLOC, "An allocation error occurred while loading the ELF file."},
-    {E_NO_ASSEMBLYLINE, "Cannot use ASM files, because MeasureSuite was compiles without it. Install AssemblyLine and recompile, or assemble yourself and load object file."}
+    {E_LOAD__ELF_SYMBOL_NOT_FOUND, "The requested symbol is not defined in the ELF file."},
+    {E_LOAD__ELF_UNDEFINED_REFERENCE, "The code references a symbol which is not defined in the ELF file (e.g. a libc function). Only self-contained object files can be linked."},
+    {E_LOAD__ELF_RELOCATION, "The ELF file contains a relocation which is not supported (only R_X86_64_64, PC32, PLT32, 32, 32S and PC64 are), or whose value does not fit. Compile with -fPIC or -fPIE."},
+    {E_LOAD__ARCHIVE_IO, "A File I/O error occurred while loading the archive."},
+    {E_LOAD__ARCHIVE_INVALID, "The archive does not have the expected format (ar, GNU or BSD; thin archives are not supported)."},
+    {E_NO_ASSEMBLYLINE, "Cannot use ASM files, because MeasureSuite was compiles without it. Install AssemblyLine and recompile, or assemble yourself and load object file."},
+    {E_RESULT_CACHE__DISABLED, "The result cache is disabled. Enable it with ms_set_result_cache first."},
+    {E_RESULT_CACHE__IO, "An File I/O error occurred while reading or writing the result cache file."},
+    {E_RESULT_CACHE__INVALID_FILE, "The result cache file does not have the expected format."}
     // clang-format on
 };
 
@@ -29,6 +29,13 @@ typedef enum {
   E_INVALID_INPUT__IN_TOO_LARGE,
   E_INVALID_INPUT__SO_FROM_MEMORY,
   E_INVALID_INPUT__FILE,
+  E_INVALID_INPUT__NO_MEASUREMENT,
+  E_INVALID_INPUT__RESULTS_VERSION,
+  E_INVALID_INPUT__PLACEMENT,
+  E_INVALID_INPUT__LAYOUT,
+  E_INVALID_INPUT__DATA_OFFSET,
+  E_INVALID_INPUT__ALIASING,
+  E_INVALID_INPUT__WORKING_SET,
   E_INTERNAL_RANDOMNESS__AI__MALLOC,
   E_INTERNAL_RANDOMNESS__AI__OPEN_FILE,
   E_INTERNAL_RANDOMNESS__AI__READ,
@@ -40,17 +47,28 @@ typedef enum {
   E_INTERNAL_MEASURE__AI__DLSYM,
   E_INTERNAL_MEASURE__AI__DLOPEN,
   E_INTERNAL_MEASURE__AI__ALLOC,
+  E_INTERNAL_MEASURE__AI__SMAPS,
+  E_INTERNAL_MEASURE__AI__CACHE_INFO,
   E_INTERNAL_INITIALIZE__ALLOC,
   E_INTERNAL_FUNCTIONS__NOTHING_TO_UNLOAD,
   E_LOAD__ASM_FILE,
   E_LOAD__SO_FILE,
+  E_LOAD__SO_MEMFD,
   E_LOAD__ASM_DATA,
   E_LOAD__ELF_FILE_IO,
   E_LOAD__ELF_FILE_MALLOC,
   E_LOAD__ELF_FILE_INVALID_ELF,
   E_LOAD__ELF_MEM_INVALID_ELF,
+  E_LOAD__ELF_SYMBOL_NOT_FOUND,
+  E_LOAD__ELF_UNDEFINED_REFERENCE,
+  E_LOAD__ELF_RELOCATION,
+  E_LOAD__ARCHIVE_IO,
+  E_LOAD__ARCHIVE_INVALID,
   E_LOAD__AL_FREE,
   E_NO_ASSEMBLYLINE,
+  E_RESULT_CACHE__DISABLED,
+  E_RESULT_CACHE__IO,
+  E_RESULT_CACHE__INVALID_FILE,
 } ERROR_NUMBER;
 
 #endif
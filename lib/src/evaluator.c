@@ -19,64 +19,87 @@
 #include "checker.h"             // check
 #include "debug.h"               // DEBUG
 #include "fisher_yates.h"        // shuffle_permutations
-#include "json.h"                // generate_json_from_measurement_results
+#include "layout.h"              // layout_{begin,shuffle,end}
 #include "randomizer.h"          // randomize
+#include "result_cache.h"        // result_cache_{lookup,store}_all
 #include "struct_measuresuite.h" // struct ms; struct function_tuple
 #include "timer.h"               // {start,stop}_timer / current_timestamp
+#include "working_set.h"         // working_set_begin
 #include <assert.h>              // assert
 #include <stdio.h>               // snprintf
 #include <stdlib.h>              // alloc / size_t
 #include <string.h>              // memset / strerror
 
+// sets @param args to the out arguments at @param out, then the in arguments
+// at @param in. Out arguments aliasing an in argument (see ms_set_aliasing) are
+// passed for both.
+static void fill_args(struct measuresuite *ms, uint64_t *in, uint64_t *out,
+                      uint64_t *args[6]) {
+  // we always call the function with six arguments. It itself will then take
+  // which ever it needs.
+  const size_t width = ms->arg_width;
+  const size_t num_out = ms->num_arg_out;
+  for (size_t i = 0; i < num_out; i++) {
+    args[i] = out + i * width;
+  }
+  for (size_t i = 0; num_out + i < 6; i++) {
+    args[num_out + i] = in + i * width;
+  }
+  if (ms->num_aliased == 0) {
+    return;
+  }
+  for (size_t j = 0; j < num_out; j++) {
+    if (ms->aliases[j] != MS_ALIAS_NONE) {
+      args[num_out + ms->aliases[j]] = args[j];
+    }
+  }
+}
+
+// refills the aliased arguments of @param args, @param offset uint64_t's on,
+// with the inputs at @param in
+static void restore_aliased(struct measuresuite *ms, uint64_t *const *args,
+                            size_t offset, const uint64_t *in) {
+  const size_t width = ms->arg_width;
+  for (size_t j = 0; j < ms->num_arg_out; j++) {
+    if (ms->aliases[j] != MS_ALIAS_NONE) {
+      memcpy(args[j] + offset, in + offset + ms->aliases[j] * width,
+             width * sizeof(uint64_t));
+    }
+  }
+}
+
+// calls @param fct once with the inputs at @param in and the outputs at
+// @param out, untimed
+static void run_once(struct measuresuite *ms, struct function_tuple *fct,
+                     uint64_t *in, uint64_t *out) {
+  uint64_t *args[6] = {0};
+  fill_args(ms, in, out, args);
+  restore_aliased(ms, args, 0, in);
+  int (*func)(uint64_t * out, ...) = fct->code;
+  func(args[0], args[1], args[2], args[3], args[4], args[5]);
+}
+
+// calls @param fct with the inputs at @param in and the outputs at @param out,
+// or with the next sets of the working set if there is one
 static void run_batch(struct measuresuite *ms, struct function_tuple *fct,
-                      uint64_t *count) {
+                      uint64_t *in, uint64_t *out, uint64_t *count) {
 
-  uint64_t *out = fct->arithmetic_results;
-  // we always call the function with three in-arguments. It itself will then
-  // take which ever it needs. However, the positon of the in-args is dependent
-  // on the num out args, thus the switch
-  //
   size_t batch_size = ms->batch_size; // working copy
-  size_t width = ms->arg_width;
-
-  // this is the initial config for the case that we have one out-variable and
-  // at most 5 in vars
-  uint64_t *arg0 = out;
-  uint64_t *arg1 = ms->random_data;
-  uint64_t *arg2 = ms->random_data + width;
-  uint64_t *arg3 = ms->random_data + (size_t)2 * width;
-  uint64_t *arg4 = ms->random_data + (size_t)3 * width;
-  uint64_t *arg5 = ms->random_data + (size_t)4 * width;
-
-  if (ms->num_arg_out == 1) {
-    // do nothing, stay with default
-  } else if (ms->num_arg_out == 2) {
-    // shift them all one
-    arg5 = arg4;
-    arg4 = arg3;
-    arg3 = arg2;
-    arg2 = arg1;
-    // and add the new out
-    arg1 = out + width;
-  } else if (ms->num_arg_out == 3) {
-    arg5 = arg3;
-    arg4 = arg2;
-    arg3 = arg1;
-    arg2 = out + (size_t)2 * width;
-    arg1 = out + width;
-  } else if (ms->num_arg_out == 4) {
-    arg5 = arg2;
-    arg4 = arg1;
-    arg3 = out + (size_t)3 * width;
-    arg2 = out + (size_t)2 * width;
-    arg1 = out + width;
-  } else {
-    arg5 = arg1;
-    arg4 = out + (size_t)4 * width;
-    arg3 = out + (size_t)3 * width;
-    arg2 = out + (size_t)2 * width;
-    arg1 = out + width;
+
+  // one argument set, unless striding through the working set
+  struct working_set *ws = &ms->working_set;
+  size_t stride = 0; // uint64_t's between two sets
+  size_t num_sets = 1;
+  size_t next = 0;
+  if (ws->num_sets != 0) {
+    in = ws->pool;
+    out = ws->pool + ms->arg_width * ms->num_arg_in;
+    stride = ws->set_size;
+    num_sets = ws->num_sets;
+    next = ws->next;
   }
+  uint64_t *args[6] = {0};
+  fill_args(ms, in, out, args);
 
   int (*func)(uint64_t * out, ...) = fct->code;
   assert(func != NULL);
@@ -85,32 +108,123 @@ static void run_batch(struct measuresuite *ms, struct function_tuple *fct,
         func, batch_size);
 
   uint64_t start_time = 0;
-  start_timer(ms, &start_time);
-
-  while (batch_size > 0) {
-    func(arg0, arg1, arg2, arg3, arg4, arg5);
-    batch_size--;
+  if (ms->num_aliased != 0) {
+    // the aliased inputs are refilled before each call, which is therefore
+    // timed on its own
+    *count = 0;
+    for (size_t call = 0; call < batch_size; call++) {
+      const size_t offset = next * stride;
+      restore_aliased(ms, args, offset, in);
+      start_timer(ms, &start_time);
+      func(args[0] + offset, args[1] + offset, args[2] + offset,
+           args[3] + offset, args[4] + offset, args[5] + offset);
+      *count += stop_timer(ms, start_time);
+      if (++next == num_sets) {
+        next = 0;
+      }
+    }
+  } else if (stride != 0) {
+    start_timer(ms, &start_time);
+    for (size_t call = 0; call < batch_size; call++) {
+      const size_t offset = next * stride;
+      func(args[0] + offset, args[1] + offset, args[2] + offset,
+           args[3] + offset, args[4] + offset, args[5] + offset);
+      if (++next == num_sets) {
+        next = 0;
+      }
+    }
+    *count = stop_timer(ms, start_time);
+  } else {
+    start_timer(ms, &start_time);
+    while (batch_size > 0) {
+      func(args[0], args[1], args[2], args[3], args[4], args[5]);
+      batch_size--;
+    }
+    *count = stop_timer(ms, start_time);
   }
 
-  *count = stop_timer(ms, start_time);
+  if (ws->num_sets != 0) {
+    ws->next = next;
+  }
   DEBUG("Done. Ran for %lu cycles.\n", *count);
 }
 
-int run_measurement(struct measuresuite *ms) {
+// snapshots the functions' types and cycles into ms->results
+static int fill_results(struct measuresuite *ms, size_t num_batches,
+                        uint64_t runtime, size_t check_result) {
+  if (ms->function_results_len < ms->num_functions) {
+    if (realloc_or_fail(
+            ms, (void **)&ms->function_results,
+            ms->num_functions * sizeof(struct ms_function_result))) {
+      return 1;
+    }
+    ms->function_results_len = ms->num_functions;
+  }
 
-  // init result indicator
-  size_t check_result = 0;
-  if (init_cycle_results(ms)) {
-    return 1;
+  for (size_t i = 0; i < ms->num_functions; i++) {
+    struct function_tuple *fct = &ms->functions[i];
+    struct ms_function_result *res = &ms->function_results[i];
+    res->type = fct->type;
+    res->chunks = 0;
+#ifdef USE_ASSEMBLYLINE
+    res->chunks = fct->chunks;
+#endif
+    res->cycles = fct->cycle_results;
+    res->code_size = fct->type == SHARED_OBJECT ? 0 : fct->code_size_bytes;
+    res->member = fct->member;
+    res->page_offset = (uintptr_t)fct->code & 4095;
+  }
+
+  ms->results = (struct ms_results){
+      .version = MS_RESULTS_VERSION,
+      .num_functions = ms->num_functions,
+      .num_batches = num_batches,
+      .batch_size = ms->batch_size,
+      .runtime = runtime,
+      .incorrect = check_result,
+      .timer = ms_get_timer(ms),
+      .functions = ms->function_results,
   };
+  return 0;
+}
 
-  // START MEASUREMENT
-  uint64_t start_time = current_timestamp();
+// passes the samples of @param batch_i to the batch callback.
+// @returns non-zero if the measurement should stop
+static int report_batch(struct measuresuite *ms, size_t batch_i) {
+  for (size_t i = 0; i < ms->num_functions; i++) {
+    const struct function_tuple *fct = &ms->functions[i];
+    if (fct->cached_result != NULL && batch_i >= ms->result_cache.top_up) {
+      ms->batch_samples[i] = result_cache_sample(fct, batch_i);
+    } else {
+      ms->batch_samples[i] = fct->cycle_results[batch_i];
+    }
+  }
+  return ms->batch_callback(ms->batch_callback_ctx, batch_i, ms->batch_samples,
+                            ms->num_functions) != MS_BATCH_CONTINUE;
+}
 
-  DEBUG("Evaluating %lu batches\n", ms->num_batches);
-  for (size_t batch_i = 0; batch_i < ms->num_batches; batch_i++) {
+// moves the rows of the first @param num_batches cycles of each function
+// together, such that the block is as if only those had been measured
+static void compact_cycle_results(struct measuresuite *ms,
+                                  size_t num_batches) {
+  uint64_t *row = ms->cycle_results;
+  FOR_EACH_FUNCTION {
+    memmove(row, fct->cycle_results, num_batches * sizeof(uint64_t));
+    fct->cycle_results = row;
+    row += num_batches;
+  }
+}
 
-    if (randomize(ms) != 0 || shuffle_permutations(ms) != 0) {
+// runs @param num_batches batches of all functions. Sets @param check_result
+// to the first function which calculated something else than the one before,
+// and @param stopped_after to the batches run if the callback stopped early.
+static int run_batches(struct measuresuite *ms, size_t num_batches,
+                       size_t *check_result, size_t *stopped_after) {
+  DEBUG("Evaluating %lu batches\n", num_batches);
+  for (size_t batch_i = 0; batch_i < num_batches; batch_i++) {
+
+    if (randomize(ms) != 0 || shuffle_permutations(ms) != 0 ||
+        layout_shuffle(ms) != 0) {
       return 1;
     }
 
@@ -121,10 +235,25 @@ int run_measurement(struct measuresuite *ms) {
       // get the function to measure
       size_t function_index = ms->permutation[func_i];
       struct function_tuple *fct = &ms->functions[function_index];
+      if (fct->cached_result != NULL && batch_i >= ms->result_cache.top_up) {
+        continue;
+      }
 
       // measure
       DEBUG("Run batch %lu for function %lu\n", batch_i, function_index);
-      run_batch(ms, fct, &fct->cycle_results[batch_i]);
+      uint64_t *out = ms->layout.out;
+      if (out == NULL) {
+        out = fct->arithmetic_results;
+      }
+      run_batch(ms, fct, ms->layout.in, out, &fct->cycle_results[batch_i]);
+      if (ms->enable_check && ms->working_set.num_sets != 0) {
+        // the last call took some set of the pool, check the normal inputs
+        run_once(ms, fct, ms->layout.in, out);
+      }
+      if (out != fct->arithmetic_results) {
+        memcpy(fct->arithmetic_results, out,
+               ms->layout.out_size * sizeof(uint64_t));
+      }
     }
 
     if (ms->enable_check) {
@@ -139,18 +268,78 @@ int run_measurement(struct measuresuite *ms) {
         DEBUG("Checking correctness for function %lu and previous\n", func_i);
         if (check(ms->arg_width * ms->num_arg_out, fct->arithmetic_results,
                   prev->arithmetic_results)) {
-          check_result = func_i;
+          *check_result = func_i;
           break;
         };
       }
     }
+
+    // outside of the timed region of each function
+    if (ms->batch_callback != NULL && report_batch(ms, batch_i)) {
+      DEBUG("Batch callback stopped after batch %lu\n", batch_i);
+      *stopped_after = batch_i + 1;
+      break;
+    }
+  }
+  return 0;
+}
+
+int run_measurement(struct measuresuite *ms) {
+
+  // results of a previous measurement are void from now on
+  ms->results.version = 0;
+  ms->json_valid = 0;
+
+  // init result indicator
+  size_t check_result = 0;
+  if (init_cycle_results(ms)) {
+    return 1;
+  };
+
+  // functions with cached results are only run in the top up batches
+  size_t num_batches = ms->num_batches;
+  result_cache_lookup_all(ms, &num_batches);
+
+  if (ms->batch_callback != NULL &&
+      realloc_or_fail(ms, (void **)&ms->batch_samples,
+                      (ms->num_functions + 1) * sizeof(uint64_t))) {
+    return 1;
   }
+  // set if the batch callback asks to stop
+  size_t stopped_after = 0;
+
+  if (working_set_begin(ms) || layout_begin(ms)) {
+    return 1;
+  }
+
+  // START MEASUREMENT
+  uint64_t start_time = current_timestamp();
+
+  const int ret = run_batches(ms, num_batches, &check_result, &stopped_after);
 
   unsigned long elapsed_in_sec = current_timestamp() - start_time;
 
-  if (generate_json(ms, elapsed_in_sec, check_result)) {
+  // put the code back, also if a batch failed
+  ERROR_NUMBER errorno = ms->errorno;
+  if (layout_end(ms)) {
+    return 1;
+  }
+  if (ret) {
+    ms->errorno = errorno;
     return 1;
   }
 
-  return 0;
+  if (stopped_after != 0) {
+    // a partial measurement is not stored in the result cache
+    result_cache_abort_all(ms, stopped_after);
+    compact_cycle_results(ms, stopped_after);
+    return fill_results(ms, stopped_after, elapsed_in_sec, check_result);
+  }
+
+  if (result_cache_store_all(ms)) {
+    return 1;
+  }
+
+  // the JSON is only generated if asked for, in ms_get_json
+  return fill_results(ms, ms->num_batches, elapsed_in_sec, check_result);
 }
@@ -0,0 +1,52 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hash.h"
+#include <string.h> // memcpy
+
+static const uint64_t prime_1 = 0x9e3779b97f4a7c15ULL;
+static const uint64_t prime_2 = 0xbf58476d1ce4e5b9ULL;
+static const uint64_t prime_3 = 0x94d049bb133111ebULL;
+
+static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// final avalanche (splitmix64)
+static uint64_t finalize(uint64_t h) {
+  h = (h ^ (h >> 30)) * prime_2;
+  h = (h ^ (h >> 27)) * prime_3;
+  return h ^ (h >> 31);
+}
+
+uint64_t hash_bytes(const void *data, size_t len, uint64_t seed) {
+  const uint8_t *p = data;
+  uint64_t h = seed ^ (len * prime_1);
+
+  for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, p, sizeof(word)); // unaligned load
+    p += sizeof(word);
+    h = rotl(h ^ (word * prime_2), 31) * prime_1;
+  }
+
+  // remaining 0..7 bytes, zero padded
+  if (len > 0) {
+    uint64_t word = 0;
+    memcpy(&word, p, len);
+    h = rotl(h ^ (word * prime_2), 31) * prime_1;
+  }
+
+  return finalize(h);
+}
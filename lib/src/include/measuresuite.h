@@ -22,6 +22,7 @@
 #include <stdio.h>  // FILE
 
 typedef struct measuresuite *measuresuite_t;
+typedef struct ms_elf *ms_elf_t;
 
 /**
  *
@@ -56,6 +57,108 @@ int ms_set_bounds(measuresuite_t ms, const uint64_t *bounds);
  */
 int ms_set_chunk_size(measuresuite_t ms, size_t chunk_size);
 
+/**
+ * Enables caching of assembled ASM strings loaded with ms_load_data /
+ * ms_replace_code. Loading a string which has been assembled before (with the
+ * same chunk size) copies the cached machine code instead of running
+ * AssemblyLine again.
+ * The cache holds at most @param num_entries strings and evicts the least
+ * recently used one. 0 disables the cache (default).
+ * Drops all cached entries and resets the statistics.
+ */
+int ms_set_asm_cache_size(measuresuite_t ms, size_t num_entries);
+
+/**
+ * Writes the number of cache hits and misses since the last
+ * ms_set_asm_cache_size to @param hits and @param misses.
+ */
+void ms_get_asm_cache_stats(measuresuite_t ms, uint64_t *hits,
+                            uint64_t *misses);
+
+/**
+ * Enables incremental assembly of ASM strings loaded with ms_load_data /
+ * ms_replace_code: the encoding of each line is memoized, and a string is
+ * laid out from those encodings such that only lines which have not been seen
+ * before are passed to AssemblyLine. Branches (jmp, jcc, call) to labels
+ * within the string are emitted as rel32 and fixed up afterwards, which is why
+ * such strings are not put into the cache of ms_set_asm_cache_size.
+ * Strings which cannot be assembled line by line (or any string while a chunk
+ * size is set) are assembled as a whole, as usual.
+ * At most @param num_lines lines are memoized (least recently used ones are
+ * evicted). 0 disables incremental assembly (default).
+ */
+int ms_set_incremental_assembly(measuresuite_t ms, size_t num_lines);
+
+/**
+ * Writes the number of line memo hits and misses of incremental assembly to
+ * @param hits and @param misses.
+ */
+void ms_get_incremental_assembly_stats(measuresuite_t ms, uint64_t *hits,
+                                       uint64_t *misses);
+
+/**
+ * Writes the time (in nanoseconds) the last load of ASM into function
+ * @param id took to assemble to @param ns.
+ */
+int ms_get_assembly_time(measuresuite_t ms, int id, uint64_t *ns);
+
+/**
+ * Enables the result cache: the cycles measured for a function are stored,
+ * keyed by its machine code and the measurement config (argument counts and
+ * width, bounds, batch size, number of batches and timer). If the same code is
+ * measured again with the same config, the stored cycles are reported instead
+ * of measuring it again.
+ * If @param top_up_batches is not 0, such functions are still measured in
+ * that many batches, and those samples replace the oldest stored ones.
+ * Shared objects are always measured. While checking is enabled, all
+ * functions are measured (and their results stored).
+ * The cache holds @param num_entries functions and is flushed when full.
+ * 0 disables it (default). Drops all entries and resets the statistics.
+ */
+int ms_set_result_cache(measuresuite_t ms, size_t num_entries,
+                        size_t top_up_batches);
+
+/**
+ * Writes the number of result cache hits and misses since the last
+ * ms_set_result_cache to @param hits and @param misses.
+ */
+void ms_get_result_cache_stats(measuresuite_t ms, uint64_t *hits,
+                               uint64_t *misses);
+
+/**
+ * Writes all entries of the result cache to @param filename, such that they
+ * can be loaded by another instance (on the same machine) with
+ * ms_result_cache_load.
+ */
+int ms_result_cache_save(measuresuite_t ms, const char *filename);
+
+/**
+ * Adds the entries stored in @param filename to the result cache (as many as
+ * fit). The result cache must be enabled.
+ */
+int ms_result_cache_load(measuresuite_t ms, const char *filename);
+
+enum ms_batch_callback_result { MS_BATCH_CONTINUE = 0, MS_BATCH_STOP = 1 };
+
+/**
+ * called by ms_measure after each batch (one run of every function), outside
+ * of the timed region. @param cycles holds the fresh sample of each function,
+ * @param num_functions many, in the order of the function ids. Functions whose
+ * result is served from the result cache in that batch report a cached sample.
+ * @returns MS_BATCH_CONTINUE, or MS_BATCH_STOP to end the measurement early.
+ */
+typedef enum ms_batch_callback_result (*ms_batch_callback)(
+    void *ctx, size_t batch, const uint64_t *cycles, size_t num_functions);
+
+/**
+ * Sets @param callback to be called with @param ctx after each batch. NULL
+ * disables it (default).
+ * If it stops a measurement early, the results (and JSON) only hold the
+ * batches run so far, and the result cache is not updated.
+ */
+void ms_set_batch_callback(measuresuite_t ms, ms_batch_callback callback,
+                           void *ctx);
+
 /**
  * This will control correctness checking.
  *
@@ -98,8 +201,15 @@ enum load_type { ASM, BIN, ELF, SHARED_OBJECT };
  *
  * @param filename must be a path to an elf-file (*.o).
  * The symbol table from it will be read.
- * If @param symbol is not NULL, the respective symbol is loaded.
- * Otherwise the first found symbol is loaded.
+ * If @param symbol is not NULL, the respective symbol is loaded, that is its
+ * st_size bytes. Functions without a size end at the next function.
+ * Otherwise the whole .text section is loaded.
+ * Object files are linked: the sections the code references (.rodata, .data,
+ * .bss, other functions) are loaded after it, and the relocations
+ * R_X86_64_64, PC32, PLT32, 32, 32S and PC64 are applied. Calls to functions
+ * in the same section are resolved by the assembler instead, compile with
+ * -ffunction-sections to keep them working. References to symbols defined
+ * elsewhere fail with E_LOAD__ELF_UNDEFINED_REFERENCE.
  *
  *
  * load_type SHARED_OBJECT
@@ -107,6 +217,8 @@ enum load_type { ASM, BIN, ELF, SHARED_OBJECT };
  * @param filename must be a path to a shared object file (*.so).
  * The file is `dlopen`ed
  * subsequently, the @param symbol is `dlsym`ed on the library.
+ * Each file (by device and inode) is opened once per instance; all functions
+ * loaded from it share the handle, which is closed with the last of them.
  *
  */
 
@@ -135,18 +247,126 @@ int ms_load_file(measuresuite_t ms, enum load_type type, const char *filename,
  * load_type ELF
  *
  * @param data must constain an elf-file in memeory
- * The symbol table from it will be read.
- * If @param symbol is not NULL, the respective symbol is loaded.
- * Otherwise the first found symbol is loaded.
- * @param data_len is ignored.
+ * It is loaded as in ms_load_file.
+ * @param data_len is the size of the file, or 0 if unknown. Then it is not
+ * bounds-checked.
  *
  * load_type SHARED_OBJECT
- * invalid. Use ms_load_file instead.
+ * @param data must contain a shared object file of @param data_len bytes.
+ * It is written to an anonymous file (memfd_create) and `dlopen`ed from
+ * there, then @param symbol is `dlsym`ed, as in ms_load_file. Nothing touches
+ * the disk. Each call opens a library of its own, which is closed with the
+ * function.
+ * Fails with E_INVALID_INPUT__SO_FROM_MEMORY if @param data_len is 0 or
+ * @param symbol is NULL.
  */
 
 int ms_load_data(measuresuite_t ms, enum load_type type, const uint8_t *data,
                  size_t data_len, const char *symbol, int *id);
 
+/**
+ * Replaces the code of the already loaded function @param id in place.
+ *
+ * @param type, @param data and @param data_len are interpreted as in
+ * ms_load_data (SHARED_OBJECT is invalid here, there is no symbol).
+ *
+ * Unlike unloading and loading again, the function keeps its slot in the code
+ * arena, its result buffers and its place in the measurement order. The slot is
+ * only grown if the new code does not fit.
+ * Fails with E_INVALID_INPUT__NUM_IDX_OOB if @param id is not loaded.
+ */
+int ms_replace_code(measuresuite_t ms, int id, enum load_type type,
+                    const uint8_t *data, size_t data_len);
+
+/**
+ * Calls ms_replace_code for @param num functions, i.e. replaces the code of
+ * function @param ids[i] with @param data[i] of length @param data_lens[i].
+ * @param data_lens may be NULL for ASM and ELF.
+ * Stops at the first failing replacement.
+ */
+int ms_replace_code_many(measuresuite_t ms, size_t num, const int *ids,
+                         enum load_type type, const uint8_t *const *data,
+                         const size_t *data_lens);
+
+/**
+ * Opens the elf-file @param filename (*.o) for loading many symbols from it.
+ * The file is mmap'ed and its symbol table indexed once, instead of on each
+ * ms_load_file. Writes the handle to @param elf, which must be closed with
+ * ms_elf_close.
+ */
+int ms_elf_open(measuresuite_t ms, const char *filename, ms_elf_t *elf);
+
+/**
+ * Unmaps the file of @param elf and frees the handle.
+ * Functions loaded from it stay loaded, their code has been copied.
+ */
+int ms_elf_close(measuresuite_t ms, ms_elf_t elf);
+
+/**
+ * Loads the @param num symbols @param symbols from @param elf, like
+ * ms_load_file with load_type ELF would.
+ * @param ids[i] is treated like the @param id of ms_load_file, i.e. -1 loads
+ * into a new slot. The ids are written back.
+ * Stops at the first failing symbol (E_LOAD__ELF_SYMBOL_NOT_FOUND if it is not
+ * defined). The ones before stay loaded.
+ */
+int ms_load_elf_symbols(measuresuite_t ms, ms_elf_t elf, size_t num,
+                        const char *const *symbols, int *ids);
+
+/**
+ * Loads every function of @param elf, in symbol table order, into new slots.
+ * Functions are STT_FUNC symbols, and global labels without a type in an
+ * executable section (as nasm emits them without ':function').
+ * They get the consecutive ids @param *first_id .. @param *first_id +
+ * @param *num_loaded - 1.
+ * Stops at the first failing one, @param *num_loaded counts the ones before.
+ */
+int ms_load_elf_all(measuresuite_t ms, ms_elf_t elf, int *first_id,
+                    size_t *num_loaded);
+
+/**
+ * Loads the @param num symbols @param symbols from the shared object
+ * @param filename, like ms_load_file with load_type SHARED_OBJECT would.
+ * The library is opened once for all of them.
+ * @param ids[i] is treated like the @param id of ms_load_file, i.e. -1 loads
+ * into a new slot. The ids are written back.
+ * Stops at the first failing symbol. The ones before stay loaded.
+ */
+int ms_load_so_symbols(measuresuite_t ms, const char *filename, size_t num,
+                       const char *const *symbols, int *ids);
+
+/**
+ * Loads every function the shared object @param filename exports (its dynamic
+ * symbol table, in order) whose name matches @param pattern, a shell wildcard
+ * as in fnmatch(3), into new slots. "*" loads all of them.
+ * They get the consecutive ids @param *first_id .. @param *first_id +
+ * @param *num_loaded - 1.
+ * Fails with E_LOAD__ELF_SYMBOL_NOT_FOUND if none matches.
+ * Stops at the first failing one, @param *num_loaded counts the ones before.
+ */
+int ms_load_so_matching(measuresuite_t ms, const char *filename,
+                        const char *pattern, int *first_id,
+                        size_t *num_loaded);
+
+/**
+ * Loads functions from every member of the static archive @param filename
+ * (*.a), as ms_load_file with load_type ELF would from the member's file.
+ * If @param symbol is NULL, all functions of each member are loaded (as in
+ * ms_load_elf_all). Otherwise @param symbol is loaded from each member which
+ * defines it, and E_LOAD__ELF_SYMBOL_NOT_FOUND if none does.
+ * They get the consecutive ids @param *first_id .. @param *first_id +
+ * @param *num_loaded - 1, and report their member's name in
+ * ms_function_result.member and as "member" in the JSON.
+ * Stops at the first failing one, @param *num_loaded counts the ones before.
+ */
+int ms_load_archive(measuresuite_t ms, const char *filename,
+                    const char *symbol, int *first_id, size_t *num_loaded);
+
+// Same as ms_load_archive, but reads the @param data_len bytes at @param data
+int ms_load_archive_data(measuresuite_t ms, const uint8_t *data,
+                         size_t data_len, const char *symbol, int *first_id,
+                         size_t *num_loaded);
+
 /*
  * will unload and free all memory associated with functions. The next load_xxx
  * will be put into id=0
@@ -159,6 +379,150 @@ int ms_unload_all(measuresuite_t ms);
  */
 int ms_unload_last(measuresuite_t ms);
 
+// largest alignment of ms_set_placement, one page
+#define MS_MAX_PLACEMENT_ALIGNMENT 4096
+
+/**
+ * Places the code of function @param id @param offset bytes after a multiple
+ * of @param alignment, e.g. at byte 5 of a cache line with 64 and 5.
+ * @param alignment must be a power of two up to MS_MAX_PLACEMENT_ALIGNMENT and
+ * @param offset below it. 0 and 0 restore the default: the start of the code
+ * slot, which is aligned to a cache line.
+ * Loaded code is moved there right away, later loads into @param id go there,
+ * too. The placement is part of the result cache key.
+ * Fails with E_INVALID_INPUT__PLACEMENT for invalid arguments, for
+ * SHARED_OBJECT functions, for ELF code which would have to move but
+ * contains absolute addresses into itself (e.g. pointers in .data.rel), and
+ * for ELF code whose sections need an alignment @param offset is no multiple
+ * of (e.g. 16 byte aligned .rodata of SSE code). Loading such code into
+ * @param id fails likewise.
+ */
+int ms_set_placement(measuresuite_t ms, int id, size_t alignment,
+                     size_t offset);
+
+// flag of ms_set_layout_randomization
+#define MS_LAYOUT_REQUIRE_MOVABLE 1
+
+/**
+ * Randomizes the layout before each batch, such that the cycles do not depend
+ * on one (un)lucky placement of code and data: each function is moved to a
+ * random byte offset into a window of @param code_window bytes (see
+ * ms_set_placement), rounded down to a multiple of the alignment the sections
+ * of ELF code need, and the inputs and outputs to random cache lines in a
+ * window of @param data_window bytes each.
+ * Both windows must be powers of two up to MS_MAX_PLACEMENT_ALIGNMENT, the
+ * data window at least one cache line (64). 0 leaves that part in place, 0 and
+ * 0 disable it (default).
+ * Functions which cannot be moved (SHARED_OBJECT, ELF with absolute addresses
+ * into itself) run at their placement, unless @param flags has
+ * MS_LAYOUT_REQUIRE_MOVABLE; then measuring them fails with
+ * E_INVALID_INPUT__PLACEMENT. The placements are restored after each
+ * measurement, and ms_measure_sweep fails while the code is randomized.
+ * Fails with E_INVALID_INPUT__LAYOUT for invalid windows.
+ */
+int ms_set_layout_randomization(measuresuite_t ms, size_t code_window,
+                                size_t data_window, int flags);
+
+// the pages ms_set_data_offsets places the inputs and outputs into
+#define MS_DATA_PAGE_SIZE 4096
+// offset of ms_set_data_offsets restoring the default
+#define MS_DATA_OFFSET_COMPACT SIZE_MAX
+
+/**
+ * Places the inputs @param in_offset bytes into a MS_DATA_PAGE_SIZE page, and
+ * the outputs of each function @param out_offset bytes into a page of their
+ * own. A load from an address matching an earlier store in the bits below the
+ * page size waits for that store (4K aliasing), so the cycles can depend on
+ * (out_offset - in_offset) mod MS_DATA_PAGE_SIZE. This keeps that distance the
+ * same for all functions and runs; ms_measure_data_sweep varies it.
+ * Both must be multiples of 8 below MS_DATA_PAGE_SIZE. MS_DATA_OFFSET_COMPACT
+ * for both restores the default: the inputs and the outputs of one function
+ * after another, each starting at a cache line.
+ * The inputs and outputs are moved right away. While the data layout is
+ * randomized (ms_set_layout_randomization), they are copied elsewhere for the
+ * calls and the offsets do not apply. The offsets are part of the result
+ * cache key.
+ * Fails with E_INVALID_INPUT__DATA_OFFSET for invalid offsets.
+ */
+int ms_set_data_offsets(measuresuite_t ms, size_t in_offset,
+                        size_t out_offset);
+
+// entry of ms_set_aliasing for an out argument with a buffer of its own
+#define MS_ALIAS_NONE (-1)
+
+/**
+ * Calls the functions in place, as e.g. field arithmetic often is: out
+ * argument j is passed the same pointer as in argument @param aliases[j]
+ * (counting from 0, so {0} calls f(out1, arg1) with out1 == arg1), or a buffer
+ * of its own if that is MS_ALIAS_NONE. @param aliases holds num_arg_out
+ * entries; each in argument can be aliased by one out argument at most. NULL
+ * restores the default, no aliasing.
+ * The aliased buffers are refilled with the inputs before each call. To keep
+ * that out of the cycles, each call is timed on its own, so the cycles of a
+ * batch include batch_size timer readings instead of one. Checking compares
+ * the results of all functions called in place, the aliasing is part of the
+ * result cache key.
+ * Fails with E_INVALID_INPUT__ALIASING for an invalid @param aliases.
+ */
+int ms_set_aliasing(measuresuite_t ms, const int *aliases);
+
+/**
+ * Strides through a pool of @param bytes of inputs and outputs instead of
+ * reusing one set of them, to measure memory-bound functions at working sets
+ * beyond the L1: the pool holds as many argument sets (inputs, then outputs,
+ * starting at a cache line) as fit, and each call takes the next one, wrapping
+ * around at the end. The position is shared by all functions, so each set is
+ * touched again after as many calls as there are sets. The inputs are filled
+ * with random data (masked with the bounds) before each measurement. Calls are
+ * still timed per batch, with a few instructions per call to advance.
+ * The memory options apply to the pool, the data offsets and data layout
+ * randomization do not. With checking, each function is called once more per
+ * batch on the normal inputs, untimed, and those results are compared.
+ * 0 disables it (default). Fails with E_INVALID_INPUT__WORKING_SET if
+ * @param bytes does not hold one set.
+ */
+int ms_set_working_set(measuresuite_t ms, size_t bytes);
+
+// flags of ms_set_memory_options
+#define MS_MEMORY_HUGE_PAGES 1
+#define MS_MEMORY_LOCK 2
+
+/**
+ * Sets how the memory a measurement touches is backed, to keep TLB misses and
+ * page faults out of the cycles. @param flags may combine:
+ * MS_MEMORY_HUGE_PAGES: the code arena and the inputs and outputs are mapped
+ * in 2 MiB pages. Explicit (hugetlbfs) pages are used if the system has some
+ * reserved (vm.nr_hugepages), transparent ones if not.
+ * MS_MEMORY_LOCK: all of that, and the cycles, are mlock'ed.
+ * Both fall back to normal pages if the system cannot provide them, see
+ * ms_get_memory_status. 0 restores the default.
+ * The inputs and outputs are moved right away. The code arena is mapped anew if
+ * no function is loaded; if some are, it is locked and asked for transparent
+ * huge pages in place, and new chunks are mapped as asked for.
+ */
+int ms_set_memory_options(measuresuite_t ms, int flags);
+
+enum ms_page_size {
+  MS_PAGES_SMALL = 0,            // normal pages
+  MS_PAGES_TRANSPARENT_HUGE = 1, // at least partly transparent huge pages
+  MS_PAGES_HUGE = 2,             // explicit huge pages
+};
+
+struct ms_memory_status {
+  // the smallest pages backing any chunk of the code arena
+  enum ms_page_size code_pages;
+  // pages backing the inputs and outputs
+  enum ms_page_size data_pages;
+  // 1 if the code arena, inputs and outputs are locked in memory
+  int locked;
+};
+
+/**
+ * Writes to @param dest what the memory is actually backed by, as read from
+ * /proc/self/smaps.
+ */
+int ms_get_memory_status(measuresuite_t ms, struct ms_memory_status *dest);
+
 /**
  * Will then assembles @param functionA and @param functionB to memory.
  * Will then randomly run @param batch_size'ed batches; until each function has
@@ -172,6 +536,8 @@ int ms_measure(measuresuite_t ms, int batch_size, int num_batches);
 /**
  * will set the json result of the last measurement stored in @param ms to
  * @param json. Will write the length needed for that JSON into @param json_len
+ * The JSON is generated on the first call after each measurement; if that
+ * fails (out of memory or cycles already taken), @param json is set to NULL.
  */
 void ms_get_json(measuresuite_t ms, const char **json, size_t *json_len);
 
@@ -189,6 +555,158 @@ enum TIMER { PMC, RDTSCP };
  */
 enum TIMER ms_get_timer(measuresuite_t ms);
 
+// version of struct ms_results as filled by this library
+#define MS_RESULTS_VERSION 1
+
+struct ms_function_result {
+  enum load_type type;
+  // chunk breaks counted while assembling (ASM with AssemblyLine only)
+  int chunks;
+  // num_batches cycle counts, NULL after ms_take_cycles
+  const uint64_t *cycles;
+  // bytes of machine code measured, 0 for SHARED_OBJECT. For ELF, this
+  // includes the sections linked along (.rodata, ...).
+  size_t code_size;
+  // the archive member the function was loaded from by ms_load_archive, NULL
+  // otherwise. Valid until the function is unloaded or loaded into again.
+  const char *member;
+  // of the code's address in its 4 KiB page, see ms_set_placement
+  size_t page_offset;
+};
+
+struct ms_results {
+  // MS_RESULTS_VERSION of the library which filled it
+  int version;
+  size_t num_functions;
+  size_t num_batches;
+  size_t batch_size;
+  uint64_t runtime; // in seconds
+  // index of the first function calculating a different result than the
+  // previous one, 0 if all are the same (or checking is disabled)
+  size_t incorrect;
+  enum TIMER timer;
+  // num_functions elements, in the order of the function ids
+  const struct ms_function_result *functions;
+};
+
+/**
+ * will set @param dest to the results of the last measurement. They are
+ * filled without any string formatting, and stay valid until the next
+ * measurement or ms_terminate.
+ * @param version is the MS_RESULTS_VERSION the caller was compiled with.
+ * Fails with E_INVALID_INPUT__RESULTS_VERSION if that is newer than the one
+ * of the library, and with E_INVALID_INPUT__NO_MEASUREMENT if there is no
+ * measurement yet.
+ */
+int ms_get_results(measuresuite_t ms, int version,
+                   const struct ms_results **dest);
+
+/**
+ * transfers the cycle measurements of the last measurement to the caller,
+ * who has to free() @param dest. It holds @param num_functions rows of
+ * @param num_batches cycles each, row i belonging to function i.
+ * Afterwards, ms_get_cycles and the cycles in ms_results are invalid until the
+ * next measurement. Call ms_get_json before, if the JSON is needed, too.
+ * Fails with E_INVALID_INPUT__NO_MEASUREMENT if there is nothing to take.
+ */
+int ms_take_cycles(measuresuite_t ms, uint64_t **dest, size_t *num_functions,
+                   size_t *num_batches);
+
+struct ms_sweep_function {
+  // of the median cycles at each offset
+  uint64_t min, max, median;
+  // index of the offset with the smallest median
+  size_t best;
+  // 0 if the function could not be moved (SHARED_OBJECT, or ELF with absolute
+  // addresses into itself or aligned sections), then it ran at its placement
+  // each time
+  int moved;
+};
+
+struct ms_sweep_results {
+  size_t window;
+  size_t num_offsets;
+  size_t num_functions;
+  // num_offsets offsets into the window, in bytes
+  const size_t *offsets;
+  // num_offsets rows of num_functions median cycle counts. Row i holds the
+  // medians of the measurement with all functions at offsets[i].
+  const uint64_t *medians;
+  // num_functions elements, in the order of the function ids
+  const struct ms_sweep_function *functions;
+};
+
+/**
+ * Measures all functions at @param num_offsets placements, spread evenly over
+ * a window of @param window bytes: for offset i, each function is placed
+ * i * window / num_offsets bytes after a multiple of window (see
+ * ms_set_placement) and measured as in ms_measure.
+ * This tells speedups of the code apart from those of its alignment.
+ * Sets @param dest to the median cycles of each function at each offset, and
+ * their spread over the offsets. They stay valid until the next sweep or
+ * ms_terminate. ms_get_results and ms_get_json hold the last offset's
+ * measurement. The functions' placements are restored afterwards.
+ * @param window must be a power of two up to MS_MAX_PLACEMENT_ALIGNMENT and
+ * @param num_offsets between 1 and @param window.
+ */
+int ms_measure_sweep(measuresuite_t ms, int batch_size, int num_batches,
+                     size_t window, size_t num_offsets,
+                     const struct ms_sweep_results **dest);
+
+/**
+ * Measures all functions at @param num_offsets distances of their outputs from
+ * the inputs, spread evenly over MS_DATA_PAGE_SIZE and rounded down to 8: for
+ * offset i, the outputs are placed offsets[i] bytes after the inputs, modulo
+ * the page size (see ms_set_data_offsets), and measured as in ms_measure.
+ * The inputs stay at their offset set by ms_set_data_offsets, or at the start
+ * of a page.
+ * This tells 4K aliasing between loads of the inputs and stores to the outputs
+ * apart from the cost of the code. Sets @param dest as ms_measure_sweep does,
+ * with the window MS_DATA_PAGE_SIZE. The data offsets are restored afterwards.
+ * @param num_offsets must be between 1 and MS_DATA_PAGE_SIZE / 8, else it
+ * fails with E_INVALID_INPUT__DATA_OFFSET; and it fails with
+ * E_INVALID_INPUT__LAYOUT while the data layout is randomized.
+ */
+int ms_measure_data_sweep(measuresuite_t ms, int batch_size, int num_batches,
+                          size_t num_offsets,
+                          const struct ms_sweep_results **dest);
+
+// most levels of ms_measure_working_set_sweep, caches and memory
+#define MS_MAX_CACHE_LEVELS 5
+
+struct ms_working_set_level {
+  // of the cache, 1 for the L1d; 0 for memory beyond the last level
+  int level;
+  // bytes of that cache, 0 for memory
+  size_t cache_size;
+  // bytes of the pool measured with, see ms_set_working_set
+  size_t working_set;
+};
+
+struct ms_working_set_results {
+  size_t num_levels;
+  size_t num_functions;
+  // num_levels elements, by level, memory last
+  const struct ms_working_set_level *levels;
+  // num_levels rows of num_functions median cycles per call
+  const double *cycles_per_call;
+};
+
+/**
+ * Measures all functions as in ms_measure with a working set in each level of
+ * the cache hierarchy of cpu0 (data and unified caches, as listed in
+ * /sys/devices/system/cpu/cpu0/cache), and in memory: half of each cache's
+ * size, and twice the last level's size (see ms_set_working_set).
+ * Sets @param dest to the median cycles per call of each function at each
+ * level, valid until the next working set sweep or ms_terminate.
+ * ms_get_results and ms_get_json hold the memory level's measurement. The
+ * working set is restored afterwards.
+ * Fails with E_INTERNAL_MEASURE__AI__CACHE_INFO if sysfs lists no caches.
+ */
+int ms_measure_working_set_sweep(measuresuite_t ms, int batch_size,
+                                 int num_batches,
+                                 const struct ms_working_set_results **dest);
+
 /**
  * Will release all resources allocated with @param ms
  * can be called with NULL, then no operation will be done.
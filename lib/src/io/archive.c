@@ -0,0 +1,230 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// O_CLOEXEC
+#define _POSIX_C_SOURCE 200809L
+
+#include "archive.h"
+#include "../error/error.h"
+#include "debug.h"
+
+#include <errno.h>    // errno
+#include <fcntl.h>    // open
+#include <string.h>   // memcmp, strerror
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+static const char ar_magic[] = "!<arch>\n";
+#define AR_MAGIC_LEN (sizeof(ar_magic) - 1)
+
+// the member header, all fields ASCII and space padded
+struct ar_header {
+  char name[16];
+  char date[12];
+  char uid[6];
+  char gid[6];
+  char mode[8];
+  char size[10];
+  char fmag[2];
+};
+
+static const char ar_fmag[2] = {'`', '\n'};
+
+static int invalid(measuresuite_t ms) {
+  ms->errorno = E_LOAD__ARCHIVE_INVALID;
+  return 1;
+}
+
+// parses the decimal in the @param len chars at @param field
+static int parse_decimal(const char *field, size_t len, size_t *value) {
+  size_t i = 0;
+  *value = 0;
+  for (; i < len && field[i] >= '0' && field[i] <= '9'; i++) {
+    *value = *value * 10 + (size_t)(field[i] - '0');
+  }
+  // at least one digit, then only padding
+  int ok = i > 0;
+  for (; i < len; i++) {
+    ok &= field[i] == ' ';
+  }
+  return !ok;
+}
+
+// @returns the length of @param name without its padding
+static size_t trim(const char *name, size_t len, char padding) {
+  while (len > 0 && name[len - 1] == padding) {
+    len--;
+  }
+  return len;
+}
+
+int ar_parse(measuresuite_t ms, const uint8_t *data, size_t size,
+             struct ms_archive *ar) {
+  memset(ar, 0, sizeof(*ar));
+  if (size < AR_MAGIC_LEN || memcmp(data, ar_magic, AR_MAGIC_LEN) != 0) {
+    return invalid(ms);
+  }
+  ar->data = data;
+  ar->size = size;
+  ar->next = AR_MAGIC_LEN;
+  return 0;
+}
+
+int ar_open(measuresuite_t ms, const char *filename, struct ms_archive *ar) {
+  memset(ar, 0, sizeof(*ar));
+
+  int file = open(filename, O_RDONLY | O_CLOEXEC);
+  struct stat stats;
+  if (file < 0 || fstat(file, &stats)) {
+    ms->errorno = E_LOAD__ARCHIVE_IO;
+    ms->additional_info = strerror(errno);
+    if (file >= 0) {
+      close(file);
+    }
+    return 1;
+  }
+  if ((size_t)stats.st_size < AR_MAGIC_LEN) {
+    close(file);
+    return invalid(ms);
+  }
+
+  void *data = mmap(NULL, stats.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  int mmap_errno = errno;
+  close(file);
+  // NOLINTNEXTLINE
+  if (data == MAP_FAILED) {
+    ms->errorno = E_LOAD__ARCHIVE_IO;
+    ms->additional_info = strerror(mmap_errno);
+    return 1;
+  }
+
+  if (ar_parse(ms, data, stats.st_size, ar)) {
+    munmap(data, stats.st_size);
+    return 1;
+  }
+  ar->mapped = 1;
+  return 0;
+}
+
+int ar_close(measuresuite_t ms, struct ms_archive *ar) {
+  int ret = 0;
+  if (ar->mapped && munmap((void *)ar->data, ar->size)) {
+    ms->errorno = E_LOAD__ARCHIVE_IO;
+    ms->additional_info = strerror(errno);
+    ret = 1;
+  }
+  memset(ar, 0, sizeof(*ar));
+  return ret;
+}
+
+// resolves the name of @param header into @param member, whose data may start
+// with the name (BSD). Sets @param *skip for the symbol and name tables.
+static int member_name(measuresuite_t ms, struct ms_archive *ar,
+                       const struct ar_header *header,
+                       struct ar_member *member, int *skip) {
+  const char *name = header->name;
+  size_t len = trim(name, sizeof(header->name), ' ');
+  *skip = 0;
+
+  if (len == 2 && memcmp(name, "//", 2) == 0) {
+    // GNU long names, entries end in "/\n"
+    ar->long_names = (const char *)member->data;
+    ar->long_names_size = member->size;
+    *skip = 1;
+    return 0;
+  }
+  if ((len == 1 && name[0] == '/') ||
+      (len == 7 && memcmp(name, "/SYM64/", 7) == 0)) {
+    // GNU symbol table
+    *skip = 1;
+    return 0;
+  }
+
+  size_t offset = 0;
+  if (len > 1 && name[0] == '/') {
+    // GNU long name: "/offset" into the long names
+    if (ar->long_names == NULL || parse_decimal(name + 1, len - 1, &offset) ||
+        offset >= ar->long_names_size) {
+      return invalid(ms);
+    }
+    member->name = ar->long_names + offset;
+    const char *end = memchr(member->name, '\n', ar->long_names_size - offset);
+    member->name_len = end == NULL ? ar->long_names_size - offset
+                                   : (size_t)(end - member->name);
+    member->name_len = trim(member->name, member->name_len, '/');
+    return 0;
+  }
+
+  if (len > 3 && memcmp(name, "#1/", 3) == 0) {
+    // BSD long name: the first "#1/len" bytes of the data
+    size_t name_len = 0;
+    if (parse_decimal(name + 3, len - 3, &name_len) ||
+        name_len > member->size) {
+      return invalid(ms);
+    }
+    member->name = (const char *)member->data;
+    member->name_len = trim(member->name, name_len, '\0');
+    member->data += name_len;
+    member->size -= name_len;
+  } else {
+    // GNU terminates short names with '/', BSD only pads them
+    member->name = name;
+    member->name_len = trim(name, len, '/');
+  }
+
+  // BSD symbol table
+  static const char symdef[] = "__.SYMDEF";
+  *skip = member->name_len >= sizeof(symdef) - 1 &&
+          memcmp(member->name, symdef, sizeof(symdef) - 1) == 0;
+  return 0;
+}
+
+int ar_next_member(measuresuite_t ms, struct ms_archive *ar,
+                   struct ar_member *member) {
+  for (;;) {
+    memset(member, 0, sizeof(*member));
+    if (ar->next >= ar->size) {
+      return 0;
+    }
+
+    // only chars, read in place such that short names can point into it
+    const struct ar_header *header =
+        (const struct ar_header *)(ar->data + ar->next);
+    size_t size = 0;
+    if (ar->size - ar->next < sizeof(*header) ||
+        memcmp(header->fmag, ar_fmag, sizeof(ar_fmag)) != 0 ||
+        parse_decimal(header->size, sizeof(header->size), &size) ||
+        size > ar->size - ar->next - sizeof(*header)) {
+      return invalid(ms);
+    }
+
+    member->data = ar->data + ar->next + sizeof(*header);
+    member->size = size;
+    // members are 2-byte aligned
+    ar->next += sizeof(*header) + size + (size & 1);
+
+    int skip = 0;
+    if (member_name(ms, ar, header, member, &skip)) {
+      return 1;
+    }
+    if (!skip) {
+      DEBUG("ar: member %.*s, %lu bytes\n", (int)member->name_len,
+            member->name, member->size);
+      return 0;
+    }
+  }
+}
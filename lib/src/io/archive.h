@@ -0,0 +1,61 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+#include "../struct_measuresuite.h"
+
+/**
+ * A static archive (*.a) as written by ar, in GNU or BSD format.
+ * Members are read in place, their data can be parsed with elf_parse.
+ */
+struct ms_archive {
+  // the whole file, mmap'ed by ar_open if @var mapped is set
+  const uint8_t *data;
+  size_t size;
+  int mapped;
+
+  // where the next member header starts
+  size_t next;
+  // GNU table of long member names ("//"), once it has been passed
+  const char *long_names;
+  size_t long_names_size;
+};
+
+struct ar_member {
+  // not NUL-terminated
+  const char *name;
+  size_t name_len;
+  const uint8_t *data;
+  size_t size;
+};
+
+// checks the magic of the @param size bytes at @param data
+int ar_parse(measuresuite_t ms, const uint8_t *data, size_t size,
+             struct ms_archive *ar);
+
+// mmaps @param filename and parses it into @param ar
+int ar_open(measuresuite_t ms, const char *filename, struct ms_archive *ar);
+
+// unmaps the file of @param ar if it mapped one
+int ar_close(measuresuite_t ms, struct ms_archive *ar);
+
+/**
+ * Sets @param member to the next member of @param ar, skipping the symbol
+ * and name tables. member->data is NULL after the last one.
+ */
+int ar_next_member(measuresuite_t ms, struct ms_archive *ar,
+                   struct ar_member *member);
+#endif
@@ -0,0 +1,311 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "elf_linker.h"
+#include "../error/error.h"
+#include "debug.h"
+
+#include <errno.h>  // errno
+#include <stdint.h> // SIZE_MAX, INT32_MIN...
+#include <stdlib.h> // realloc, free
+#include <string.h> // memcpy, memset, strerror
+
+// called for each relocation which applies to a part of the image
+typedef int (*relocation_cb)(measuresuite_t ms, const struct ms_elf *elf,
+                             const Elf64_Rela *rela, void *ctx);
+
+// calls @param cb for the relocations of the bytes in @param region
+static int for_each_relocation(measuresuite_t ms, const struct ms_elf *elf,
+                               const struct elf_region *region,
+                               relocation_cb cb, void *ctx) {
+  for (size_t i = 0; i < elf->header.e_shnum; i++) {
+    Elf64_Shdr rela_section;
+    elf_get_section(elf, i, &rela_section);
+    if (rela_section.sh_type != SHT_RELA ||
+        rela_section.sh_info != region->section) {
+      continue;
+    }
+    if (rela_section.sh_entsize != sizeof(Elf64_Rela) ||
+        !elf_in_bounds(elf, rela_section.sh_offset, rela_section.sh_size)) {
+      return elf_invalid(ms, elf);
+    }
+
+    const size_t num_entries = rela_section.sh_size / sizeof(Elf64_Rela);
+    for (size_t j = 0; j < num_entries; j++) {
+      Elf64_Rela rela;
+      memcpy(&rela, elf->data + rela_section.sh_offset + j * sizeof(rela),
+             sizeof(rela));
+      if (rela.r_offset < region->offset ||
+          rela.r_offset - region->offset >= region->size) {
+        continue;
+      }
+      if (cb(ms, elf, &rela, ctx)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+// copies the symbol @param rela refers to to @param sym, which must be defined
+static int relocation_symbol(measuresuite_t ms, const struct ms_elf *elf,
+                             const Elf64_Rela *rela, Elf64_Sym *sym) {
+  const size_t i = ELF64_R_SYM(rela->r_info);
+  if (i >= elf_num_symbols(elf)) {
+    return elf_invalid(ms, elf);
+  }
+  elf_get_symbol(elf, i, sym);
+  if (sym->st_shndx == SHN_UNDEF || sym->st_shndx == SHN_COMMON) {
+    ms->errorno = E_LOAD__ELF_UNDEFINED_REFERENCE;
+    return 1;
+  }
+  if (sym->st_shndx != SHN_ABS && sym->st_shndx >= elf->header.e_shnum) {
+    return elf_invalid(ms, elf);
+  }
+  return 0;
+}
+
+// @returns the index of the part which holds @param sym, image->num_parts if
+// none does.
+static size_t part_of(const struct ms_elf *elf, const struct elf_image *image,
+                      const Elf64_Sym *sym) {
+  for (size_t i = 0; i < image->num_parts; i++) {
+    const struct elf_region *region = &image->parts[i].region;
+    if (region->section != sym->st_shndx) {
+      continue;
+    }
+    Elf64_Shdr section;
+    elf_get_section(elf, region->section, &section);
+    const uint64_t value = sym->st_value - section.sh_addr;
+    // section symbols point anywhere into their section, with the addend
+    if ((region->offset == 0 && region->size == section.sh_size) ||
+        (ELF64_ST_TYPE(sym->st_info) != STT_SECTION &&
+         value >= region->offset && value - region->offset < region->size)) {
+      return i;
+    }
+  }
+  return image->num_parts;
+}
+
+// appends @param region to @param image, aligned to @param align
+static int add_part(measuresuite_t ms, const struct ms_elf *elf,
+                    struct elf_image *image, const struct elf_region *region,
+                    uint64_t align) {
+  if (align == 0) {
+    align = 1;
+  }
+  // the loader places images at multiples of their largest alignment
+  if ((align & (align - 1)) != 0 || align > MS_MAX_PLACEMENT_ALIGNMENT ||
+      align > SIZE_MAX - image->size ||
+      region->size > SIZE_MAX - align - image->size) {
+    return elf_invalid(ms, elf);
+  }
+
+  if (image->num_parts == image->capacity) {
+    size_t capacity = image->capacity == 0 ? 4 : 2 * image->capacity;
+    struct elf_image_part *parts =
+        realloc(image->parts, capacity * sizeof(*parts));
+    if (parts == NULL) {
+      ms->errorno = E_LOAD__ELF_FILE_MALLOC;
+      ms->additional_info = strerror(errno);
+      return 1;
+    }
+    image->parts = parts;
+    image->capacity = capacity;
+  }
+
+  struct elf_image_part *part = &image->parts[image->num_parts++];
+  part->region = *region;
+  part->image_offset = (image->size + align - 1) & ~(align - 1);
+  image->size = part->image_offset + region->size;
+  if (align > image->alignment) {
+    image->alignment = align;
+  }
+  DEBUG("elf image: section %lu +%lu (%lu bytes) at %lu\n", region->section,
+        region->offset, region->size, part->image_offset);
+  return 0;
+}
+
+// appends the section the target of @param rela is in, unless it is placed
+static int place_target(measuresuite_t ms, const struct ms_elf *elf,
+                        const Elf64_Rela *rela, void *ctx) {
+  struct elf_image *image = ctx;
+  if (ELF64_R_TYPE(rela->r_info) == R_X86_64_NONE) {
+    return 0;
+  }
+  Elf64_Sym sym;
+  if (relocation_symbol(ms, elf, rela, &sym)) {
+    return 1;
+  }
+  if (sym.st_shndx == SHN_ABS || part_of(elf, image, &sym) < image->num_parts) {
+    return 0;
+  }
+
+  Elf64_Shdr section;
+  elf_get_section(elf, sym.st_shndx, &section);
+  if (section.sh_type != SHT_NOBITS &&
+      !elf_in_bounds(elf, section.sh_offset, section.sh_size)) {
+    return elf_invalid(ms, elf);
+  }
+  const struct elf_region region = {sym.st_shndx, 0, section.sh_size};
+  return add_part(ms, elf, image, &region, section.sh_addralign);
+}
+
+int elf_image_layout(measuresuite_t ms, const struct ms_elf *elf,
+                     const struct elf_region *code, struct elf_image *image) {
+  memset(image, 0, sizeof(*image));
+  if (add_part(ms, elf, image, code, 1)) {
+    return 1;
+  }
+  if (elf->header.e_type != ET_REL) {
+    return 0;
+  }
+
+  // parts are appended while iterating, until all references are placed
+  for (size_t i = 0; i < image->num_parts; i++) {
+    const struct elf_region region = image->parts[i].region;
+    if (for_each_relocation(ms, elf, &region, place_target, image)) {
+      elf_image_free(image);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+struct link_ctx {
+  struct elf_image *image;
+  const struct elf_image_part *part; // the relocations apply to
+  uint8_t *dest;
+};
+
+// @returns the address @param sym is linked to
+static uint64_t symbol_address(const struct ms_elf *elf,
+                               const struct link_ctx *link,
+                               const Elf64_Sym *sym, size_t target) {
+  if (sym->st_shndx == SHN_ABS) {
+    return sym->st_value;
+  }
+  const struct elf_image_part *part = &link->image->parts[target];
+  Elf64_Shdr section;
+  elf_get_section(elf, sym->st_shndx, &section);
+  return (uintptr_t)link->dest + part->image_offset +
+         (sym->st_value - section.sh_addr - part->region.offset);
+}
+
+// applies @param rela to the linked image
+static int relocate(measuresuite_t ms, const struct ms_elf *elf,
+                    const Elf64_Rela *rela, void *ctx) {
+  struct link_ctx *link = ctx;
+  const uint32_t type = ELF64_R_TYPE(rela->r_info);
+  if (type == R_X86_64_NONE) {
+    return 0;
+  }
+  Elf64_Sym sym;
+  if (relocation_symbol(ms, elf, rela, &sym)) {
+    return 1;
+  }
+  const size_t target = part_of(elf, link->image, &sym);
+  if (sym.st_shndx != SHN_ABS && target == link->image->num_parts) {
+    // the layout placed every target
+    ms->errorno = E_LOAD__ELF_RELOCATION;
+    return 1;
+  }
+
+  const uint64_t offset = rela->r_offset - link->part->region.offset;
+  uint8_t *place = link->dest + link->part->image_offset + offset;
+  // S + A, and S + A - P for the PC-relative ones
+  const uint64_t value =
+      symbol_address(elf, link, &sym, target) + (uint64_t)rela->r_addend;
+  const uint64_t pc_value = value - (uintptr_t)place;
+
+  uint64_t result = 0;
+  size_t width = sizeof(uint32_t);
+  int fits = 1;
+  // whether the result changes if the image is moved: S + A does unless S is
+  // SHN_ABS, S + A - P only then
+  int position_dependent = sym.st_shndx != SHN_ABS;
+  switch (type) {
+  case R_X86_64_64:
+    result = value;
+    width = sizeof(uint64_t);
+    break;
+  case R_X86_64_PC64:
+    result = pc_value;
+    width = sizeof(uint64_t);
+    position_dependent = !position_dependent;
+    break;
+  case R_X86_64_PC32:
+  case R_X86_64_PLT32:
+    result = pc_value;
+    fits = (int64_t)pc_value >= INT32_MIN && (int64_t)pc_value <= INT32_MAX;
+    position_dependent = !position_dependent;
+    break;
+  case R_X86_64_32:
+    result = value;
+    fits = value <= UINT32_MAX;
+    break;
+  case R_X86_64_32S:
+    result = value;
+    fits = (int64_t)value >= INT32_MIN && (int64_t)value <= INT32_MAX;
+    break;
+  default:
+    DEBUG("elf: unsupported relocation type %u\n", type);
+    fits = 0;
+  }
+  if (!fits || width > link->part->region.size ||
+      offset > link->part->region.size - width) {
+    ms->errorno = E_LOAD__ELF_RELOCATION;
+    return 1;
+  }
+  // x86-64 is little endian
+  memcpy(place, &result, width);
+  link->image->position_dependent |= position_dependent;
+  return 0;
+}
+
+int elf_image_link(measuresuite_t ms, const struct ms_elf *elf,
+                   struct elf_image *image, uint8_t *dest) {
+  image->position_dependent = 0;
+  // the padding between parts is zeroed, too
+  memset(dest, 0, image->size);
+  for (size_t i = 0; i < image->num_parts; i++) {
+    const struct elf_image_part *part = &image->parts[i];
+    Elf64_Shdr section;
+    elf_get_section(elf, part->region.section, &section);
+    if (section.sh_type != SHT_NOBITS) {
+      memcpy(dest + part->image_offset,
+             elf->data + section.sh_offset + part->region.offset,
+             part->region.size);
+    }
+  }
+
+  if (elf->header.e_type != ET_REL) {
+    return 0;
+  }
+  for (size_t i = 0; i < image->num_parts; i++) {
+    struct link_ctx link = {image, &image->parts[i], dest};
+    if (for_each_relocation(ms, elf, &image->parts[i].region, relocate,
+                            &link)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void elf_image_free(struct elf_image *image) {
+  free(image->parts);
+  memset(image, 0, sizeof(*image));
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ELF_LINKER_H
+#define ELF_LINKER_H
+#include "elf_parser.h"
+
+/**
+ * A minimal static linker for relocatable ELF files (*.o).
+ *
+ * The code of a symbol is laid out first in the image, such that the image
+ * starts with the function's entry point. Every section its relocations
+ * reference (.rodata, .data, .bss, other .text sections, ...) is appended as
+ * a whole, as well as everything those reference in turn. The relocations of
+ * all parts are then applied for the address the image is copied to.
+ * Each part keeps the alignment of its section relative to the start of the
+ * image, which has to be copied to a multiple of the largest of them.
+ *
+ * Code the assembler has already resolved (e.g. a call to a static function
+ * in the same section) has no relocation; compile with -ffunction-sections to
+ * have calls between functions relocated.
+ * Executables and shared objects are copied without relocating anything.
+ */
+
+// @var region is placed at @var image_offset of the image
+struct elf_image_part {
+  struct elf_region region;
+  size_t image_offset;
+};
+
+struct elf_image {
+  struct elf_image_part *parts;
+  size_t num_parts;
+  size_t capacity;
+  // bytes of the whole image
+  size_t size;
+  // largest alignment of any part, the image must start at a multiple of it
+  size_t alignment;
+  // set by elf_image_link if it wrote absolute addresses into the image, which
+  // then only works where it has been linked to
+  int position_dependent;
+};
+
+/**
+ * Lays out the image of @param code in @param image.
+ * Fails with E_LOAD__ELF_UNDEFINED_REFERENCE if anything in it references a
+ * symbol which is not defined in the file.
+ */
+int elf_image_layout(measuresuite_t ms, const struct ms_elf *elf,
+                     const struct elf_region *code, struct elf_image *image);
+
+/**
+ * Copies @param image to @param dest (image->size bytes) and applies the
+ * relocations for that address. Fails with E_LOAD__ELF_RELOCATION for
+ * unsupported relocation types or values which do not fit.
+ */
+int elf_image_link(measuresuite_t ms, const struct ms_elf *elf,
+                   struct elf_image *image, uint8_t *dest);
+
+void elf_image_free(struct elf_image *image);
+#endif
@@ -13,121 +13,371 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+
+// O_CLOEXEC
+#define _POSIX_C_SOURCE 200809L
+
 #include "elf_parser.h"
 #include "../error/error.h"
+#include "../hash.h"
+#include "debug.h"
 
-#include "elf_file.h"
-#include "elf_memory.h"
+#include <errno.h>    // errno
+#include <fcntl.h>    // open
+#include <stdint.h>   // SIZE_MAX
+#include <stdlib.h>   // calloc
+#include <string.h>   // memcpy, strcmp
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
 
-#include <assert.h> // assert
-#include <elf.h>    // Elf64_Ehdr
-#include <errno.h>  // errno
-#include <fcntl.h>  // open
-#include <stdint.h> // int32_t's
-#include <stdlib.h> // malloc
-#include <string.h> // strncmp
-#include <unistd.h> // lseek/read/SEEK_SET
+static const unsigned char elf_magic[SELFMAG] = {ELFMAG0, ELFMAG1, ELFMAG2,
+                                                 ELFMAG3};
 
-int elf_load_symbol(measuresuite_t ms, void *dest, size_t dest_size,
-                    const char *filename, const char *symbol) {
+int elf_invalid(measuresuite_t ms, const struct ms_elf *elf) {
+  ms->errorno =
+      elf->mapped ? E_LOAD__ELF_FILE_INVALID_ELF : E_LOAD__ELF_MEM_INVALID_ELF;
+  return 1;
+}
 
-  // open file
-  int file = open(filename, O_RDONLY | O_SYNC);
-  if (file < 0) {
-    ms->errorno = E_LOAD__ELF_FILE_IO;
-    ms->additional_info = strerror(errno);
-    return 1;
-  }
+int elf_in_bounds(const struct ms_elf *elf, uint64_t offset, uint64_t len) {
+  return offset <= elf->size && len <= elf->size - offset;
+}
 
-  Elf64_Ehdr eh64; /* elf-header is fixed size */
-  /* ELF header : at start of file */
-  if (read_elf_header(file, &eh64)) {
-    ms->errorno = E_LOAD__ELF_FILE_INVALID_ELF;
-    return 1;
+// the headers may be unaligned in memory, hence they are copied
+void elf_get_section(const struct ms_elf *elf, size_t i, Elf64_Shdr *dest) {
+  memcpy(dest, elf->data + elf->header.e_shoff + i * elf->header.e_shentsize,
+         sizeof(*dest));
+}
+
+void elf_get_symbol(const struct ms_elf *elf, size_t i, Elf64_Sym *dest) {
+  memcpy(dest, elf->data + elf->symtab.sh_offset + i * sizeof(*dest),
+         sizeof(*dest));
+}
+
+// @returns the name of @param sym, "" if it has none
+static const char *symbol_name(const struct ms_elf *elf, const Elf64_Sym *sym) {
+  if (sym->st_name == 0 || sym->st_name >= elf->strtab.sh_size) {
+    return "";
   }
+  return (const char *)elf->data + elf->strtab.sh_offset + sym->st_name;
+}
 
-  /* Section header table :  */
-  Elf64_Shdr *sh_tbl = malloc((long)eh64.e_shentsize * eh64.e_shnum);
-  if (!sh_tbl || read_section_header_table64(file, eh64, sh_tbl)) {
+static size_t slot_of(const struct ms_elf *elf, const char *name) {
+  return hash_bytes(name, strlen(name), 0) & elf->index_mask;
+}
+
+int elf_build_index(measuresuite_t ms, struct ms_elf *elf) {
+  const size_t num_symbols = elf_num_symbols(elf);
+  size_t capacity = 8;
+  while (capacity < 2 * num_symbols) {
+    capacity <<= 1;
+  }
+  elf->index = calloc(capacity, sizeof(*elf->index));
+  if (elf->index == NULL) {
     ms->errorno = E_LOAD__ELF_FILE_MALLOC;
+    ms->additional_info = strerror(errno);
     return 1;
   }
+  elf->index_mask = capacity - 1;
 
-  unsigned long index = 0; // get offset of .text first
-  find_section_offset(file, eh64, sh_tbl, ".text", &index);
-  Elf64_Shdr text = sh_tbl[index];
+  // entry 0 is the undefined symbol
+  for (size_t i = 1; i < num_symbols; i++) {
+    Elf64_Sym sym;
+    elf_get_symbol(elf, i, &sym);
+    const char *name = symbol_name(elf, &sym);
+    if (*name == '\0' || sym.st_shndx == SHN_UNDEF) {
+      continue;
+    }
 
-  Elf64_Sym sym = {0};
-  find_symbol_in_table(file, eh64, sh_tbl, symbol, &sym);
-  free(sh_tbl);
+    size_t slot = slot_of(elf, name);
+    Elf64_Sym other = {0};
+    while (elf->index[slot] != 0) {
+      elf_get_symbol(elf, elf->index[slot] - 1, &other);
+      if (strcmp(symbol_name(elf, &other), name) == 0) {
+        break;
+      }
+      slot = (slot + 1) & elf->index_mask;
+    }
+    // local symbols may share a name, the first global one takes precedence
+    if (elf->index[slot] == 0 ||
+        (ELF64_ST_BIND(other.st_info) == STB_LOCAL &&
+         ELF64_ST_BIND(sym.st_info) != STB_LOCAL)) {
+      elf->index[slot] = i + 1;
+    }
+  }
+  return 0;
+}
 
-  // now we wwant to copy into dest from symbol-offset to the end of the section
-  // size to copy is
-  unsigned long size = text.sh_size - sym.st_value;
+// sets the symbol table of @param elf to its first section of @param type and
+// its string table. sh_size stays 0 if there is none.
+static int select_symbols(measuresuite_t ms, struct ms_elf *elf,
+                          uint32_t type) {
+  memset(&elf->symtab, 0, sizeof(elf->symtab));
+  memset(&elf->strtab, 0, sizeof(elf->strtab));
+  for (size_t i = 0; i < elf->header.e_shnum; i++) {
+    Elf64_Shdr section;
+    elf_get_section(elf, i, &section);
+    if (section.sh_type == type) {
+      elf->symtab = section;
+      break;
+    }
+  }
 
-  // check if destination buffer is big enough
-  assert(size <= dest_size);
+  if (elf->symtab.sh_size != 0) {
+    if (elf->symtab.sh_link >= elf->header.e_shnum ||
+        !elf_in_bounds(elf, elf->symtab.sh_offset, elf->symtab.sh_size)) {
+      return elf_invalid(ms, elf);
+    }
+    elf_get_section(elf, elf->symtab.sh_link, &elf->strtab);
+    // names must be NUL-terminated within the table
+    if (elf->strtab.sh_size == 0 ||
+        !elf_in_bounds(elf, elf->strtab.sh_offset, elf->strtab.sh_size) ||
+        elf->data[elf->strtab.sh_offset + elf->strtab.sh_size - 1] != '\0') {
+      return elf_invalid(ms, elf);
+    }
+  }
+  return 0;
+}
 
-  // then position in file is
-  unsigned long offset_in_file = text.sh_offset + sym.st_value;
+static int parse(measuresuite_t ms, const uint8_t *data, size_t size,
+                 int mapped, struct ms_elf *elf) {
+  memset(elf, 0, sizeof(*elf));
+  elf->data = data;
+  elf->size = size == 0 ? SIZE_MAX - (uintptr_t)data : size;
+  elf->mapped = mapped;
 
-  // read code into *dest
-  lseek(file, (long)offset_in_file, SEEK_SET);
-  if ((unsigned long)read(file, dest, size) != size) {
-    ms->errorno = E_LOAD__ELF_FILE_IO;
+  Elf64_Ehdr *hdr = &elf->header;
+  if (!elf_in_bounds(elf, 0, sizeof(*hdr))) {
+    return elf_invalid(ms, elf);
+  }
+  memcpy(hdr, data, sizeof(*hdr));
+  if (memcmp(hdr->e_ident, elf_magic, SELFMAG) != 0 ||
+      hdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+      hdr->e_shentsize < sizeof(Elf64_Shdr) ||
+      !elf_in_bounds(elf, hdr->e_shoff,
+                     (uint64_t)hdr->e_shnum * hdr->e_shentsize)) {
+    return elf_invalid(ms, elf);
+  }
+
+  if (select_symbols(ms, elf, SHT_SYMTAB)) {
+    return 1;
+  }
+  if (elf->symtab.sh_size == 0 && select_symbols(ms, elf, SHT_DYNSYM)) {
     return 1;
-  };
+  }
 
+  DEBUG("elf: %lu sections, %lu symbols\n", (size_t)hdr->e_shnum,
+        elf_num_symbols(elf));
   return 0;
 }
 
-int elf_load_symbol_mem(measuresuite_t ms, void *dest, size_t dest_size,
-                        const uint8_t *src, const char *symbol) {
-  // read elf header
-  // read section header table
-  // find .text - section
-  // find symbol
-  // 	-- read all sections from table
-  // 	-- skip sections which are not SHT_SYMTAB / SHT_DYNSYM
-  // 	-- read SHT_SYMTAB / SHT_DYNSYM
-
-  Elf64_Ehdr eh64; /* elf-header is fixed size */
-  /* ELF header : at start of file */
-  if (read_elf_header_mem(src, &eh64)) {
-    ms->errorno = E_LOAD__ELF_MEM_INVALID_ELF;
+int elf_parse(measuresuite_t ms, const uint8_t *data, size_t size,
+              struct ms_elf *elf) {
+  return parse(ms, data, size, 0, elf);
+}
+
+int elf_open(measuresuite_t ms, const char *filename, struct ms_elf *elf) {
+  memset(elf, 0, sizeof(*elf));
+
+  int file = open(filename, O_RDONLY | O_CLOEXEC);
+  struct stat stats;
+  if (file < 0 || fstat(file, &stats)) {
+    ms->errorno = E_LOAD__ELF_FILE_IO;
+    ms->additional_info = strerror(errno);
+    if (file >= 0) {
+      close(file);
+    }
+    return 1;
+  }
+  if ((size_t)stats.st_size < sizeof(Elf64_Ehdr)) {
+    close(file);
+    ms->errorno = E_LOAD__ELF_FILE_INVALID_ELF;
     return 1;
   }
 
-  /* Section header table :  */
+  void *data = mmap(NULL, stats.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  int mmap_errno = errno;
+  close(file);
+  // NOLINTNEXTLINE
+  if (data == MAP_FAILED) {
+    ms->errorno = E_LOAD__ELF_FILE_IO;
+    ms->additional_info = strerror(mmap_errno);
+    return 1;
+  }
 
-  Elf64_Shdr *sh_tbl = malloc((long)eh64.e_shentsize * eh64.e_shnum);
-  if (!sh_tbl || read_section_header_table64_mem(src, eh64, sh_tbl)) {
-    ms->errorno = E_LOAD__ELF_FILE_MALLOC;
+  if (parse(ms, data, stats.st_size, 1, elf)) {
+    ERROR_NUMBER errorno = ms->errorno;
+    elf_close(ms, elf);
+    ms->errorno = errorno;
     return 1;
   }
+  return 0;
+}
 
-  unsigned long index = 0; // get offset of .text first
-  find_section_offset_mem(src, eh64, sh_tbl, ".text", &index);
-  Elf64_Shdr text = sh_tbl[index];
+int elf_use_dynamic_symbols(measuresuite_t ms, struct ms_elf *elf) {
+  free(elf->index);
+  elf->index = NULL;
+  return select_symbols(ms, elf, SHT_DYNSYM);
+}
 
-  Elf64_Sym sym = {0};
-  find_symbol_in_table_mem(&sym, src, sh_tbl, eh64.e_shnum, symbol);
-  free(sh_tbl);
+int elf_close(measuresuite_t ms, struct ms_elf *elf) {
+  int ret = 0;
+  if (elf->mapped && elf->data != NULL &&
+      munmap((void *)elf->data, elf->size)) {
+    ms->errorno = E_LOAD__ELF_FILE_IO;
+    ms->additional_info = strerror(errno);
+    ret = 1;
+  }
+  free(elf->index);
+  memset(elf, 0, sizeof(*elf));
+  return ret;
+}
 
-  // now we wwant to copy into dest from symbol-offset to the end of the section
-  // size to copy is
-  unsigned long size = text.sh_size - sym.st_value;
+size_t elf_num_symbols(const struct ms_elf *elf) {
+  return elf->symtab.sh_size / sizeof(Elf64_Sym);
+}
+
+const char *elf_symbol_name(const struct ms_elf *elf, size_t i) {
+  Elf64_Sym sym;
+  elf_get_symbol(elf, i, &sym);
+  return symbol_name(elf, &sym);
+}
+
+int elf_is_function(const struct ms_elf *elf, size_t i) {
+  Elf64_Sym sym;
+  elf_get_symbol(elf, i, &sym);
+  if (sym.st_shndx == SHN_UNDEF || sym.st_shndx >= elf->header.e_shnum) {
+    return 0;
+  }
+  switch (ELF64_ST_TYPE(sym.st_info)) {
+  case STT_FUNC:
+    return 1;
+  case STT_NOTYPE: {
+    Elf64_Shdr section;
+    elf_get_section(elf, sym.st_shndx, &section);
+    return ELF64_ST_BIND(sym.st_info) != STB_LOCAL &&
+           (section.sh_flags & SHF_EXECINSTR) != 0;
+  }
+  default:
+    return 0;
+  }
+}
 
-  // check if destination buffer is big enough
-  assert(size <= dest_size);
+// sets @param region to section @param index from @param offset to its end
+static int section_region(measuresuite_t ms, const struct ms_elf *elf,
+                          size_t index, uint64_t offset,
+                          struct elf_region *region) {
+  Elf64_Shdr section;
+  elf_get_section(elf, index, &section);
+  if (section.sh_type == SHT_NOBITS || offset > section.sh_size ||
+      !elf_in_bounds(elf, section.sh_offset, section.sh_size)) {
+    return elf_invalid(ms, elf);
+  }
+  region->section = index;
+  region->offset = offset;
+  region->size = section.sh_size - offset;
+  return 0;
+}
 
-  // calc offset in mem
-  unsigned long offset_in_mem = text.sh_offset + sym.st_value;
-  // then position in memory is
-  const uint8_t *pos_in_mem = src + offset_in_mem;
+// @returns the distance from @param sym to the next function in its section,
+// or @param limit if there is none closer
+static uint64_t next_function_distance(const struct ms_elf *elf,
+                                       const Elf64_Sym *sym, uint64_t limit) {
+  for (size_t j = 1; j < elf_num_symbols(elf); j++) {
+    Elf64_Sym other;
+    elf_get_symbol(elf, j, &other);
+    if (other.st_shndx == sym->st_shndx && other.st_value > sym->st_value &&
+        other.st_value - sym->st_value < limit && elf_is_function(elf, j)) {
+      limit = other.st_value - sym->st_value;
+    }
+  }
+  return limit;
+}
 
-  // read code into *dest
-  memcpy(dest, pos_in_mem, size);
+int elf_symbol_region(measuresuite_t ms, const struct ms_elf *elf, size_t i,
+                      struct elf_region *region) {
+  Elf64_Sym sym;
+  elf_get_symbol(elf, i, &sym);
+  if (sym.st_shndx == SHN_UNDEF || sym.st_shndx >= elf->header.e_shnum) {
+    return elf_invalid(ms, elf);
+  }
+  Elf64_Shdr section;
+  elf_get_section(elf, sym.st_shndx, &section);
+  // st_value is an address in executables, sh_addr is 0 in object files
+  if (section_region(ms, elf, sym.st_shndx, sym.st_value - section.sh_addr,
+                     region)) {
+    return 1;
+  }
 
+  if (sym.st_size != 0) {
+    if (sym.st_size > region->size) {
+      return elf_invalid(ms, elf);
+    }
+    region->size = sym.st_size;
+  } else if (elf_is_function(elf, i)) {
+    // assemblers only emit a size if told to
+    region->size = next_function_distance(elf, &sym, region->size);
+  }
   return 0;
 }
+
+int elf_find_region(measuresuite_t ms, const struct ms_elf *elf,
+                    const char *symbol, struct elf_region *region) {
+  if (symbol == NULL) {
+    Elf64_Shdr shstrtab;
+    if (elf->header.e_shstrndx >= elf->header.e_shnum) {
+      return elf_invalid(ms, elf);
+    }
+    elf_get_section(elf, elf->header.e_shstrndx, &shstrtab);
+    for (size_t i = 0; i < elf->header.e_shnum; i++) {
+      Elf64_Shdr section;
+      elf_get_section(elf, i, &section);
+      static const char text[] = ".text";
+      if (section.sh_name < shstrtab.sh_size &&
+          shstrtab.sh_size - section.sh_name >= sizeof(text) &&
+          elf_in_bounds(elf, shstrtab.sh_offset, shstrtab.sh_size) &&
+          memcmp(elf->data + shstrtab.sh_offset + section.sh_name, text,
+                 sizeof(text)) == 0) {
+        return section_region(ms, elf, i, 0, region);
+      }
+    }
+    ms->errorno = E_LOAD__ELF_SYMBOL_NOT_FOUND;
+    return 1;
+  }
+
+  if (elf->index != NULL) {
+    for (size_t slot = slot_of(elf, symbol); elf->index[slot] != 0;
+         slot = (slot + 1) & elf->index_mask) {
+      Elf64_Sym sym;
+      elf_get_symbol(elf, elf->index[slot] - 1, &sym);
+      if (strcmp(symbol_name(elf, &sym), symbol) == 0) {
+        return elf_symbol_region(ms, elf, elf->index[slot] - 1, region);
+      }
+    }
+  } else {
+    // for a single lookup, scanning is cheaper than indexing.
+    // Same precedence as the index: the first global, else the first local.
+    size_t found = 0;
+    for (size_t i = 1; i < elf_num_symbols(elf); i++) {
+      Elf64_Sym sym;
+      elf_get_symbol(elf, i, &sym);
+      if (sym.st_shndx == SHN_UNDEF ||
+          strcmp(symbol_name(elf, &sym), symbol) != 0) {
+        continue;
+      }
+      if (ELF64_ST_BIND(sym.st_info) != STB_LOCAL) {
+        found = i;
+        break;
+      }
+      if (found == 0) {
+        found = i;
+      }
+    }
+    if (found != 0) {
+      return elf_symbol_region(ms, elf, found, region);
+    }
+  }
+  ms->errorno = E_LOAD__ELF_SYMBOL_NOT_FOUND;
+  return 1;
+}
@@ -16,9 +16,93 @@
 #ifndef ELF_PARSER_H
 #define ELF_PARSER_H
 #include "../struct_measuresuite.h"
+#include <elf.h>
 
-int elf_load_symbol(measuresuite_t ms, void *dest, size_t dest_size,
-                    const char *filename, const char *symbol);
-int elf_load_symbol_mem(measuresuite_t ms, void *dest, size_t dest_size,
-                        const uint8_t *src, const char *symbol);
+/**
+ * A parsed ELF64 file, i.e. what an ms_elf_t points to.
+ * Nothing is copied out of the file but the headers; code is read straight
+ * from @var data.
+ */
+struct ms_elf {
+  // the whole file, mmap'ed by elf_open if @var mapped is set
+  const uint8_t *data;
+  size_t size;
+  int mapped;
+
+  Elf64_Ehdr header;
+  // SHT_SYMTAB, or SHT_DYNSYM if there is none (sh_size 0 if neither)
+  Elf64_Shdr symtab;
+  // the string table of symtab
+  Elf64_Shdr strtab;
+
+  // open addressing hash table over the names of all defined symbols, NULL
+  // until elf_build_index. Holds symbol index + 1, 0 marks an empty slot.
+  uint32_t *index;
+  size_t index_mask;
+};
+
+// a byte range of one section of an ELF file
+struct elf_region {
+  size_t section; // index into the section headers
+  uint64_t offset;
+  uint64_t size;
+};
+
+/**
+ * Parses the ELF file of @param size bytes at @param data into @param elf.
+ * @param size may be 0 if unknown, then nothing is bounds-checked.
+ * @param data must outlive @param elf.
+ */
+int elf_parse(measuresuite_t ms, const uint8_t *data, size_t size,
+              struct ms_elf *elf);
+
+// mmaps @param filename and parses it into @param elf
+int elf_open(measuresuite_t ms, const char *filename, struct ms_elf *elf);
+
+// builds the index of @param elf, which pays off from a few lookups on.
+// Without it, elf_find_code scans the symbol table.
+int elf_build_index(measuresuite_t ms, struct ms_elf *elf);
+
+// switches @param elf to its SHT_DYNSYM symbol table, i.e. to the symbols a
+// shared object exports. Drops the index, build it afterwards.
+int elf_use_dynamic_symbols(measuresuite_t ms, struct ms_elf *elf);
+
+// frees the index of @param elf, and unmaps its file if it mapped one
+int elf_close(measuresuite_t ms, struct ms_elf *elf);
+
+// sets ms->errorno to the invalid-ELF error matching @param elf. @returns 1
+int elf_invalid(measuresuite_t ms, const struct ms_elf *elf);
+
+// @returns 1 if [@param offset, @param offset + @param len) is in the file
+int elf_in_bounds(const struct ms_elf *elf, uint64_t offset, uint64_t len);
+
+// copy section header / symbol @param i of @param elf to @param dest
+void elf_get_section(const struct ms_elf *elf, size_t i, Elf64_Shdr *dest);
+void elf_get_symbol(const struct ms_elf *elf, size_t i, Elf64_Sym *dest);
+
+// @returns the number of entries in the symbol table of @param elf
+size_t elf_num_symbols(const struct ms_elf *elf);
+
+// @returns the name of entry @param i of the symbol table, "" if it has none
+const char *elf_symbol_name(const struct ms_elf *elf, size_t i);
+
+// @returns 1 if entry @param i of the symbol table is a function. That is an
+// STT_FUNC, or an untyped global label in an executable section, as
+// assemblers emit unless told otherwise.
+int elf_is_function(const struct ms_elf *elf, size_t i);
+
+/**
+ * Sets @param region to the code of entry @param i of the symbol table, i.e.
+ * its st_size bytes. Without a size, functions end at the next function in
+ * their section, other symbols at the end of it.
+ */
+int elf_symbol_region(measuresuite_t ms, const struct ms_elf *elf, size_t i,
+                      struct elf_region *region);
+
+/**
+ * Like elf_symbol_region, but looks @param symbol up by name.
+ * If @param symbol is NULL, the whole .text section is used.
+ */
+int elf_find_region(measuresuite_t ms, const struct ms_elf *elf,
+                    const char *symbol, struct elf_region *region);
 #endif
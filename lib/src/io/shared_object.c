@@ -13,43 +13,202 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+
+// memfd_create is not part of strict C17 / POSIX
+#define _GNU_SOURCE
+
 #include "shared_object.h"
 #include "../error/error.h"
-#include <dlfcn.h>  // dlopen
-#include <errno.h>  // errno
-#include <string.h> // strerror
-#include <unistd.h> // access|F_OK...
+#include <dlfcn.h>    // dlopen
+#include <errno.h>    // errno
+#include <stdio.h>    // snprintf
+#include <string.h>   // strerror
+#include <sys/mman.h> // memfd_create
+#include <sys/stat.h> // stat
+#include <unistd.h>   // access|F_OK...
+
+// @returns the cache entry of @param handle, NULL if there is none
+static struct so_cache_entry *find_handle(struct so_cache *cache,
+                                          const void *handle) {
+  for (size_t i = 0; i < cache->num; i++) {
+    if (cache->entries[i].handle == handle) {
+      return &cache->entries[i];
+    }
+  }
+  return NULL;
+}
+
+// adds @param handle of the file @param stats, open as @param fd (or -1), to
+// the cache
+static int insert(struct measuresuite *ms, const struct stat *stats,
+                  void *handle, int fd) {
+  struct so_cache *cache = &ms->so_cache;
+  if (cache->num == cache->capacity) {
+    size_t capacity = cache->capacity == 0 ? 4 : 2 * cache->capacity;
+    struct so_cache_entry *entries =
+        realloc(cache->entries, capacity * sizeof(*entries));
+    if (entries == NULL) {
+      ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+      ms->additional_info = strerror(errno);
+      return 1;
+    }
+    cache->entries = entries;
+    cache->capacity = capacity;
+  }
+  cache->entries[cache->num++] = (struct so_cache_entry){
+      .dev = stats->st_dev,
+      .ino = stats->st_ino,
+      .handle = handle,
+      .fd = fd,
+      .refs = 1};
+  return 0;
+}
 
-int so_load_file(struct measuresuite *ms, struct function_tuple *fct,
-                 const char *filename) {
+// closes @param handle
+static int close_handle(struct measuresuite *ms, void *handle) {
+  // clear error
+  dlerror();
 
-  if (access(filename, F_OK | X_OK | R_OK) != 0) {
+  // close and check
+  if (dlclose(handle) != 0) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__DLCLOSE;
+    ms->additional_info = dlerror();
+    return 1;
+  }
+
+  return 0;
+}
+
+// closes the handles whose last reference has been released. Done on the
+// next load, as the pending dlerror() message has been reported by then.
+static int close_released(struct measuresuite *ms) {
+  struct so_cache *cache = &ms->so_cache;
+  for (size_t i = cache->num; i > 0; i--) {
+    struct so_cache_entry entry = cache->entries[i - 1];
+    if (entry.refs > 0) {
+      continue;
+    }
+    cache->entries[i - 1] = cache->entries[--cache->num];
+    int ret = close_handle(ms, entry.handle);
+    if (entry.fd >= 0) {
+      close(entry.fd);
+    }
+    if (ret) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int so_load_file(struct measuresuite *ms, const char *filename,
+                 void **handle) {
+
+  if (close_released(ms)) {
+    return 1;
+  }
+
+  struct stat stats;
+  if (access(filename, F_OK | X_OK | R_OK) != 0 || stat(filename, &stats)) {
     ms->errorno = E_LOAD__SO_FILE;
     ms->additional_info = strerror(errno);
     return 1;
   }
 
+  // the same file may be reached through different paths
+  struct so_cache *cache = &ms->so_cache;
+  for (size_t i = 0; i < cache->num; i++) {
+    if (cache->entries[i].dev == stats.st_dev &&
+        cache->entries[i].ino == stats.st_ino) {
+      cache->entries[i].refs++;
+      *handle = cache->entries[i].handle;
+      return 0;
+    }
+  }
+
   // clear error
   dlerror();
 
   // open
-  fct->lib_handle = dlopen(filename, RTLD_NOW | RTLD_LOCAL);
+  *handle = dlopen(filename, RTLD_NOW | RTLD_LOCAL);
 
   // check
-  if (fct->lib_handle == NULL) {
+  if (*handle == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__DLOPEN;
+    ms->additional_info = dlerror();
+    return 1;
+  }
+
+  if (insert(ms, &stats, *handle, -1)) {
+    dlclose(*handle);
+    *handle = NULL;
+    return 1;
+  }
+  return 0;
+}
+
+// writes the @param size bytes at @param data to @param fd
+static int write_all(int fd, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 1;
+    }
+    data += written;
+    size -= (size_t)written;
+  }
+  return 0;
+}
+
+int so_load_data(struct measuresuite *ms, const uint8_t *data, size_t size,
+                 void **handle) {
+  if (close_released(ms)) {
+    return 1;
+  }
+
+  int fd = memfd_create("measuresuite.so", MFD_CLOEXEC);
+  struct stat stats;
+  if (fd < 0 || write_all(fd, data, size) || fstat(fd, &stats)) {
+    ms->errorno = E_LOAD__SO_MEMFD;
+    ms->additional_info = strerror(errno);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 1;
+  }
+
+  // glibc reuses a loaded library of the same name, so the fd stays open
+  // (and its number taken) as long as the library is
+  char path[sizeof("/proc/self/fd/") + 3 * sizeof(int)];
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+
+  // clear error
+  dlerror();
+
+  *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (*handle == NULL) {
     ms->errorno = E_INTERNAL_MEASURE__AI__DLOPEN;
     ms->additional_info = dlerror();
+    close(fd);
     return 1;
   }
 
+  if (insert(ms, &stats, *handle, fd)) {
+    dlclose(*handle);
+    close(fd);
+    *handle = NULL;
+    return 1;
+  }
   return 0;
 }
 
-int so_load_symbol(struct measuresuite *ms, struct function_tuple *fct,
-                   const char *symbol) {
+int so_load_symbol(struct measuresuite *ms, void *handle, const char *symbol,
+                   void **code) {
 
   // sanity check  the handle
-  if (fct->lib_handle == NULL) {
+  if (handle == NULL) {
     return 1;
   }
 
@@ -57,10 +216,10 @@ int so_load_symbol(struct measuresuite *ms, struct function_tuple *fct,
   dlerror();
 
   // load
-  fct->code = dlsym(fct->lib_handle, symbol);
+  *code = dlsym(handle, symbol);
 
   /// check
-  if (fct->code == NULL) {
+  if (*code == NULL) {
     ms->errorno = E_INTERNAL_MEASURE__AI__DLSYM;
     ms->additional_info = dlerror();
     return 1;
@@ -69,16 +228,38 @@ int so_load_symbol(struct measuresuite *ms, struct function_tuple *fct,
   return 0;
 }
 
-int so_unload_file(struct measuresuite *ms, struct function_tuple *fct) {
-  // clear error
-  dlerror();
+void so_release_file(struct measuresuite *ms, void *handle) {
+  struct so_cache_entry *entry = find_handle(&ms->so_cache, handle);
+  if (entry != NULL && entry->refs > 0) {
+    entry->refs--;
+  }
+}
 
-  // close and check
-  if (dlclose(fct->lib_handle) != 0) {
-    ms->errorno = E_INTERNAL_MEASURE__AI__DLCLOSE;
-    ms->additional_info = dlerror();
-    return 1;
+int so_unload_file(struct measuresuite *ms, void *handle) {
+  struct so_cache *cache = &ms->so_cache;
+  struct so_cache_entry *entry = find_handle(cache, handle);
+  if (entry != NULL && --entry->refs > 0) {
+    return 0;
+  }
+  int fd = -1;
+  if (entry != NULL) {
+    fd = entry->fd;
+    *entry = cache->entries[--cache->num];
   }
+  int ret = close_handle(ms, handle);
+  if (fd >= 0) {
+    close(fd);
+  }
+  return ret;
+}
 
+int end_so_cache(struct measuresuite *ms) {
+  struct so_cache *cache = &ms->so_cache;
+  // only released ones are left once all functions are unloaded
+  if (close_released(ms)) {
+    return 1;
+  }
+  free(cache->entries);
+  memset(cache, 0, sizeof(*cache));
   return 0;
 }
@@ -18,9 +18,23 @@
 
 #include "../struct_measuresuite.h"
 
-int so_load_file(struct measuresuite *ms, struct function_tuple *fct,
-                 const char *filename);
-int so_load_symbol(struct measuresuite *ms, struct function_tuple *fct,
-                   const char *symbol);
-int so_unload_file(struct measuresuite *ms, struct function_tuple *fct);
+// dlopens @param filename into @param handle. Each file is opened once per
+// instance, further loads share the handle and count a reference.
+int so_load_file(struct measuresuite *ms, const char *filename,
+                 void **handle);
+// dlopens the shared object of @param size bytes at @param data into
+// @param handle, through a memfd. Each call opens a library of its own.
+int so_load_data(struct measuresuite *ms, const uint8_t *data, size_t size,
+                 void **handle);
+// sets @param code to the address of @param symbol in @param handle
+int so_load_symbol(struct measuresuite *ms, void *handle, const char *symbol,
+                   void **code);
+// drops a reference to @param handle, and dlcloses it with the last one
+int so_unload_file(struct measuresuite *ms, void *handle);
+// drops a reference to @param handle, but keeps it open until the next load
+// (or end_so_cache). Unlike so_unload_file, this keeps a pending dlerror()
+// message valid.
+void so_release_file(struct measuresuite *ms, void *handle);
+// dlcloses the released handles and frees the cache
+int end_so_cache(struct measuresuite *ms);
 #endif
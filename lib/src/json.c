@@ -17,98 +17,249 @@
 #include "alloc_helper.h"
 #include "debug.h"
 #include "struct_measuresuite.h"
+#include <string.h> // memcpy
 
-#define PRINT(...)                                                             \
-  size = json_end - json;                                                      \
-  len = snprintf(json, size, ##__VA_ARGS__);                                   \
-  if (len >= size) {                                                           \
-    goto enlarge;                                                              \
-  }                                                                            \
-  json += len;
-
-// NOLINTBEGIN (readability-function-cognitive-complexity)
-int generate_json(struct measuresuite *ms, uint64_t delta_in_seconds,
-                  size_t check_result) {
-  char *json = ms->json;
-  char *json_end = ms->json + ms->json_len - 1;
-
-  size_t size = 0; // available
-  size_t len = 0;  // written
-
-  PRINT("{\"stats\":"
-        "{"
-        "\"numFunctions\":%" PRIu64 ","
-        "\"runtime\":%" PRIu64 "," // in seconds
-        "\"incorrect\":%" PRIu64
-        "," // index
-            // if incorrect is '0', all functions calculate the same, otherwise
-            // the index of which function is incorrect to the previous one.
-
-        "\"timer\":\"%s\"" // string "RDTSCP" or "PMC"
-        "},"
-        "\"functions\":[",
-        ms->num_functions, delta_in_seconds, check_result,
-        ms_get_timer(ms) == PMC ? "PMC" : "RDTSCP");
+// two decimal digits per entry, "00" to "99"
+static const char digit_pairs[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
 
-  // print function meta data
-  //
-
-  FOR_EACH_FUNCTION {
-    switch (fct->type) {
-    case ASM:
-#ifdef USE_ASSEMBLYLINE
-      PRINT("{\"type\":\"ASM\", \"chunks\":%" PRIi32 "},", fct->chunks);
-#endif
-      break;
-    case BIN:
-      PRINT("{\"type\":\"BIN\"},");
-      break;
-    case ELF:
-      PRINT("{\"type\":\"ELF\"},");
-      break;
-    case SHARED_OBJECT:
-      PRINT("{\"type\":\"SHARED_OBJECT\"},");
-      break;
+static const uint64_t powers_of_ten[] = {1ULL,
+                                         10ULL,
+                                         100ULL,
+                                         1000ULL,
+                                         10000ULL,
+                                         100000ULL,
+                                         1000000ULL,
+                                         10000000ULL,
+                                         100000000ULL,
+                                         1000000000ULL,
+                                         10000000000ULL,
+                                         100000000000ULL,
+                                         1000000000000ULL,
+                                         10000000000000ULL,
+                                         100000000000000ULL,
+                                         1000000000000000ULL,
+                                         10000000000000000ULL,
+                                         100000000000000000ULL,
+                                         1000000000000000000ULL,
+                                         10000000000000000000ULL};
+
+size_t u64_dec_len(uint64_t value) {
+  // or'ing 1 does not change the number of digits, but avoids clz(0)
+  const uint64_t v = value | 1;
+  // log10 from log2 (1233 / 4096 ~ log10(2)), may be one too large
+  const size_t log10 = ((64 - __builtin_clzll(v)) * 1233) >> 12;
+  return log10 + 1 - (v < powers_of_ten[log10]);
+}
+
+char *u64_to_dec(char *dest, uint64_t value) {
+  char *end = dest + u64_dec_len(value);
+  char *cur = end;
+  while (value >= 100) {
+    const char *pair = &digit_pairs[(value % 100) * 2];
+    value /= 100;
+    *--cur = pair[1];
+    *--cur = pair[0];
+  }
+  if (value >= 10) {
+    *--cur = digit_pairs[value * 2 + 1];
+    *--cur = digit_pairs[value * 2];
+  } else {
+    *--cur = (char)('0' + value);
+  }
+  return end;
+}
+
+// functions are {"type":"ASM", "chunks":n,"codeSize":n,"member":"..."}, the
+// same without chunks for BIN and ELF, member only if there is one, and
+// {"type":"SHARED_OBJECT"}. The type strings are left open for the numbers,
+// but SHARED_OBJECT, which has none.
+static const char *const type_str[] = {
+    [ASM] = "{\"type\":\"ASM\", \"chunks\":",
+    [BIN] = "{\"type\":\"BIN\"",
+    [ELF] = "{\"type\":\"ELF\"",
+    [SHARED_OBJECT] = "{\"type\":\"SHARED_OBJECT\"}",
+};
+
+// the parts in between the numbers
+#define JSON_NUM_FUNCTIONS "{\"stats\":{\"numFunctions\":"
+// in seconds
+#define JSON_RUNTIME ",\"runtime\":"
+// index. If incorrect is '0', all functions calculate the same, otherwise
+// the index of which function is incorrect to the previous one.
+#define JSON_INCORRECT ",\"incorrect\":"
+// string "RDTSCP" or "PMC"
+#define JSON_TIMER ",\"timer\":\""
+#define JSON_FUNCTIONS "\"},\"functions\":["
+// bytes of machine code, after the type (and chunks)
+#define JSON_CODE_SIZE ",\"codeSize\":"
+// archive member name, a string
+#define JSON_MEMBER ",\"member\":\""
+#define JSON_CYCLES "],\"cycles\":["
+#define JSON_END "]}"
+
+#define LEN(literal) (sizeof(literal) - 1)
+
+static const char *timer_str(const struct ms_results *res) {
+  return res->timer == PMC ? "PMC" : "RDTSCP";
+}
+
+static const char hex_digits[] = "0123456789abcdef";
+
+// @returns the length of @param str as the contents of a JSON string
+static size_t escaped_len(const char *str) {
+  size_t len = 0;
+  for (; *str != '\0'; str++) {
+    const unsigned char c = *str;
+    len += c == '"' || c == '\\' ? 2 : c < 0x20 ? 6 : 1;
+  }
+  return len;
+}
+
+// writes @param str to @param dest, escaped for a JSON string
+static char *escape(char *dest, const char *str) {
+  for (; *str != '\0'; str++) {
+    const unsigned char c = *str;
+    if (c == '"' || c == '\\') {
+      *dest++ = '\\';
+      *dest++ = (char)c;
+    } else if (c < 0x20) {
+      memcpy(dest, "\\u00", 4);
+      dest[4] = hex_digits[c >> 4];
+      dest[5] = hex_digits[c & 0xf];
+      dest += 6;
+    } else {
+      *dest++ = (char)c;
     }
   }
+  return dest;
+}
 
-  // overwrite comma
-  json--;
-  PRINT("],\"cycles\":[");
+// chunks are an int, but never negative
+static uint64_t chunks_of(const struct ms_function_result *fct) {
+  return fct->chunks < 0 ? 0 : (uint64_t)fct->chunks;
+}
 
-  // print cycles
-  FOR_EACH_FUNCTION {
+// @returns the exact length of the JSON for @param res, without NUL
+static size_t json_len(const struct ms_results *res) {
+  size_t len = LEN(JSON_NUM_FUNCTIONS) + u64_dec_len(res->num_functions) +
+               LEN(JSON_RUNTIME) + u64_dec_len(res->runtime) +
+               LEN(JSON_INCORRECT) + u64_dec_len(res->incorrect) +
+               LEN(JSON_TIMER) + strlen(timer_str(res)) +
+               LEN(JSON_FUNCTIONS) + LEN(JSON_CYCLES) + LEN(JSON_END);
+
+  for (size_t i = 0; i < res->num_functions; i++) {
+    const struct ms_function_result *fct = &res->functions[i];
+    len += strlen(type_str[fct->type]) + (i > 0); // comma
+    if (fct->type == ASM) {
+      len += u64_dec_len(chunks_of(fct));
+    }
+    if (fct->type != SHARED_OBJECT) {
+      len += LEN(JSON_CODE_SIZE) + u64_dec_len(fct->code_size) + LEN("}");
+      if (fct->member != NULL) {
+        len += LEN(JSON_MEMBER) + escaped_len(fct->member) + LEN("\"");
+      }
+    }
 
-    PRINT("[");
-    for (size_t run_i = 0; run_i < ms->num_batches; run_i++) {
-      PRINT("%" PRIu64 ",", fct->cycle_results[run_i]);
+    // "[" numbers and commas "]", and a comma before all but the first
+    len += 2 + (res->num_batches - 1) + (i > 0);
+    for (size_t b = 0; b < res->num_batches; b++) {
+      len += u64_dec_len(fct->cycles[b]);
     }
-    // overwrite comma after last number
-    json--;
-    // close array and comma for next one
-    PRINT("],");
   }
+  return len;
+}
 
-  // overwrite comma after last array
-  json -= 1;
-  PRINT("]}");
+static char *append(char *dest, const char *str, size_t len) {
+  memcpy(dest, str, len);
+  return dest + len;
+}
 
-  return 0;
+#define APPEND(literal) json = append(json, literal, LEN(literal))
+
+// writes the JSON for @param res to @param json, which must be large enough
+static char *json_write(const struct ms_results *res, char *json) {
+  APPEND(JSON_NUM_FUNCTIONS);
+  json = u64_to_dec(json, res->num_functions);
+  APPEND(JSON_RUNTIME);
+  json = u64_to_dec(json, res->runtime);
+  APPEND(JSON_INCORRECT);
+  json = u64_to_dec(json, res->incorrect);
+  APPEND(JSON_TIMER);
+  json = append(json, timer_str(res), strlen(timer_str(res)));
 
-  // we did not have enough space.
-enlarge:
+  // print function meta data
+  APPEND(JSON_FUNCTIONS);
+  for (size_t i = 0; i < res->num_functions; i++) {
+    const struct ms_function_result *fct = &res->functions[i];
+    if (i > 0) {
+      *json++ = ',';
+    }
+    json = append(json, type_str[fct->type], strlen(type_str[fct->type]));
+    if (fct->type == ASM) {
+      json = u64_to_dec(json, chunks_of(fct));
+    }
+    if (fct->type != SHARED_OBJECT) {
+      APPEND(JSON_CODE_SIZE);
+      json = u64_to_dec(json, fct->code_size);
+      if (fct->member != NULL) {
+        APPEND(JSON_MEMBER);
+        json = escape(json, fct->member);
+        *json++ = '"';
+      }
+      *json++ = '}';
+    }
+  }
 
-  // enlarge
-  ms->json_len *= 2;
-  DEBUG("trying to realloc space for more json (new len: %lu) %lu, %lu\n",
-        ms->json_len, ms->num_batches, ms->batch_size);
-  DEBUG("JSON was: %s", ms->json);
-  if (realloc_or_fail(ms, (void **)&(ms->json), ms->json_len)) {
+  // print cycles
+  APPEND(JSON_CYCLES);
+  for (size_t i = 0; i < res->num_functions; i++) {
+    const uint64_t *cycles = res->functions[i].cycles;
+    if (i > 0) {
+      *json++ = ',';
+    }
+    *json++ = '[';
+    json = u64_to_dec(json, cycles[0]);
+    for (size_t b = 1; b < res->num_batches; b++) {
+      *json++ = ',';
+      json = u64_to_dec(json, cycles[b]);
+    }
+    *json++ = ']';
+  }
+  APPEND(JSON_END);
+  return json;
+}
+#undef APPEND
+
+int generate_json(struct measuresuite *ms) {
+  const struct ms_results *res = &ms->results;
+  // the cycles may have been taken by ms_take_cycles
+  if (res->num_functions > 0 && res->functions[0].cycles == NULL) {
+    ms->errorno = E_INVALID_INPUT__NO_MEASUREMENT;
     return 1;
   }
 
-  // and try again recursively
-  return generate_json(ms, delta_in_seconds, check_result);
+  // exact size, the buffer is only ever grown
+  const size_t len = json_len(res);
+  if (ms->json_len < len + 1) {
+    DEBUG("growing json buffer to %lu bytes\n", len + 1);
+    if (realloc_or_fail(ms, (void **)&ms->json, len + 1)) {
+      return 1;
+    }
+    ms->json_len = len + 1;
+  }
+
+  char *end = json_write(res, ms->json);
+  *end = '\0';
+  ms->json_chars = end - ms->json;
+  DEBUG("wrote %lu bytes of json, expected %lu\n", ms->json_chars, len);
+  return 0;
 }
-#undef PRINT
-// NOLINTEND
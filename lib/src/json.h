@@ -14,5 +14,17 @@
  * limitations under the License.
  */
 #include "struct_measuresuite.h"
-int generate_json(struct measuresuite *ms, uint64_t delta_in_seconds,
-                  size_t check_result);
+/**
+ * writes the JSON of ms->results into ms->json, growing it to the exact size
+ * needed if necessary.
+ */
+int generate_json(struct measuresuite *ms);
+
+// @returns the number of decimal digits of @param value
+size_t u64_dec_len(uint64_t value);
+
+/**
+ * writes @param value in decimal to @param dest, without NUL.
+ * @returns the end of the written digits
+ */
+char *u64_to_dec(char *dest, uint64_t value);
@@ -0,0 +1,163 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "layout.h"
+#include "alloc_helper.h" // realloc_or_fail
+#include "debug.h"        // DEBUG
+#include "error/error.h"  // ERROR_NUMBER
+#include "loader.h"       // set_placement / code_granularity
+#include "memory.h"       // memory_{map,unmap}
+#include "randomizer.h"   // get_random_qword
+#include <stdlib.h>       // free
+#include <string.h>       // memcpy / memset
+
+// uint64_t's per cache line, the data is moved in those steps
+#define LINE_U64 (64 / sizeof(uint64_t))
+
+// @returns the next number of the generator (splitmix64). /dev/urandom is
+// read once per measurement to seed it, not once per offset.
+static uint64_t next_random(struct layout *layout) {
+  uint64_t z = (layout->state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+// @returns a random multiple of a cache line below the data window, in
+// uint64_t's
+static size_t data_offset(struct layout *layout) {
+  const size_t lines = layout->data_window / 64;
+  return (next_random(layout) & (lines - 1)) * LINE_U64;
+}
+
+int end_layout(struct measuresuite *ms) {
+  struct layout *layout = &ms->layout;
+  const int ret = memory_unmap(ms, layout->data, layout->data_len);
+  free(layout->saved);
+  memset(layout, 0, sizeof(*layout));
+  return ret;
+}
+
+int layout_resize(struct measuresuite *ms, size_t code_window,
+                  size_t data_window, int flags) {
+  if (end_layout(ms)) {
+    return 1;
+  }
+  struct layout *layout = &ms->layout;
+  layout->code_window = code_window;
+  layout->data_window = data_window;
+  layout->require_movable = (flags & MS_LAYOUT_REQUIRE_MOVABLE) != 0;
+  if (data_window == 0) {
+    return 0;
+  }
+
+  // rounded up to cache lines, such that the outputs start at one, too
+  layout->in_size = (ms->random_data_len + LINE_U64 - 1) / LINE_U64 * LINE_U64;
+  layout->out_size = ms->arg_width * ms->num_arg_out;
+  const size_t window = data_window / sizeof(uint64_t);
+  layout->data_len =
+      (2 * window + layout->in_size + layout->out_size) * sizeof(uint64_t);
+  if (memory_map(ms, &layout->data_len, 0, (void **)&layout->data)) {
+    end_layout(ms);
+    return 1;
+  }
+  return 0;
+}
+
+int layout_begin(struct measuresuite *ms) {
+  struct layout *layout = &ms->layout;
+  layout->in = ms->random_data;
+  layout->out = NULL;
+  if (layout->code_window == 0 && layout->data_window == 0) {
+    return 0;
+  }
+  if (get_random_qword(ms, &layout->state)) {
+    return 1;
+  }
+  if (layout->code_window == 0) {
+    return 0;
+  }
+
+  if (realloc_or_fail(ms, (void **)&layout->saved,
+                      2 * (ms->num_functions + 1) * sizeof(size_t))) {
+    return 1;
+  }
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    const struct function_tuple *fct = &ms->functions[f];
+    if (layout->require_movable && code_granularity(fct) == 0) {
+      ms->errorno = E_INVALID_INPUT__PLACEMENT;
+      return 1;
+    }
+    layout->saved[2 * f] = fct->placement_alignment;
+    layout->saved[2 * f + 1] = fct->placement_offset;
+  }
+
+  // the largest offset needs the largest slot
+  const size_t window = layout->code_window;
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    const size_t granularity = code_granularity(&ms->functions[f]);
+    if (granularity != 0 &&
+        set_placement(ms, f, window, (window - 1) & ~(granularity - 1))) {
+      ERROR_NUMBER errorno = ms->errorno;
+      layout_end(ms);
+      ms->errorno = errorno;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int layout_shuffle(struct measuresuite *ms) {
+  struct layout *layout = &ms->layout;
+  const size_t window = layout->code_window;
+  for (size_t f = 0; window != 0 && f < ms->num_functions; f++) {
+    const size_t offset = next_random(layout) & (window - 1);
+    // rounded down, such that aligned sections of ELF code stay aligned
+    const size_t granularity = code_granularity(&ms->functions[f]);
+    if (granularity != 0 &&
+        set_placement(ms, f, window, offset & ~(granularity - 1))) {
+      return 1;
+    }
+  }
+
+  if (layout->data_window != 0) {
+    uint64_t *in = layout->data;
+    uint64_t *out = in + layout->data_window / sizeof(uint64_t) +
+                    layout->in_size;
+    layout->in = in + data_offset(layout);
+    layout->out = out + data_offset(layout);
+    memcpy(layout->in, ms->random_data,
+           ms->random_data_len * sizeof(uint64_t));
+    DEBUG("layout: inputs at %p, outputs at %p\n", (void *)layout->in,
+          (void *)layout->out);
+  }
+  return 0;
+}
+
+int layout_end(struct measuresuite *ms) {
+  struct layout *layout = &ms->layout;
+  if (layout->code_window == 0) {
+    return 0;
+  }
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    if (code_granularity(&ms->functions[f]) != 0 &&
+        set_placement(ms, f, layout->saved[2 * f],
+                      layout->saved[2 * f + 1])) {
+      return 1;
+    }
+  }
+  return 0;
+}
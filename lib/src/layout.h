@@ -0,0 +1,52 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * Layout randomization, see ms_set_layout_randomization. Before each batch,
+ * the code of each movable function is moved to a random offset into the code
+ * window, and the inputs and outputs are copied to / read from random cache
+ * lines of the data window.
+ */
+int layout_resize(struct measuresuite *ms, size_t code_window,
+                  size_t data_window, int flags);
+int end_layout(struct measuresuite *ms);
+
+/**
+ * to be called before the first batch. Remembers the placements and makes
+ * sure each slot has room for every offset, such that moving the code in the
+ * batches does not allocate.
+ * Points ms->layout.in to ms->random_data and ms->layout.out to NULL (the
+ * outputs of each function) if the respective part is disabled.
+ */
+int layout_begin(struct measuresuite *ms);
+
+/**
+ * to be called before each batch, after the inputs have been randomized.
+ * Moves the code, and copies the inputs to ms->layout.in.
+ */
+int layout_shuffle(struct measuresuite *ms);
+
+// to be called after the last batch, also if it failed. Restores the
+// placements.
+int layout_end(struct measuresuite *ms);
+
+#endif
@@ -17,15 +17,22 @@
 #include <assemblyline.h>
 #endif
 #include "alloc_helper.h"
+#include "asm_cache.h"
+#include "asm_incremental.h"
+#include "code_arena.h"
+#include "data_arena.h"
 #include "debug.h"
 #include "error/error.h"
+#include "io/elf_linker.h"
 #include "io/elf_parser.h"
 #include "io/file.h"
 #include "io/shared_object.h"
 #include "loader.h"
 #include "measuresuite.h"
 #include "struct_measuresuite.h"
+#include "timer.h"
 #include <errno.h>
+#include <fnmatch.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -50,11 +57,173 @@ static int reset_permutaions(measuresuite_t ms) {
   return 0;
 }
 
-const size_t DEFAULT_CODE_SIZE = 60000;
-static int create_new_function(measuresuite_t ms, enum load_type type,
-                               size_t code_size_bytes) {
+// @returns the start of the code arena slot of @param fct, NULL if it has none
+static uint8_t *slot_of(const struct function_tuple *fct) {
+  return fct->code == NULL ? NULL : (uint8_t *)fct->code - fct->code_start;
+}
+
+// @returns the multiple the placement of @param fct starts from, at least the
+// alignment its code needs
+static size_t start_alignment(const struct function_tuple *fct) {
+  const size_t alignment =
+      fct->placement_alignment == 0 ? 1 : fct->placement_alignment;
+  return alignment > fct->code_alignment ? alignment : fct->code_alignment;
+}
+
+// @returns the bytes between @param slot and the code of @param fct placed in
+// it
+static size_t placement_start(const struct function_tuple *fct,
+                              const uint8_t *slot) {
+  const uintptr_t alignment = start_alignment(fct);
+  const uintptr_t address = (uintptr_t)slot;
+  return ((address + alignment - 1) & ~(alignment - 1)) - address +
+         fct->placement_offset;
+}
+
+// @returns the slot size which holds @param size bytes of code of @param fct
+// at its placement, wherever the slot is
+static size_t placed_size(const struct function_tuple *fct, size_t size) {
+  const size_t alignment = start_alignment(fct);
+  size_t padding = fct->placement_offset;
+  if (alignment > CODE_ARENA_SLOT_ALIGNMENT) {
+    padding += alignment - CODE_ARENA_SLOT_ALIGNMENT;
+  }
+  return size + padding;
+}
+
+// releases whatever holds the code of @param fct (its code arena slot or, for
+// SHARED_OBJECT, the dlopen'ed library).
+static int release_code(measuresuite_t ms, struct function_tuple *fct) {
+  int ret = 0;
+  switch (fct->type) {
+  case SHARED_OBJECT:
+    ret = fct->lib_handle != NULL && so_unload_file(ms, fct->lib_handle);
+    fct->lib_handle = NULL;
+    break;
+  case ASM:
+  case BIN:
+  case ELF:
+    ret |= code_arena_free(ms, slot_of(fct), fct->code_capacity_bytes);
+    fct->code_capacity_bytes = 0;
+  }
+  fct->code = NULL;
+  fct->code_start = 0;
+  fct->code_size_bytes = 0;
+  return ret;
+}
+
+// points the code of @param fct to @param start bytes into @param slot
+static void place_in_slot(struct function_tuple *fct, uint8_t *slot,
+                          size_t start) {
+  fct->code = slot + start;
+  fct->code_start = start;
+}
+
+// makes sure that @param fct has a code slot which holds @param size bytes of
+// code at its placement.
+static int reserve_code(measuresuite_t ms, struct function_tuple *fct,
+                        size_t size) {
+  uint8_t *slot = slot_of(fct);
+  if (slot != NULL) {
+    const size_t start = placement_start(fct, slot);
+    if (fct->code_capacity_bytes >= start + size) {
+      place_in_slot(fct, slot, start);
+      return 0;
+    }
+  }
+
+  DEBUG("Reserving %lu bytes of code. type: %d\n", size, fct->type);
+  void *new_slot = NULL;
+  fct->code = NULL;
+  if (code_arena_free(ms, slot, fct->code_capacity_bytes) ||
+      code_arena_alloc(ms, placed_size(fct, size), &new_slot,
+                       &fct->code_capacity_bytes)) {
+    return 1;
+  }
+  place_in_slot(fct, new_slot, placement_start(fct, new_slot));
+  return 0;
+}
+
+// moves the code of @param fct to where its placement puts it
+static int move_code(measuresuite_t ms, struct function_tuple *fct) {
+  uint8_t *slot = slot_of(fct);
+  if (slot == NULL) {
+    return 0;
+  }
+  const uint8_t *code = fct->code;
+  const size_t size = fct->code_size_bytes;
+  const size_t start = placement_start(fct, slot);
+  if (fct->code_capacity_bytes >= start + size) {
+    memmove(slot + start, code, size);
+    place_in_slot(fct, slot, start);
+    return 0;
+  }
+
+  uint8_t *new_slot = NULL;
+  size_t capacity = 0;
+  if (code_arena_alloc(ms, placed_size(fct, size), (void **)&new_slot,
+                       &capacity)) {
+    return 1;
+  }
+  const size_t new_start = placement_start(fct, new_slot);
+  memcpy(new_slot + new_start, code, size);
+  const int ret = code_arena_free(ms, slot, fct->code_capacity_bytes);
+  fct->code_capacity_bytes = capacity;
+  place_in_slot(fct, new_slot, new_start);
+  return ret;
+}
+
+size_t code_granularity(const struct function_tuple *fct) {
+  if (fct->type == SHARED_OBJECT || fct->position_dependent) {
+    return 0;
+  }
+  return fct->code_alignment == 0 ? 1 : fct->code_alignment;
+}
+
+int code_movable(const struct function_tuple *fct) {
+  return code_granularity(fct) == 1;
+}
+
+int set_placement(measuresuite_t ms, size_t id, size_t alignment,
+                  size_t offset) {
+  struct function_tuple *fct = &ms->functions[id];
+  const int valid_alignment =
+      alignment <= MS_MAX_PLACEMENT_ALIGNMENT &&
+      (alignment & (alignment - 1)) == 0 &&
+      (offset < alignment || (alignment == 0 && offset == 0));
+  // the sections of ELF code keep their alignment only at multiples of it
+  const int keeps_alignment =
+      fct->code_alignment <= 1 || offset % fct->code_alignment == 0;
+  if (!valid_alignment || !keeps_alignment || fct->type == SHARED_OBJECT) {
+    ms->errorno = E_INVALID_INPUT__PLACEMENT;
+    return 1;
+  }
+
+  const size_t old_alignment = fct->placement_alignment;
+  const size_t old_offset = fct->placement_offset;
+  fct->placement_alignment = alignment;
+  fct->placement_offset = offset;
+  const uint8_t *slot = slot_of(fct);
+  if (fct->position_dependent && slot != NULL &&
+      placement_start(fct, slot) != fct->code_start) {
+    fct->placement_alignment = old_alignment;
+    fct->placement_offset = old_offset;
+    ms->errorno = E_INVALID_INPUT__PLACEMENT;
+    return 1;
+  }
+  return move_code(ms, fct);
+}
+
+static int create_new_function(measuresuite_t ms, enum load_type type) {
 
   DEBUG("Creating new function. type: %d\n", type);
+#ifndef USE_ASSEMBLYLINE
+  if (type == ASM) {
+    ms->errorno = E_NO_ASSEMBLYLINE;
+    return 1;
+  }
+#endif
+
   // check size and allocate more if needed
   if (ms->size_functions <= ms->num_functions) {
     ms->size_functions *= 2;
@@ -65,95 +234,376 @@ static int create_new_function(measuresuite_t ms, enum load_type type,
     }
   }
 
+  // room for its outputs, may move those of the others
+  if (data_arena_reserve(ms, ms->num_functions + 1)) {
+    return 1;
+  }
+
   // convenience pointer to the new tuple
   struct function_tuple *new = &ms->functions[ms->num_functions];
+  memset(new, 0, sizeof(struct function_tuple));
 
   new->type = type;
 
-  // initialize the memory for arith_result
-  init_arithmetic_results(ms, new);
+  // Because we don't have any batch_size yet, cycle_results stays NULL.
+  new->arithmetic_results = data_arena_outputs(ms, ms->num_functions);
 
-  // if we need the 'code' segment, initialize that memory
-  if (type == ELF || type == BIN || type == ASM) {
+  // specify that we have a new one now
+  ms->num_functions += 1;
+  return reset_permutaions(ms);
+}
+
+// will set *id to a new function if it is -1, and make sure that the function
+// at *id can hold @param code_size bytes of code of @param type, starting at a
+// multiple of @param code_alignment
+static int prepare_function(measuresuite_t ms, enum load_type type,
+                            size_t code_size, size_t code_alignment, int *id) {
+  int is_new = *id == -1;
+  if (is_new) {
+    if (create_new_function(ms, type)) {
+      return 1;
+    }
+    *id = (int)ms->num_functions - 1;
+  } else if (*id < 0 || (size_t)*id >= ms->num_functions) {
+    ms->errorno = E_INVALID_INPUT__NUM_IDX_OOB;
+    return 1;
+  }
 
-    new->code_size_bytes =
-        code_size_bytes == 0 ? DEFAULT_CODE_SIZE : code_size_bytes;
-    if (map_rwx(ms, (void **)&new->code, new->code_size_bytes)) {
+  struct function_tuple *fct = &ms->functions[*id];
+  if (code_alignment > 1 && fct->placement_offset % code_alignment != 0) {
+    // the placement of *id would misalign the sections of the code
+    ms->errorno = E_INVALID_INPUT__PLACEMENT;
+    return 1;
+  }
+  // whatever is loaded now does not come from an archive
+  free(fct->member);
+  fct->member = NULL;
+  fct->position_dependent = 0;
+  fct->code_alignment = code_alignment;
+  if (fct->type != type) {
+    if (release_code(ms, fct)) {
       return 1;
     }
+    fct->type = type;
+  }
+
+  if (type == SHARED_OBJECT || !reserve_code(ms, fct, code_size)) {
+    return 0;
   }
 
-  // Because we don't have any batch_size yet.
-  new->cycle_results = NULL;
+  // don't leave a half initialized function behind
+  if (is_new) {
+    ERROR_NUMBER errorno = ms->errorno;
+    unload(ms, ms->num_functions - 1);
+    ms->errorno = errorno;
+    *id = -1;
+  }
+  return 1;
+}
 
 #ifdef USE_ASSEMBLYLINE
-  new->chunks = 0;
+static int copy_code(measuresuite_t ms, struct function_tuple *fct,
+                     const uint8_t *code, size_t code_len, int chunks) {
+  if (reserve_code(ms, fct, code_len)) {
+    return 1;
+  }
+  memcpy(fct->code, code, code_len);
+  fct->code_size_bytes = code_len;
+  fct->chunks = chunks;
+  return 0;
+}
 
-  if (type == ASM) {
-    // create asm instance
-    new->al = asm_create_instance(new->code, (int)new->code_size_bytes);
-  } else {
-    new->al = NULL;
+// most bytes AL encodes one line into: an instruction of up to 15 bytes, and
+// fewer nops before it, which keep it from breaking a chunk boundary
+#define MAX_LINE_CODE_BYTES 30
+
+// assembles @param len chars of @param text with AL into the slot of @param
+// fct. AL writes into a scratch buffer which holds any code of that many
+// lines, such that the slot can be sized exactly. Sets @param errorno on
+// failure.
+static int assemble_text(measuresuite_t ms, struct function_tuple *fct,
+                         const char *text, size_t len, ERROR_NUMBER errorno) {
+  size_t lines = 1;
+  for (size_t i = 0; i < len; i++) {
+    lines += text[i] == '\n';
   }
-#else
-  if (type == ASM) {
-    ms->errorno = E_NO_ASSEMBLYLINE;
+  if (lines > INT32_MAX / MAX_LINE_CODE_BYTES) {
+    ms->errorno = errorno;
+    return 1;
+  }
+  const int scratch_len = (int)lines * MAX_LINE_CODE_BYTES;
+  uint8_t *scratch = NULL;
+  if (realloc_or_fail(ms, (void **)&scratch, scratch_len)) {
     return 1;
   }
 
-#endif
+  assemblyline_t al = asm_create_instance(scratch, scratch_len);
+  int chunks = 0;
+  int ret = al == NULL ||
+            asm_assemble_string_counting_chunks(al, (char *)text,
+                                                (int)ms->chunk_size, &chunks);
+  if (ret) {
+    ms->errorno = errorno;
+  } else {
+    ret = copy_code(ms, fct, scratch, asm_get_offset(al), chunks);
+  }
+  if (al != NULL && asm_destroy_instance(al) && !ret) {
+    ms->errorno = E_LOAD__AL_FREE;
+    ret = 1;
+  }
+  free(scratch);
+  return ret;
+}
 
-  // specify that we have a new one now
-  ms->num_functions += 1;
-  reset_permutaions(ms);
-  return 0;
+// assembles @param len chars of @param text into the slot of @param fct.
+// Tries the asm cache first, then incremental assembly, then AL. Only what AL
+// assembled goes into the asm cache: incremental assembly emits every branch
+// as rel32, AL the shortest one.
+static int assemble_string(measuresuite_t ms, struct function_tuple *fct,
+                           const char *text, size_t len) {
+  const struct asm_cache_entry *cached =
+      asm_cache_lookup(&ms->asm_cache, text, len, ms->chunk_size);
+  if (cached != NULL) {
+    return copy_code(ms, fct, cached->code, cached->code_len, cached->chunks);
+  }
+
+  // counting chunks needs AL to see the whole string
+  if (ms->incremental.lines.capacity > 0 && ms->chunk_size == 0) {
+    const uint8_t *code = NULL;
+    size_t code_len = 0;
+    if (asm_incremental_assemble(ms, text, len, &code, &code_len)) {
+      return 1;
+    }
+    if (code != NULL) {
+      return copy_code(ms, fct, code, code_len, 0);
+    }
+    DEBUG("incremental assembly not possible, assembling with AL\n");
+  }
+
+  return assemble_text(ms, fct, text, len, E_LOAD__ASM_DATA) ||
+         asm_cache_insert(ms, &ms->asm_cache, text, len, ms->chunk_size,
+                          fct->code, fct->code_size_bytes, fct->chunks);
 }
+#endif
 
 int unload(measuresuite_t ms, size_t id) {
 
   struct function_tuple *fct = &ms->functions[id];
 
-  free(fct->arithmetic_results);
+  // points into the data arena
   fct->arithmetic_results = NULL;
 
-  free(fct->cycle_results);
+  // points into ms->cycle_results
   fct->cycle_results = NULL;
 
-  int ret = 0;
-  switch (fct->type) {
-  case SHARED_OBJECT:
-    ret = so_unload_file(ms, fct);
-    break;
-  case ASM:
-#if USE_ASSEMBLYLINE
-    if (fct->al == NULL || asm_destroy_instance(fct->al)) {
-      ms->errorno = E_LOAD__AL_FREE;
-      ret = 1;
-    }
-    fct->al = NULL;
-    __attribute__((fallthrough));
-#endif
-  case BIN:
-  case ELF:
-    unmap(ms, fct->code, fct->code_size_bytes);
-    fct->code_size_bytes = 0;
-  }
+  free(fct->member);
+  fct->member = NULL;
+
+  int ret = release_code(ms, fct);
 
   ms->num_functions--;
   reset_permutaions(ms);
   return ret;
 }
 
-static int load_file_so(measuresuite_t ms, enum load_type type,
-                        const char *filename, const char *symbol, int *id) {
-  if (*id == -1) {
-    if (create_new_function(ms, type, 0)) {
+// loads @param symbol of the library @param handle, whose reference it takes
+// over, into function *@param id
+static int load_so_symbol(measuresuite_t ms, void *handle, const char *symbol,
+                          int *id) {
+  void *code = NULL;
+  if (so_load_symbol(ms, handle, symbol, &code) ||
+      prepare_function(ms, SHARED_OBJECT, 0, 1, id)) {
+    so_release_file(ms, handle);
+    return 1;
+  }
+
+  // the old library is let go only now, so it is not closed and opened again
+  // when replacing a function with one from the same library
+  struct function_tuple *fct = &ms->functions[*id];
+  void *old = fct->lib_handle;
+  fct->lib_handle = handle;
+  fct->code = code;
+  return old != NULL && so_unload_file(ms, old);
+}
+
+static int load_file_so(measuresuite_t ms, const char *filename,
+                        const char *symbol, int *id) {
+  void *handle = NULL;
+  return so_load_file(ms, filename, &handle) ||
+         load_so_symbol(ms, handle, symbol, id);
+}
+
+// @returns 1 if entry @param i of the dynamic symbols of @param elf is a
+// function other objects can link against
+static int is_exported_function(const struct ms_elf *elf, size_t i) {
+  Elf64_Sym sym;
+  elf_get_symbol(elf, i, &sym);
+  return elf_is_function(elf, i) && ELF64_ST_BIND(sym.st_info) != STB_LOCAL &&
+         ELF64_ST_VISIBILITY(sym.st_other) != STV_HIDDEN &&
+         ELF64_ST_VISIBILITY(sym.st_other) != STV_INTERNAL;
+}
+
+// loads the functions @param so exports which match @param pattern
+static int load_so_functions(measuresuite_t ms, const struct ms_elf *so,
+                             const char *filename, const char *pattern,
+                             size_t *num_loaded) {
+  for (size_t i = 0; i < elf_num_symbols(so); i++) {
+    const char *name = elf_symbol_name(so, i);
+    if (!is_exported_function(so, i) || fnmatch(pattern, name, 0) != 0) {
+      continue;
+    }
+    int id = -1;
+    if (load_file_so(ms, filename, name, &id)) {
       return 1;
     }
-    *id = (int)ms->num_functions - 1;
+    (*num_loaded)++;
+  }
+  if (*num_loaded == 0) {
+    ms->errorno = E_LOAD__ELF_SYMBOL_NOT_FOUND;
+    return 1;
+  }
+  return 0;
+}
+
+int load_so_matching(measuresuite_t ms, const char *filename,
+                     const char *pattern, size_t *num_loaded) {
+  *num_loaded = 0;
+  // holding a reference keeps the library open between the symbols
+  void *handle = NULL;
+  if (so_load_file(ms, filename, &handle)) {
+    return 1;
+  }
+
+  struct ms_elf so;
+  int ret = elf_open(ms, filename, &so) || elf_use_dynamic_symbols(ms, &so) ||
+            load_so_functions(ms, &so, filename, pattern, num_loaded);
+  ERROR_NUMBER errorno = ms->errorno;
+  if (elf_close(ms, &so)) {
+    ret = 1;
+  } else {
+    ms->errorno = errorno;
   }
-  struct function_tuple *new = &ms->functions[*id];
-  if (so_load_file(ms, new, filename) || so_load_symbol(ms, new, symbol)) {
+  if (ret) {
+    so_release_file(ms, handle);
+    return 1;
+  }
+  return so_unload_file(ms, handle);
+}
+
+// links @param code of @param elf into function *@param id
+static int load_elf_region(measuresuite_t ms, const struct ms_elf *elf,
+                           const struct elf_region *code, int *id) {
+  struct elf_image image;
+  if (elf_image_layout(ms, elf, code, &image)) {
+    return 1;
+  }
+  const int is_new = *id == -1;
+  int ret = prepare_function(ms, ELF, image.size, image.alignment, id);
+  if (!ret) {
+    struct function_tuple *fct = &ms->functions[*id];
+    ret = elf_image_link(ms, elf, &image, fct->code);
+    fct->code_size_bytes = ret ? 0 : image.size;
+    fct->position_dependent = image.position_dependent;
+    if (ret && is_new) {
+      ERROR_NUMBER errorno = ms->errorno;
+      unload(ms, *id);
+      ms->errorno = errorno;
+      *id = -1;
+    }
+  }
+  elf_image_free(&image);
+  return ret;
+}
+
+int load_elf_symbol(measuresuite_t ms, const struct ms_elf *elf,
+                    const char *symbol, int *id) {
+  struct elf_region code;
+  return elf_find_region(ms, elf, symbol, &code) ||
+         load_elf_region(ms, elf, &code, id);
+}
+
+int load_elf_all(measuresuite_t ms, const struct ms_elf *elf,
+                 size_t *num_loaded) {
+  *num_loaded = 0;
+  for (size_t i = 0; i < elf_num_symbols(elf); i++) {
+    if (!elf_is_function(elf, i)) {
+      continue;
+    }
+    struct elf_region code;
+    int id = -1;
+    if (elf_symbol_region(ms, elf, i, &code) ||
+        load_elf_region(ms, elf, &code, &id)) {
+      return 1;
+    }
+    (*num_loaded)++;
+  }
+  return 0;
+}
+
+// sets the member name of the functions @param first .. @param first +
+// @param num - 1 to the @param name_len chars at @param name
+static int set_member(measuresuite_t ms, size_t first, size_t num,
+                      const char *name, size_t name_len) {
+  for (size_t i = first; i < first + num; i++) {
+    char *member = malloc(name_len + 1);
+    if (member == NULL) {
+      ms->errorno = E_LOAD__ELF_FILE_MALLOC;
+      ms->additional_info = strerror(errno);
+      return 1;
+    }
+    memcpy(member, name, name_len);
+    member[name_len] = '\0';
+    ms->functions[i].member = member;
+  }
+  return 0;
+}
+
+// loads @param symbol (or all functions, if NULL) of @param member
+static int load_member(measuresuite_t ms, const struct ar_member *member,
+                       const char *symbol, size_t *num_loaded) {
+  struct ms_elf elf;
+  if (elf_parse(ms, member->data, member->size, &elf)) {
+    return 1;
+  }
+
+  const size_t first = ms->num_functions;
+  size_t loaded = 0;
+  int ret = 0;
+  if (symbol == NULL) {
+    ret = load_elf_all(ms, &elf, &loaded);
+  } else {
+    int id = -1;
+    ret = load_elf_symbol(ms, &elf, symbol, &id);
+    loaded = ret == 0;
+    // members which do not define it are skipped
+    if (ret && ms->errorno == E_LOAD__ELF_SYMBOL_NOT_FOUND) {
+      ret = 0;
+    }
+  }
+  // nothing to unmap, the archive is
+  elf_close(ms, &elf);
+
+  *num_loaded += loaded;
+  return set_member(ms, first, loaded, member->name, member->name_len) || ret;
+}
+
+int load_archive(measuresuite_t ms, struct ms_archive *ar, const char *symbol,
+                 size_t *num_loaded) {
+  *num_loaded = 0;
+  for (;;) {
+    struct ar_member member;
+    if (ar_next_member(ms, ar, &member)) {
+      return 1;
+    }
+    if (member.data == NULL) {
+      break;
+    }
+    if (load_member(ms, &member, symbol, num_loaded)) {
+      return 1;
+    }
+  }
+  if (symbol != NULL && *num_loaded == 0) {
+    ms->errorno = E_LOAD__ELF_SYMBOL_NOT_FOUND;
     return 1;
   }
   return 0;
@@ -163,7 +613,21 @@ int load_file(measuresuite_t ms, enum load_type type, const char *filename,
               const char *symbol, int *id) {
 
   if (type == SHARED_OBJECT) {
-    return load_file_so(ms, type, filename, symbol, id);
+    return load_file_so(ms, filename, symbol, id);
+  }
+
+  if (type == ELF) {
+    struct ms_elf elf;
+    if (elf_open(ms, filename, &elf)) {
+      return 1;
+    }
+    int ret = load_elf_symbol(ms, &elf, symbol, id);
+    ERROR_NUMBER errorno = ms->errorno;
+    if (elf_close(ms, &elf)) {
+      return 1;
+    }
+    ms->errorno = errorno;
+    return ret;
   }
 
   size_t size = 0;
@@ -171,37 +635,26 @@ int load_file(measuresuite_t ms, enum load_type type, const char *filename,
     return 1;
   }
 
-  if (*id == -1) {
-    /*
-   size should suffice for
-   - ASM, as a string instructions are typically longer than the encoded
-   version
-   - BIN (its equal anyway)
-   - ELF, as we'd need less because we skip the header stuff
-   */
-    if (create_new_function(ms, type, size)) {
-      return 1;
-    }
-    *id = (int)ms->num_functions - 1;
+  // the slot of ASM is sized once it is assembled, BIN is copied as is
+  if (prepare_function(ms, type, type == ASM ? 0 : size, 1, id)) {
+    return 1;
   }
   struct function_tuple *fct = &ms->functions[*id];
-  /** make sure we got enough space in case we are re-using */
-  if (fct->code_size_bytes < size) {
-    if (realloc_rwx_or_fail(ms, fct->code, fct->code_size_bytes, size)) {
-      return 1;
-    }
-    fct->code_size_bytes = size;
-  }
 
   switch (type) {
   case ASM: {
 #ifdef USE_ASSEMBLYLINE
-    if (asm_assemble_file_counting_chunks(fct->al, (char *)filename,
-                                          (int)ms->chunk_size, &fct->chunks)) {
-      ms->errorno = E_LOAD__ASM_FILE;
-      return 1;
+    const uint64_t start = current_timestamp_ns();
+    char *text = NULL;
+    int ret = realloc_or_fail(ms, (void **)&text, size + 1) ||
+              filecopy(ms, text, size, filename);
+    if (!ret) {
+      text[size] = '\0';
+      ret = assemble_text(ms, fct, text, size, E_LOAD__ASM_FILE);
     }
-    return 0;
+    free(text);
+    fct->assembly_ns = current_timestamp_ns() - start;
+    return ret;
 #else
     ms->errorno = E_NO_ASSEMBLYLINE;
     return 1;
@@ -209,11 +662,9 @@ int load_file(measuresuite_t ms, enum load_type type, const char *filename,
   }
 
   case BIN:
+    fct->code_size_bytes = size;
     return filecopy(ms, fct->code, size, filename);
 
-  case ELF:
-    return elf_load_symbol(ms, fct->code, size, filename, symbol);
-
   default:
     return 1;
   }
@@ -224,35 +675,48 @@ int load_file(measuresuite_t ms, enum load_type type, const char *filename,
 int load_data(measuresuite_t ms, enum load_type type, const uint8_t *data,
               size_t data_len, const char *symbol, int *id) {
   if (type == SHARED_OBJECT) {
-    ms->errorno = E_INVALID_INPUT__SO_FROM_MEMORY;
-    return 1;
-  }
-
-  if (*id == -1) {
-    if (create_new_function(ms, type, data_len)) {
+    // dlopen needs the size, dlsym a symbol
+    if (data_len == 0 || symbol == NULL) {
+      ms->errorno = E_INVALID_INPUT__SO_FROM_MEMORY;
       return 1;
     }
-    *id = (int)ms->num_functions - 1;
+    void *handle = NULL;
+    return so_load_data(ms, data, data_len, &handle) ||
+           load_so_symbol(ms, handle, symbol, id);
   }
 
-  struct function_tuple *fct = &ms->functions[*id];
-  /** make sure we got enough space in case we are re-using */
-  if (fct->code_size_bytes < data_len) {
-    if (realloc_rwx_or_fail(ms, fct->code, fct->code_size_bytes, data_len)) {
+  if (type == ELF) {
+    // data_len is optional, then the file is not bounds-checked
+    struct ms_elf elf;
+    if (elf_parse(ms, data, data_len, &elf)) {
       return 1;
     }
-    fct->code_size_bytes = data_len;
+    int ret = load_elf_symbol(ms, &elf, symbol, id);
+    ERROR_NUMBER errorno = ms->errorno;
+    elf_close(ms, &elf);
+    ms->errorno = errorno;
+    return ret;
   }
 
+  // data_len is optional for ASM, its slot is sized once it is assembled
+  size_t size = data_len;
+  if (type == ASM) {
+    size = strlen((const char *)data);
+  }
+
+  if (prepare_function(ms, type, type == ASM ? 0 : size, 1, id)) {
+    return 1;
+  }
+
+  struct function_tuple *fct = &ms->functions[*id];
+
   switch (type) {
   case ASM: {
 #ifdef USE_ASSEMBLYLINE
-    if (asm_assemble_string_counting_chunks(
-            fct->al, (char *)data, (int)ms->chunk_size, &fct->chunks)) {
-      ms->errorno = E_LOAD__ASM_DATA;
-      return 1;
-    }
-    return 0;
+    const uint64_t start = current_timestamp_ns();
+    int ret = assemble_string(ms, fct, (const char *)data, size);
+    fct->assembly_ns = current_timestamp_ns() - start;
+    return ret;
 #else
     ms->errorno = E_NO_ASSEMBLYLINE;
     return 1;
@@ -261,13 +725,10 @@ int load_data(measuresuite_t ms, enum load_type type, const uint8_t *data,
 
   case BIN: {
     memcpy(fct->code, data, data_len);
+    fct->code_size_bytes = data_len;
     return 0;
   }
 
-  case ELF:
-    return elf_load_symbol_mem(ms, fct->code, fct->code_size_bytes, data,
-                               symbol);
-
   default:
     return 1;
   }
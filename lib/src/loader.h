@@ -15,6 +15,8 @@
  */
 #ifndef LOADER_H
 #define LOADER_H
+#include "io/archive.h"
+#include "io/elf_parser.h"
 #include "measuresuite.h"
 #include <stdlib.h>
 
@@ -23,5 +25,36 @@ int load_file(measuresuite_t ms, enum load_type type, const char *filename,
 
 int load_data(measuresuite_t ms, enum load_type type, const uint8_t *data,
               size_t data_len, const char *symbol, int *id);
+
+// loads the code of @param symbol in @param elf into function @param *id,
+// see ms_load_file for @param id
+int load_elf_symbol(measuresuite_t ms, const struct ms_elf *elf,
+                    const char *symbol, int *id);
+// loads all functions of @param elf into new functions, counting them in
+// @param num_loaded
+int load_elf_all(measuresuite_t ms, const struct ms_elf *elf,
+                 size_t *num_loaded);
+// loads @param symbol (or all functions, if NULL) of each member of @param ar
+// into new functions, counting them in @param num_loaded
+int load_archive(measuresuite_t ms, struct ms_archive *ar, const char *symbol,
+                 size_t *num_loaded);
+
+// loads every function the shared object @param filename exports whose name
+// matches the fnmatch(3) @param pattern into new functions, counting them in
+// @param num_loaded
+int load_so_matching(measuresuite_t ms, const char *filename,
+                     const char *pattern, size_t *num_loaded);
+
+// @returns the bytes the code of @param fct can be moved in multiples of, 0 if
+// it cannot be moved at all
+size_t code_granularity(const struct function_tuple *fct);
+
+// @returns 1 if the code of @param fct can be placed at any byte offset
+int code_movable(const struct function_tuple *fct);
+
+// see ms_set_placement, @param id must be loaded
+int set_placement(measuresuite_t ms, size_t id, size_t alignment,
+                  size_t offset);
+
 int unload(measuresuite_t ms, size_t id);
 #endif
@@ -15,13 +15,25 @@
  */
 
 #include "alloc_helper.h"
+#include "asm_cache.h"
+#include "asm_incremental.h"
+#include "code_arena.h"
+#include "data_arena.h"
 #include "error/description.h"
 #include "evaluator.h"
+#include "io/shared_object.h"
+#include "json.h"
+#include "layout.h"
 #include "loader.h"
+#include "memory.h"
 #include "randomizer.h"
+#include "result_cache.h"
 #include "struct_helpers.h"
 #include "struct_measuresuite.h"
+#include "sweep.h"
 #include "timer.h"
+#include "working_set.h"
+#include <errno.h>
 #include <measuresuite.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +52,7 @@ int ms_initialize(measuresuite_t *dest_ms, int arg_width, int num_arg_in,
       || set_argout(ms, num_arg_out) // set arg out
       || validate_num_args(ms)       // validate arg counts
       || init_random(ms)             // initialize randomness structures
+      || init_code_arena(ms)         // map memory for the code
       || init_json(ms)               // initialize measure structs
       || init_timer(ms)              // initialize timer structures
   ) {
@@ -59,10 +72,64 @@ int ms_set_chunk_size(measuresuite_t ms, size_t chunk_size) {
   return set_chunk_size(ms, chunk_size);
 }
 
+int ms_set_asm_cache_size(measuresuite_t ms, size_t num_entries) {
+  return asm_cache_resize(ms, &ms->asm_cache, num_entries);
+}
+
+void ms_get_asm_cache_stats(measuresuite_t ms, uint64_t *hits,
+                            uint64_t *misses) {
+  *hits = ms->asm_cache.hits;
+  *misses = ms->asm_cache.misses;
+}
+
+int ms_set_incremental_assembly(measuresuite_t ms, size_t num_lines) {
+  return asm_incremental_resize(ms, num_lines);
+}
+
+void ms_get_incremental_assembly_stats(measuresuite_t ms, uint64_t *hits,
+                                       uint64_t *misses) {
+  *hits = ms->incremental.lines.hits;
+  *misses = ms->incremental.lines.misses;
+}
+
+int ms_get_assembly_time(measuresuite_t ms, int id, uint64_t *ns) {
+  if (id < 0 || (size_t)id >= ms->num_functions) {
+    ms->errorno = E_INVALID_INPUT__NUM_IDX_OOB;
+    return 1;
+  }
+  *ns = ms->functions[id].assembly_ns;
+  return 0;
+}
+
+int ms_set_result_cache(measuresuite_t ms, size_t num_entries,
+                        size_t top_up_batches) {
+  return result_cache_resize(ms, num_entries, top_up_batches);
+}
+
+void ms_get_result_cache_stats(measuresuite_t ms, uint64_t *hits,
+                               uint64_t *misses) {
+  *hits = ms->result_cache.hits;
+  *misses = ms->result_cache.misses;
+}
+
+int ms_result_cache_save(measuresuite_t ms, const char *filename) {
+  return result_cache_save(ms, filename);
+}
+
+int ms_result_cache_load(measuresuite_t ms, const char *filename) {
+  return result_cache_load(ms, filename);
+}
+
 void ms_set_checking(measuresuite_t ms, int control) {
   ms->enable_check = control == 0 ? 0 : 1;
 }
 
+void ms_set_batch_callback(measuresuite_t ms, ms_batch_callback callback,
+                           void *ctx) {
+  ms->batch_callback = callback;
+  ms->batch_callback_ctx = ctx;
+}
+
 int ms_load_file(measuresuite_t ms, enum load_type type, const char *filename,
                  const char *symbol, int *id) {
   return load_file(ms, type, filename, symbol, id);
@@ -73,6 +140,140 @@ int ms_load_data(measuresuite_t ms, enum load_type type, const uint8_t *data,
   return load_data(ms, type, data, data_len, symbol, id);
 }
 
+int ms_replace_code(measuresuite_t ms, int id, enum load_type type,
+                    const uint8_t *data, size_t data_len) {
+  // only existing functions can be replaced, -1 would load a new one
+  if (id < 0 || (size_t)id >= ms->num_functions) {
+    ms->errorno = E_INVALID_INPUT__NUM_IDX_OOB;
+    return 1;
+  }
+  if (load_data(ms, type, data, data_len, NULL, &id)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_replace_code_many(measuresuite_t ms, size_t num, const int *ids,
+                         enum load_type type, const uint8_t *const *data,
+                         const size_t *data_lens) {
+  for (size_t i = 0; i < num; i++) {
+    size_t data_len = data_lens == NULL ? 0 : data_lens[i];
+    if (ms_replace_code(ms, ids[i], type, data[i], data_len)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int ms_elf_open(measuresuite_t ms, const char *filename, ms_elf_t *elf) {
+  *elf = malloc(sizeof(**elf));
+  if (*elf == NULL) {
+    ms->errorno = E_LOAD__ELF_FILE_MALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  if (elf_open(ms, filename, *elf) || elf_build_index(ms, *elf)) {
+    elf_close(ms, *elf);
+    free(*elf);
+    *elf = NULL;
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_elf_close(measuresuite_t ms, ms_elf_t elf) {
+  if (elf == NULL) {
+    return 0;
+  }
+  int ret = elf_close(ms, elf);
+  free(elf);
+  if (ret) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_load_elf_symbols(measuresuite_t ms, ms_elf_t elf, size_t num,
+                        const char *const *symbols, int *ids) {
+  for (size_t i = 0; i < num; i++) {
+    if (load_elf_symbol(ms, elf, symbols[i], &ids[i])) {
+      return 1;
+    }
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_load_elf_all(measuresuite_t ms, ms_elf_t elf, int *first_id,
+                    size_t *num_loaded) {
+  *first_id = (int)ms->num_functions;
+  if (load_elf_all(ms, elf, num_loaded)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_load_so_symbols(measuresuite_t ms, const char *filename, size_t num,
+                       const char *const *symbols, int *ids) {
+  for (size_t i = 0; i < num; i++) {
+    if (load_file(ms, SHARED_OBJECT, filename, symbols[i], &ids[i])) {
+      return 1;
+    }
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_load_so_matching(measuresuite_t ms, const char *filename,
+                        const char *pattern, int *first_id,
+                        size_t *num_loaded) {
+  *first_id = (int)ms->num_functions;
+  if (load_so_matching(ms, filename, pattern, num_loaded)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+// loads from @param ar and closes it
+static int load_archive_and_close(measuresuite_t ms, struct ms_archive *ar,
+                                  const char *symbol, size_t *num_loaded) {
+  int ret = load_archive(ms, ar, symbol, num_loaded);
+  ERROR_NUMBER errorno = ms->errorno;
+  if (ar_close(ms, ar)) {
+    return 1;
+  }
+  if (ret) {
+    ms->errorno = errorno;
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_load_archive(measuresuite_t ms, const char *filename,
+                    const char *symbol, int *first_id, size_t *num_loaded) {
+  struct ms_archive ar;
+  *first_id = (int)ms->num_functions;
+  *num_loaded = 0;
+  return ar_open(ms, filename, &ar) ||
+         load_archive_and_close(ms, &ar, symbol, num_loaded);
+}
+
+int ms_load_archive_data(measuresuite_t ms, const uint8_t *data,
+                         size_t data_len, const char *symbol, int *first_id,
+                         size_t *num_loaded) {
+  struct ms_archive ar;
+  *first_id = (int)ms->num_functions;
+  *num_loaded = 0;
+  return ar_parse(ms, data, data_len, &ar) ||
+         load_archive_and_close(ms, &ar, symbol, num_loaded);
+}
+
 int ms_unload_all(measuresuite_t ms) {
   for (size_t i = ms->num_functions; i > 0; i--) {
     if (ms_unload_last(ms)) {
@@ -97,6 +298,181 @@ int ms_unload_last(measuresuite_t ms) {
   return 0;
 }
 
+int ms_set_placement(measuresuite_t ms, int id, size_t alignment,
+                     size_t offset) {
+  if (id < 0 || (size_t)id >= ms->num_functions) {
+    ms->errorno = E_INVALID_INPUT__NUM_IDX_OOB;
+    return 1;
+  }
+  if (set_placement(ms, id, alignment, offset)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_set_layout_randomization(measuresuite_t ms, size_t code_window,
+                                size_t data_window, int flags) {
+  const int valid_code = code_window <= MS_MAX_PLACEMENT_ALIGNMENT &&
+                         (code_window & (code_window - 1)) == 0;
+  const int valid_data =
+      data_window == 0 ||
+      (data_window >= 64 && data_window <= MS_MAX_PLACEMENT_ALIGNMENT &&
+       (data_window & (data_window - 1)) == 0);
+  if (!valid_code || !valid_data) {
+    ms->errorno = E_INVALID_INPUT__LAYOUT;
+    return 1;
+  }
+  if (layout_resize(ms, code_window, data_window, flags)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_set_data_offsets(measuresuite_t ms, size_t in_offset,
+                        size_t out_offset) {
+  const int compact = in_offset == MS_DATA_OFFSET_COMPACT &&
+                      out_offset == MS_DATA_OFFSET_COMPACT;
+  const int valid = in_offset < MS_DATA_PAGE_SIZE && in_offset % 8 == 0 &&
+                    out_offset < MS_DATA_PAGE_SIZE && out_offset % 8 == 0;
+  if (!compact && !valid) {
+    ms->errorno = E_INVALID_INPUT__DATA_OFFSET;
+    return 1;
+  }
+  if (data_arena_set_offsets(ms, !compact, in_offset, out_offset)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_set_aliasing(measuresuite_t ms, const int *aliases) {
+  if (aliases == NULL) {
+    ms->num_aliased = 0;
+    ms->errorno = E_SUCCESS;
+    return 0;
+  }
+  int aliased_in = 0; // bit i set if in argument i is aliased
+  size_t num_aliased = 0;
+  for (size_t j = 0; j < ms->num_arg_out; j++) {
+    const int in = aliases[j];
+    if (in == MS_ALIAS_NONE) {
+      continue;
+    }
+    if (in < 0 || (size_t)in >= ms->num_arg_in || (aliased_in & (1 << in))) {
+      ms->errorno = E_INVALID_INPUT__ALIASING;
+      return 1;
+    }
+    aliased_in |= 1 << in;
+    num_aliased++;
+  }
+  memcpy(ms->aliases, aliases, ms->num_arg_out * sizeof(int));
+  ms->num_aliased = num_aliased;
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_set_working_set(measuresuite_t ms, size_t bytes) {
+  if (working_set_resize(ms, bytes)) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_set_memory_options(measuresuite_t ms, int flags) {
+  ms->memory_flags = flags;
+  if (code_arena_remap(ms)     // map the code anew, or lock it in place
+      || data_arena_remap(ms)  // move the inputs and outputs
+      || layout_resize(ms, ms->layout.code_window, ms->layout.data_window,
+                       ms->layout.require_movable
+                           ? MS_LAYOUT_REQUIRE_MOVABLE
+                           : 0) // and their randomized copies
+      || working_set_resize(ms, ms->working_set.bytes) // and the pool
+  ) {
+    return 1;
+  }
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_get_memory_status(measuresuite_t ms, struct ms_memory_status *dest) {
+  int code_locked = 0;
+  int data_locked = 0;
+  if (code_arena_status(ms, &dest->code_pages, &code_locked) ||
+      memory_status(ms, ms->data_arena.base, ms->data_arena.len,
+                    &dest->data_pages, &data_locked)) {
+    return 1;
+  }
+  dest->locked = code_locked && data_locked;
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_measure_sweep(measuresuite_t ms, int batch_size, int num_batches,
+                     size_t window, size_t num_offsets,
+                     const struct ms_sweep_results **dest) {
+  if (ms->layout.code_window != 0) {
+    ms->errorno = E_INVALID_INPUT__LAYOUT;
+    return 1;
+  }
+  if (window == 0 || window > MS_MAX_PLACEMENT_ALIGNMENT ||
+      (window & (window - 1)) != 0 || num_offsets == 0 ||
+      num_offsets > window) {
+    ms->errorno = E_INVALID_INPUT__PLACEMENT;
+    return 1;
+  }
+  if (set_num_batches(ms, num_batches)     // set number of batches
+      || set_batch_size(ms, batch_size)    // set batch size
+      || run_sweep(ms, window, num_offsets) // measure at each offset
+  ) {
+    return 1;
+  }
+
+  *dest = &ms->sweep.results;
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_measure_data_sweep(measuresuite_t ms, int batch_size, int num_batches,
+                          size_t num_offsets,
+                          const struct ms_sweep_results **dest) {
+  if (ms->layout.data_window != 0) {
+    ms->errorno = E_INVALID_INPUT__LAYOUT;
+    return 1;
+  }
+  if (num_offsets == 0 || num_offsets > MS_DATA_PAGE_SIZE / 8) {
+    ms->errorno = E_INVALID_INPUT__DATA_OFFSET;
+    return 1;
+  }
+  if (set_num_batches(ms, num_batches)   // set number of batches
+      || set_batch_size(ms, batch_size)  // set batch size
+      || run_data_sweep(ms, num_offsets) // measure at each distance
+  ) {
+    return 1;
+  }
+
+  *dest = &ms->sweep.results;
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
+int ms_measure_working_set_sweep(measuresuite_t ms, int batch_size,
+                                 int num_batches,
+                                 const struct ms_working_set_results **dest) {
+  if (set_num_batches(ms, num_batches)  // set number of batches
+      || set_batch_size(ms, batch_size) // set batch size
+      || run_working_set_sweep(ms)      // measure at each level
+  ) {
+    return 1;
+  }
+
+  *dest = &ms->sweep.working_set_results;
+  ms->errorno = E_SUCCESS;
+  return 0;
+}
+
 int ms_measure(measuresuite_t ms, int batch_size, int num_batches) {
 
   if (set_num_batches(ms, num_batches)  // set number of batches
@@ -111,8 +487,16 @@ int ms_measure(measuresuite_t ms, int batch_size, int num_batches) {
 }
 
 void ms_get_json(measuresuite_t ms, const char **json, size_t *json_len) {
+  if (ms->results.version != 0 && !ms->json_valid) {
+    if (generate_json(ms)) {
+      *json = NULL;
+      *json_len = 0;
+      return;
+    }
+    ms->json_valid = 1;
+  }
   *json = ms->json;
-  *json_len = strlen(*json);
+  *json_len = ms->json_chars;
 }
 
 int ms_get_cycles(measuresuite_t ms, size_t **dest, size_t idx) {
@@ -124,6 +508,41 @@ int ms_get_cycles(measuresuite_t ms, size_t **dest, size_t idx) {
   return 0;
 }
 
+int ms_get_results(measuresuite_t ms, int version,
+                   const struct ms_results **dest) {
+  if (version > MS_RESULTS_VERSION) {
+    ms->errorno = E_INVALID_INPUT__RESULTS_VERSION;
+    return 1;
+  }
+  if (ms->results.version == 0) {
+    ms->errorno = E_INVALID_INPUT__NO_MEASUREMENT;
+    return 1;
+  }
+  *dest = &ms->results;
+  return 0;
+}
+
+int ms_take_cycles(measuresuite_t ms, uint64_t **dest, size_t *num_functions,
+                   size_t *num_batches) {
+  if (ms->results.version == 0 || ms->cycle_results == NULL) {
+    ms->errorno = E_INVALID_INPUT__NO_MEASUREMENT;
+    return 1;
+  }
+  *dest = ms->cycle_results;
+  // functions may have been (un)loaded since
+  *num_functions = ms->results.num_functions;
+  *num_batches = ms->results.num_batches;
+
+  // the next measurement allocates a new block
+  ms->cycle_results = NULL;
+  ms->cycle_results_size_u64 = 0;
+  FOR_EACH_FUNCTION { fct->cycle_results = NULL; }
+  for (size_t i = 0; i < ms->results.num_functions; i++) {
+    ms->function_results[i].cycles = NULL;
+  }
+  return 0;
+}
+
 enum TIMER ms_get_timer(measuresuite_t ms) {
   if (ms->timer.fdperf == -1) {
     return RDTSCP;
@@ -140,14 +559,25 @@ int ms_terminate(measuresuite_t ms) {
   if (ms == NULL) {
     return 0;
   }
-  if (ms_unload_all(ms) // unload all the loaded functions
-      || end_random(ms) // free random data spot
-      || end_timer(ms)  // free all timer related data
+  if (ms_unload_all(ms)          // unload all the loaded functions
+      || end_so_cache(ms)        // dlclose the released shared objects
+      || end_code_arena(ms)      // unmap the code memory
+      || end_layout(ms)          // unmap the randomized inputs and outputs
+      || end_working_set(ms)     // unmap the pool of inputs and outputs
+      || end_asm_incremental(ms) // free the line memo and scratch AL
+      || end_random(ms)          // free random data spot
+      || end_timer(ms)           // free all timer related data
   ) {
     return 1;
   }
 
+  end_asm_cache(&ms->asm_cache);
+  end_result_cache(ms);
+  end_sweep(ms);
   free(ms->json);
+  free(ms->cycle_results);
+  free(ms->function_results);
+  free(ms->batch_samples);
   free(ms->functions);
   free(ms->bounds);
   free(ms);
@@ -0,0 +1,145 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// MAP_ANONYMOUS, MAP_HUGETLB, MAP_POPULATE and madvise are not part of strict
+// C17 / POSIX
+#define _DEFAULT_SOURCE
+
+#include "memory.h"
+#include "debug.h"       // DEBUG
+#include "error/error.h" // E_INTERNAL_MEASURE__AI__ALLOC
+#include <errno.h>       // errno
+#include <stdint.h>      // uintptr_t
+#include <stdio.h>       // fopen / getline / sscanf
+#include <stdlib.h>      // free
+#include <string.h>      // memset / strerror / strncmp
+#include <sys/mman.h>    // mmap...
+#include <unistd.h>      // sysconf
+
+static size_t round_up(size_t len, size_t to) {
+  return (len + to - 1) / to * to;
+}
+
+// @returns MAP_FAILED, or @param len bytes at a multiple of a huge page with
+// transparent huge pages requested, not faulted in yet
+static void *map_transparent(size_t len, int prot) {
+  // over-allocate, and cut the ends off to align it
+  const size_t padded = len + MEMORY_HUGE_PAGE_SIZE;
+  char *raw = mmap(NULL, padded, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  // NOLINTNEXTLINE
+  if (raw == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  char *aligned = (char *)round_up((uintptr_t)raw, MEMORY_HUGE_PAGE_SIZE);
+  const size_t head = aligned - raw;
+  if (head != 0) {
+    munmap(raw, head);
+  }
+  munmap(aligned + len, padded - head - len);
+  // not an error if the kernel has no transparent huge pages
+  madvise(aligned, len, MADV_HUGEPAGE);
+  return aligned;
+}
+
+int memory_map(struct measuresuite *ms, size_t *len, int exec, void **dest) {
+  const int prot = PROT_READ | PROT_WRITE | (exec ? PROT_EXEC : 0);
+  void *region = MAP_FAILED;
+  if (ms->memory_flags & MS_MEMORY_HUGE_PAGES) {
+    *len = round_up(*len, MEMORY_HUGE_PAGE_SIZE);
+    region = mmap(NULL, *len, prot,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1,
+                  0);
+    // NOLINTNEXTLINE
+    if (region == MAP_FAILED) {
+      DEBUG("memory: no explicit huge pages (%s)\n", strerror(errno));
+      region = map_transparent(*len, prot);
+      // NOLINTNEXTLINE
+      if (region != MAP_FAILED) {
+        // fault it in, in huge pages if there are any
+        memset(region, 0, *len);
+      }
+    }
+  } else {
+    *len = round_up(*len, sysconf(_SC_PAGESIZE));
+    region = mmap(NULL, *len, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                  -1, 0);
+  }
+
+  // NOLINTNEXTLINE
+  if (region == MAP_FAILED) {
+    *dest = NULL;
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  memory_lock(ms, region, *len);
+  *dest = region;
+  return 0;
+}
+
+int memory_unmap(struct measuresuite *ms, void *region, size_t len) {
+  if (region != NULL && munmap(region, len)) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  return 0;
+}
+
+void memory_lock(struct measuresuite *ms, const void *region, size_t len) {
+  if ((ms->memory_flags & MS_MEMORY_LOCK) && region != NULL && len != 0 &&
+      mlock(region, len) != 0) {
+    DEBUG("memory: cannot lock %lu bytes (%s)\n", len, strerror(errno));
+  }
+}
+
+int memory_status(struct measuresuite *ms, const void *region, size_t len,
+                  enum ms_page_size *pages, int *locked) {
+  FILE *smaps = fopen("/proc/self/smaps", "r");
+  if (smaps == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__SMAPS;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+
+  // of the mapping which holds the region, in kB
+  const uintptr_t address = (uintptr_t)region;
+  size_t page_kb = 0, anon_huge_kb = 0, locked_kb = 0;
+  int found = 0;
+  char *line = NULL;
+  size_t line_size = 0;
+  while (getline(&line, &line_size, smaps) != -1) {
+    uintptr_t start = 0, end = 0;
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+      if (found) {
+        break; // the next mapping
+      }
+      found = start <= address && address < end;
+    } else if (found) {
+      sscanf(line, "KernelPageSize: %zu kB", &page_kb);
+      sscanf(line, "AnonHugePages: %zu kB", &anon_huge_kb);
+      sscanf(line, "Locked: %zu kB", &locked_kb);
+    }
+  }
+  free(line);
+  fclose(smaps);
+
+  *pages = page_kb * 1024 >= MEMORY_HUGE_PAGE_SIZE ? MS_PAGES_HUGE
+           : anon_huge_kb != 0                     ? MS_PAGES_TRANSPARENT_HUGE
+                                                   : MS_PAGES_SMALL;
+  *locked = found && locked_kb * 1024 >= len;
+  return 0;
+}
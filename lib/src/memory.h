@@ -0,0 +1,51 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+// size of a huge page, mappings with MS_MEMORY_HUGE_PAGES are multiples of it
+#define MEMORY_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+/**
+ * Maps @param *len bytes of pre-faulted memory (executable if @param exec) to
+ * @param *dest, backed as ms_set_memory_options asks for:
+ * with MS_MEMORY_HUGE_PAGES, explicit (hugetlbfs) huge pages if the system has
+ * them reserved, transparent ones if not; with MS_MEMORY_LOCK, mlock'ed.
+ * Either falls back to normal pages silently, see memory_status.
+ * Rounds @param *len up to what has been mapped, pass it to memory_unmap.
+ */
+int memory_map(struct measuresuite *ms, size_t *len, int exec, void **dest);
+int memory_unmap(struct measuresuite *ms, void *region, size_t len);
+
+/**
+ * mlocks @param len bytes at @param region (of the heap) if MS_MEMORY_LOCK is
+ * set. Failing to do so is not an error, see memory_status.
+ */
+void memory_lock(struct measuresuite *ms, const void *region, size_t len);
+
+/**
+ * Looks up the pages backing the @param len bytes at @param region in
+ * /proc/self/smaps. Sets @param *pages and @param *locked (1 if all of it is
+ * locked).
+ */
+int memory_status(struct measuresuite *ms, const void *region, size_t len,
+                  enum ms_page_size *pages, int *locked);
+
+#endif
@@ -15,6 +15,7 @@
  */
 
 #include "randomizer.h"
+#include "data_arena.h"
 #include "error/error.h"
 #include <errno.h> //errno
 #include <fcntl.h> // open/close
@@ -51,11 +52,8 @@ int init_random(struct measuresuite *ms) {
     return 1;
   }
 
-  // allocate data
-  ms->random_data = malloc(ms->random_data_len * sizeof(uint64_t));
-  if (ms->random_data == NULL) {
-    ms->errorno = E_INTERNAL_RANDOMNESS__AI__MALLOC;
-    ms->additional_info = strerror(errno);
+  // the inputs live in the data arena, next to the outputs
+  if (init_data_arena(ms)) {
     return 1;
   }
 
@@ -95,9 +93,10 @@ int randomize(struct measuresuite *ms) {
 }
 
 int end_random(struct measuresuite *ms) {
-  // free field
-  free(ms->random_data);
-  ms->random_data = NULL;
+  // unmapped with the data arena
+  if (end_data_arena(ms)) {
+    return 1;
+  }
 
   // sanity check
   if (ms->random_data_fd != -1) {
@@ -0,0 +1,363 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "result_cache.h"
+#include "debug.h"
+#include "error/error.h"
+#include "hash.h"
+#include "measuresuite.h"
+#include "struct_measuresuite.h"
+#include <errno.h>  // errno
+#include <stdint.h> // uint64_t
+#include <stdio.h>  // fopen...
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcmp, memcpy, strerror
+
+// file format: header, then per entry: key, code_len, num_batches, next and
+// num_batches samples. All in host byte order.
+static const char result_cache_magic[4] = {'M', 'S', 'R', 'C'};
+static const uint32_t result_cache_version = 1;
+
+static void flush(struct result_cache *cache) {
+  for (size_t i = 0; i < cache->num_slots; i++) {
+    free(cache->entries[i].samples);
+    cache->entries[i].samples = NULL;
+  }
+  cache->num = 0;
+}
+
+void end_result_cache(struct measuresuite *ms) {
+  struct result_cache *cache = &ms->result_cache;
+  flush(cache);
+  free(cache->entries);
+  memset(cache, 0, sizeof(*cache));
+}
+
+int result_cache_resize(struct measuresuite *ms, size_t capacity,
+                        size_t top_up) {
+  end_result_cache(ms);
+  if (capacity == 0) {
+    return 0;
+  }
+
+  struct result_cache *cache = &ms->result_cache;
+  size_t num_slots = 1;
+  while (num_slots < 2 * capacity) {
+    num_slots <<= 1;
+  }
+  cache->entries = calloc(num_slots, sizeof(struct result_cache_entry));
+  if (cache->entries == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  cache->num_slots = num_slots;
+  cache->capacity = capacity;
+  cache->top_up = top_up;
+  return 0;
+}
+
+// everything, besides the code, that influences the measured cycles
+static uint64_t config_hash(struct measuresuite *ms) {
+  const uint64_t config[] = {
+      ms->arg_width,  ms->num_arg_in,  ms->num_arg_out,
+      ms->batch_size, ms->num_batches, ms_get_timer(ms),
+  };
+  uint64_t hash = hash_bytes(config, sizeof(config), 0);
+  if (ms->layout.code_window != 0 || ms->layout.data_window != 0) {
+    const uint64_t layout[] = {ms->layout.code_window, ms->layout.data_window};
+    hash = hash_bytes(layout, sizeof(layout), hash);
+  }
+  if (ms->data_arena.placed) {
+    // 4K aliasing depends on where the inputs and outputs are
+    const uint64_t offsets[] = {ms->data_arena.in_offset,
+                                ms->data_arena.out_offset};
+    hash = hash_bytes(offsets, sizeof(offsets), hash);
+  }
+  if (ms->working_set.num_sets != 0) {
+    // other memory, other cycles
+    hash = hash_bytes(&ms->working_set.num_sets, sizeof(size_t), hash);
+  }
+  if (ms->num_aliased != 0) {
+    // in place, the functions compute (and take) something else
+    hash = hash_bytes(ms->aliases, ms->num_arg_out * sizeof(int), hash);
+  }
+  if (ms->bounds == NULL) {
+    return hash;
+  }
+  return hash_bytes(ms->bounds, ms->arg_width * sizeof(uint64_t), hash);
+}
+
+// @returns the entry for the key, or the empty slot where it would go
+static struct result_cache_entry *probe(struct result_cache *cache,
+                                        uint64_t key, size_t code_len,
+                                        size_t num_batches) {
+  size_t mask = cache->num_slots - 1;
+  for (size_t i = key & mask;; i = (i + 1) & mask) {
+    struct result_cache_entry *e = &cache->entries[i];
+    if (e->samples == NULL || (e->key == key && e->code_len == code_len &&
+                               e->num_batches == num_batches)) {
+      return e;
+    }
+  }
+}
+
+// copies @param samples into a new entry. Flushes the cache if it is full.
+static int insert(struct measuresuite *ms, uint64_t key, size_t code_len,
+                  size_t num_batches, const uint64_t *samples, size_t next) {
+  struct result_cache *cache = &ms->result_cache;
+  struct result_cache_entry *e = probe(cache, key, code_len, num_batches);
+  if (e->samples != NULL) {
+    return 0; // already there
+  }
+  if (cache->num >= cache->capacity) {
+    DEBUG("result cache: full, flushing %lu entries\n", cache->num);
+    flush(cache);
+    e = probe(cache, key, code_len, num_batches);
+  }
+
+  e->samples = malloc(num_batches * sizeof(uint64_t));
+  if (e->samples == NULL) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__ALLOC;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  memcpy(e->samples, samples, num_batches * sizeof(uint64_t));
+  e->key = key;
+  e->code_len = code_len;
+  e->num_batches = num_batches;
+  e->next = next;
+  cache->num++;
+  return 0;
+}
+
+void result_cache_lookup_all(struct measuresuite *ms, size_t *num_batches) {
+  struct result_cache *cache = &ms->result_cache;
+  *num_batches = ms->num_batches;
+
+  FOR_EACH_FUNCTION { fct->cached_result = NULL; }
+  if (cache->capacity == 0) {
+    return;
+  }
+
+  const uint64_t config = config_hash(ms);
+  int all_cached = 1;
+  FOR_EACH_FUNCTION {
+    if (fct->type == SHARED_OBJECT) {
+      all_cached = 0;
+      continue;
+    }
+    uint64_t seed = config;
+    if (fct->placement_alignment != 0) {
+      // the same code runs differently elsewhere
+      const uint64_t placement[] = {fct->placement_alignment,
+                                    fct->placement_offset};
+      seed = hash_bytes(placement, sizeof(placement), config);
+    }
+    fct->result_key = hash_bytes(fct->code, fct->code_size_bytes, seed);
+    if (ms->enable_check) {
+      all_cached = 0;
+      continue;
+    }
+
+    struct result_cache_entry *e = probe(cache, fct->result_key,
+                                         fct->code_size_bytes, ms->num_batches);
+    if (e->samples == NULL) {
+      cache->misses++;
+      all_cached = 0;
+    } else {
+      cache->hits++;
+      fct->cached_result = e;
+    }
+  }
+
+  // only the top ups are left
+  if (all_cached && ms->num_functions > 0) {
+    *num_batches = cache->top_up < ms->num_batches ? cache->top_up
+                                                   : ms->num_batches;
+  }
+}
+
+int result_cache_store_all(struct measuresuite *ms) {
+  struct result_cache *cache = &ms->result_cache;
+  if (cache->capacity == 0) {
+    return 0;
+  }
+
+  // hits first, as storing may flush the cache
+  FOR_EACH_FUNCTION {
+    struct result_cache_entry *e = fct->cached_result;
+    if (e == NULL) {
+      continue;
+    }
+    // replace the oldest samples with the fresh ones
+    for (size_t i = 0; i < cache->top_up && i < e->num_batches; i++) {
+      e->samples[e->next] = fct->cycle_results[i];
+      e->next = (e->next + 1) % e->num_batches;
+    }
+    // and report all, oldest first
+    for (size_t i = 0; i < e->num_batches; i++) {
+      fct->cycle_results[i] = e->samples[(e->next + i) % e->num_batches];
+    }
+  }
+
+  int ret = 0;
+  FOR_EACH_FUNCTION {
+    if (fct->cached_result == NULL && fct->type != SHARED_OBJECT) {
+      ret |= insert(ms, fct->result_key, fct->code_size_bytes, ms->num_batches,
+                    fct->cycle_results, 0);
+    }
+  }
+  FOR_EACH_FUNCTION { fct->cached_result = NULL; }
+  return ret;
+}
+
+uint64_t result_cache_sample(const struct function_tuple *fct, size_t batch) {
+  const struct result_cache_entry *e = fct->cached_result;
+  return e->samples[(e->next + batch) % e->num_batches];
+}
+
+void result_cache_abort_all(struct measuresuite *ms, size_t num_batches) {
+  FOR_EACH_FUNCTION {
+    if (fct->cached_result == NULL) {
+      continue;
+    }
+    for (size_t i = ms->result_cache.top_up; i < num_batches; i++) {
+      fct->cycle_results[i] = result_cache_sample(fct, i);
+    }
+    fct->cached_result = NULL;
+  }
+}
+
+static int io_error(struct measuresuite *ms, FILE *file) {
+  ms->errorno = E_RESULT_CACHE__IO;
+  ms->additional_info = strerror(errno);
+  if (file != NULL) {
+    fclose(file);
+  }
+  return 1;
+}
+
+int result_cache_save(struct measuresuite *ms, const char *filename) {
+  struct result_cache *cache = &ms->result_cache;
+  FILE *file = fopen(filename, "wb");
+  if (file == NULL) {
+    return io_error(ms, NULL);
+  }
+
+  const uint64_t num = cache->num;
+  if (fwrite(result_cache_magic, sizeof(result_cache_magic), 1, file) != 1 ||
+      fwrite(&result_cache_version, sizeof(result_cache_version), 1, file) !=
+          1 ||
+      fwrite(&num, sizeof(num), 1, file) != 1) {
+    return io_error(ms, file);
+  }
+
+  for (size_t i = 0; i < cache->num_slots; i++) {
+    const struct result_cache_entry *e = &cache->entries[i];
+    if (e->samples == NULL) {
+      continue;
+    }
+    const uint64_t meta[] = {e->key, e->code_len, e->num_batches, e->next};
+    if (fwrite(meta, sizeof(meta), 1, file) != 1 ||
+        fwrite(e->samples, sizeof(uint64_t), e->num_batches, file) !=
+            e->num_batches) {
+      return io_error(ms, file);
+    }
+  }
+
+  if (fclose(file)) {
+    return io_error(ms, NULL);
+  }
+  return 0;
+}
+
+static int invalid_file(struct measuresuite *ms, FILE *file, void *samples) {
+  free(samples);
+  fclose(file);
+  ms->errorno = E_RESULT_CACHE__INVALID_FILE;
+  return 1;
+}
+
+// @returns the bytes from the position of @param file to its end, 0 if that
+// cannot be told
+static uint64_t bytes_left(FILE *file) {
+  const long pos = ftell(file);
+  if (pos < 0 || fseek(file, 0, SEEK_END) != 0) {
+    return 0;
+  }
+  const long end = ftell(file);
+  if (fseek(file, pos, SEEK_SET) != 0 || end < pos) {
+    return 0;
+  }
+  return (uint64_t)(end - pos);
+}
+
+int result_cache_load(struct measuresuite *ms, const char *filename) {
+  struct result_cache *cache = &ms->result_cache;
+  if (cache->capacity == 0) {
+    ms->errorno = E_RESULT_CACHE__DISABLED;
+    return 1;
+  }
+
+  FILE *file = fopen(filename, "rb");
+  if (file == NULL) {
+    return io_error(ms, NULL);
+  }
+
+  char magic[sizeof(result_cache_magic)] = {0};
+  uint32_t version = 0;
+  uint64_t num = 0;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      fread(&version, sizeof(version), 1, file) != 1 ||
+      fread(&num, sizeof(num), 1, file) != 1 ||
+      memcmp(magic, result_cache_magic, sizeof(magic)) != 0 ||
+      version != result_cache_version) {
+    return invalid_file(ms, file, NULL);
+  }
+
+  // take as many as fit, without flushing what is there already
+  uint64_t *samples = NULL;
+  uint64_t left = bytes_left(file);
+  for (uint64_t i = 0; i < num && cache->num < cache->capacity; i++) {
+    uint64_t meta[4] = {0}; // key, code_len, num_batches, next
+    if (left < sizeof(meta) || fread(meta, sizeof(meta), 1, file) != 1) {
+      return invalid_file(ms, file, samples);
+    }
+    left -= sizeof(meta);
+    // no more samples than the file holds, which also keeps the sizes from
+    // wrapping around
+    if (meta[1] > SIZE_MAX || meta[2] == 0 ||
+        meta[2] > left / sizeof(uint64_t) ||
+        meta[2] > SIZE_MAX / sizeof(uint64_t) || meta[3] >= meta[2]) {
+      return invalid_file(ms, file, samples);
+    }
+    left -= meta[2] * sizeof(uint64_t);
+    uint64_t *grown = realloc(samples, meta[2] * sizeof(uint64_t));
+    if (grown == NULL) {
+      return invalid_file(ms, file, samples);
+    }
+    samples = grown;
+    if (fread(samples, sizeof(uint64_t), meta[2], file) != meta[2] ||
+        insert(ms, meta[0], meta[1], meta[2], samples, meta[3])) {
+      return invalid_file(ms, file, samples);
+    }
+  }
+
+  free(samples);
+  fclose(file);
+  return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * The result cache stores the measured cycles of each function, keyed by a
+ * hash over its machine code and the measurement config (argument counts and
+ * width, bounds, batch size, number of batches, timer and layout
+ * randomization), and its placement unless that is the default. A function
+ * whose
+ * code has been measured before with the same config is not measured again;
+ * instead, its cached samples are reported. Optionally, it is still measured
+ * in the first @param top_up batches, and those fresh samples replace the
+ * oldest cached ones, such that drift shows up over time.
+ * Shared objects are never cached, and lookups are skipped while checking is
+ * enabled (results are still stored).
+ * When the cache is full, it is flushed.
+ */
+int result_cache_resize(struct measuresuite *ms, size_t capacity,
+                        size_t top_up);
+void end_result_cache(struct measuresuite *ms);
+
+/**
+ * to be called before measuring. Sets fct->cached_result for each function
+ * with an entry, and @param *num_batches to the number of batches which still
+ * need to be run.
+ */
+void result_cache_lookup_all(struct measuresuite *ms, size_t *num_batches);
+
+/**
+ * to be called after measuring. Tops up the entries of functions with a hit
+ * and fills their cycle_results from the cache; stores all others.
+ */
+int result_cache_store_all(struct measuresuite *ms);
+
+/**
+ * @returns the cached sample reported for @param batch of @param fct, which
+ * must have a cached_result.
+ */
+uint64_t result_cache_sample(const struct function_tuple *fct, size_t batch);
+
+/**
+ * to be called instead of result_cache_store_all, if the measurement stopped
+ * after @param num_batches batches. Fills the batches which have not been run
+ * for functions with a hit from the cache; stores nothing.
+ */
+void result_cache_abort_all(struct measuresuite *ms, size_t num_batches);
+
+int result_cache_save(struct measuresuite *ms, const char *filename);
+int result_cache_load(struct measuresuite *ms, const char *filename);
+
+#endif
@@ -22,6 +22,7 @@
 #include <linux/perf_event.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h> // dev_t, ino_t
 
 #ifdef USE_ASSEMBLYLINE
 #include <assemblyline.h>
@@ -30,16 +31,48 @@
 #include <inttypes.h> // uint64_t's
 #include <stdlib.h>   // size_t
 
+// size classes of the code arena: 64 bytes << 0 .. 64 bytes << 14 (1 MiB)
+#define CODE_ARENA_NUM_CLASSES 15
+
+struct result_cache_entry {
+  uint64_t key; // hash of the code, seeded with the measurement config
+  size_t code_len;
+  size_t num_batches;
+  uint64_t *samples; // num_batches cycle counts; NULL if the entry is unused
+  size_t next;       // oldest sample, the next top up overwrites from here
+};
+
+// a dlopen'ed shared object, identified by the device and inode of its file
+struct so_cache_entry {
+  dev_t dev;
+  ino_t ino;
+  void *handle;
+  int fd;      // the memfd of a library loaded from memory, -1 otherwise
+  size_t refs; // functions whose code is in the library
+};
+
 struct function_tuple {
 
   enum load_type type;
 
   // actual code
   void *code; // function pointer
-  union {
-    size_t code_size_bytes; // for when we allcate ourselves (ASM/BIN)
-    void *lib_handle;       // dlopen'ed handle
-  };
+  // for when we allcate ourselves (ASM/BIN/ELF)
+  size_t code_size_bytes;     // exact length of the machine code at *code
+  size_t code_capacity_bytes; // size of the code arena slot *code lives in
+  size_t code_start;          // bytes between the slot and *code
+  // *code starts placement_offset bytes after the first multiple of
+  // placement_alignment in the slot, or at the slot if that is 0
+  size_t placement_alignment;
+  size_t placement_offset;
+  // set for ELF code with absolute addresses into itself, it cannot be moved
+  int position_dependent;
+  // *code must start at a multiple of this, the largest section alignment of
+  // linked ELF code, 1 otherwise
+  size_t code_alignment;
+  void *lib_handle; // dlopen'ed handle
+  // name of the archive member the code was loaded from, NULL if none
+  char *member;
 
   uint64_t *arithmetic_results;
   uint64_t *cycle_results;
@@ -47,9 +80,39 @@ struct function_tuple {
 #ifdef USE_ASSEMBLYLINE
   // how many chunk breaks have been observed while assembling with AL
   int chunks;
-  // assembler
-  assemblyline_t al;
 #endif
+  // how long the last ASM load took to assemble (incl. cache lookups)
+  uint64_t assembly_ns;
+
+  // set during a measurement if the result cache has an entry for this code
+  struct result_cache_entry *cached_result;
+  uint64_t result_key;
+};
+
+// marks the end of a list in the asm cache
+#define ASM_CACHE_NONE SIZE_MAX
+
+struct asm_cache_entry {
+  uint64_t hash;     // of text, seeded with chunk_size
+  size_t chunk_size; // the text has been assembled with
+  char *text;        // text_len bytes, followed by code in the same allocation
+  size_t text_len;
+  uint8_t *code;
+  size_t code_len;
+  int chunks;
+  size_t bucket_next;        // next entry in the same hash bucket
+  size_t lru_prev, lru_next; // more / less recently used entry
+};
+
+// used in incremental assembly
+struct asm_label {
+  const char *name; // points into the asm string
+  size_t name_len;
+  size_t offset; // into the code, SIZE_MAX until the label has been seen
+};
+struct asm_fixup {
+  size_t offset; // of the rel32 to patch
+  size_t label;  // index into labels
 };
 
 struct measuresuite {
@@ -68,12 +131,13 @@ struct measuresuite {
   // how many times function_A/B is called in a row resulting in one measurement
   size_t batch_size;
 
-  // this is the output json, which is being built after measurement is done,
-  // alloc'd on init, realloced on demand in measurement
+  // this is the output json, which is being built in ms_get_json after
+  // measurement is done. alloc'd on init, grown to the exact size needed
   char *json;
   // is is the length of the allocated space at *json (not the non-NUL-chars
-  // use strlen for that.)
+  // that is json_chars.)
   size_t json_len;
+  size_t json_chars;
 
   // they are pointers to input. For the functions_{A,B,Check}
   // alloc'd on init
@@ -85,15 +149,151 @@ struct measuresuite {
   size_t *permutation;    // pointing to an array of #num_functions size,
                           // cointaining indexes into the *functions-array
 
-  // // the cycles are measures in 64-bit uints
-  // // alloc'd on init, realloced on demand in measurement
-  // uint64_t *cycle_results;
-  // size_t cycle_results_size_u64; // size in elements of size uint64_t
+  // the cycles are measures in 64-bit uints, num_batches per function, in
+  // one block. The cycle_results of each function points into it.
+  // realloced on demand in measurement, NULL after ms_take_cycles
+  uint64_t *cycle_results;
+  size_t cycle_results_size_u64; // size in elements of size uint64_t
   // char *run_order;
   // size_t run_order_size_bytes;
 
+  // called after each batch, see ms_set_batch_callback
+  ms_batch_callback batch_callback;
+  void *batch_callback_ctx;
+  uint64_t *batch_samples; // num_functions elements passed to it
+
+  // of the last measurement, version 0 if there is none
+  struct ms_results results;
+  struct ms_function_result *function_results; // results.functions
+  size_t function_results_len; // allocated elements at *function_results
+  // whether *json is generated from results already
+  char json_valid : 1;
+
   char enable_check : 1;
 
+  // RWX memory from which the code of all functions is allocated
+  struct code_arena {
+    void **chunks;     // all mmap'ed chunks
+    size_t num_chunks; // used elements in chunks
+    char *bump;        // next unused byte in the last chunk
+    char *bump_end;    // end of the last chunk
+    // singly linked lists of freed slots, the next-pointer is stored in the
+    // first bytes of each slot
+    void *free_lists[CODE_ARENA_NUM_CLASSES];
+  } code_arena;
+
+  // the inputs (random_data) and the outputs of each function, see data_arena.h
+  struct data_arena {
+    uint8_t *base; // mapping of len bytes
+    size_t len;
+    size_t in_start;   // bytes before the inputs
+    size_t in_size;    // bytes before the outputs, rounded up to a cache line
+    size_t out_start;  // bytes before the outputs of each function
+    size_t out_stride; // bytes between the outputs of two functions
+    size_t capacity;   // functions whose outputs fit
+    // set by ms_set_data_offsets, the inputs and outputs then go the offsets
+    // into pages of their own
+    int placed;
+    size_t in_offset, out_offset;
+  } data_arena;
+
+  // MS_MEMORY_* flags, see ms_set_memory_options
+  int memory_flags;
+
+  // strided through call by call instead of reusing the inputs, see
+  // ms_set_working_set. Disabled if num_sets is 0
+  struct working_set {
+    uint64_t *pool; // mapping of len bytes
+    size_t len;
+    size_t bytes;    // as asked for
+    size_t set_size; // uint64_t's of one argument set, inputs then outputs
+    size_t num_sets;
+    size_t next;    // set of the next call, across all functions
+    uint64_t state; // of the generator filling the inputs
+  } working_set;
+
+  // the in argument each out argument is passed in place of, or MS_ALIAS_NONE;
+  // see ms_set_aliasing. num_aliased is 0 if none is.
+  int aliases[6]; // max_number_arguments
+  size_t num_aliased;
+
+  // bounded LRU cache of assembled asm strings, disabled if capacity is 0
+  struct asm_cache {
+    struct asm_cache_entry *entries; // array of capacity elements
+    size_t capacity;
+    size_t num;                // used entries
+    size_t *buckets;           // index of the first entry in each bucket
+    size_t num_buckets;        // power of two
+    size_t lru_head, lru_tail; // most / least recently used entry
+    uint64_t hits, misses;
+  } asm_cache;
+
+  // incremental assembly, disabled if lines.capacity is 0
+  struct asm_incremental {
+    struct asm_cache lines; // memoized encodings of single lines
+#ifdef USE_ASSEMBLYLINE
+    assemblyline_t al;     // encodes one line at a time into line_code
+    uint8_t line_code[256];
+#endif
+    char *line; // NUL-terminated copy of the line being encoded
+    size_t line_size;
+    uint8_t *code; // code being laid out
+    size_t code_len, code_size;
+    struct asm_label *labels;
+    size_t num_labels, size_labels;
+    struct asm_fixup *fixups;
+    size_t num_fixups, size_fixups;
+  } incremental;
+
+  // measured cycles by code and config, disabled if capacity is 0
+  struct result_cache {
+    struct result_cache_entry *entries; // open addressing, num_slots of them
+    size_t num_slots;                   // power of two, >= 2 * capacity
+    size_t capacity;
+    size_t num;    // used entries
+    size_t top_up; // batches measured anyway for functions with a hit
+    uint64_t hits, misses;
+  } result_cache;
+
+  // of the last ms_measure_sweep, sweep.results.num_offsets 0 if there is none
+  struct sweep {
+    struct ms_sweep_results results;
+    size_t *offsets;
+    uint64_t *medians;
+    struct ms_sweep_function *functions;
+    size_t *saved;     // alignment and offset of each function before it
+    // data offsets before a data sweep
+    int saved_placed;
+    size_t saved_in_offset, saved_out_offset;
+    // of the last ms_measure_working_set_sweep
+    struct ms_working_set_results working_set_results;
+    struct ms_working_set_level levels[MS_MAX_CACHE_LEVELS];
+    double *cycles_per_call;
+    uint64_t *scratch; // samples, sorted for a median
+  } sweep;
+
+  // randomized before each batch, see ms_set_layout_randomization. Disabled
+  // if both windows are 0
+  struct layout {
+    size_t code_window, data_window;
+    int require_movable;
+    uint64_t state; // of the generator of the offsets
+    // data_window bytes of room for the inputs, then for the outputs, each
+    // starting at a cache line
+    uint64_t *data;
+    size_t data_len;          // mapped bytes at *data
+    size_t in_size, out_size; // in uint64_t's, inputs rounded to cache lines
+    uint64_t *in, *out;       // where they are in this batch
+    size_t *saved;            // alignment and offset of each function before
+  } layout;
+
+  // shared objects in use, so loading many symbols from one opens it once
+  struct so_cache {
+    struct so_cache_entry *entries; // array of capacity elements
+    size_t capacity;
+    size_t num; // used entries
+  } so_cache;
+
   // points to the code in memory to execute
   struct function_tuple *functions;
   size_t size_functions; // available function pointers
@@ -0,0 +1,289 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sweep.h"
+#include "alloc_helper.h" // realloc_or_fail
+#include "data_arena.h"   // data_arena_set_offsets
+#include "debug.h"        // DEBUG
+#include "error/error.h"  // ERROR_NUMBER
+#include "evaluator.h"    // run_measurement
+#include "loader.h"       // set_placement / code_movable
+#include "working_set.h"  // working_set_{resize,cache_levels}
+#include <stdlib.h>       // qsort / free
+#include <string.h>       // memcpy / memset
+
+static int compare_u64(const void *a, const void *b) {
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// @returns the median of the @param num values @param stride elements apart
+// at @param values, sorting a copy of them in @param scratch
+static uint64_t median(const uint64_t *values, size_t num, size_t stride,
+                       uint64_t *scratch) {
+  for (size_t i = 0; i < num; i++) {
+    scratch[i] = values[i * stride];
+  }
+  qsort(scratch, num, sizeof(uint64_t), compare_u64);
+  return scratch[num / 2];
+}
+
+// makes room for the statistics of @param num_offsets offsets
+static int grow(struct measuresuite *ms, size_t num_offsets) {
+  struct sweep *sweep = &ms->sweep;
+  // one more, such that nothing is allocated with 0 bytes
+  const size_t num_functions = ms->num_functions + 1;
+  const size_t num_scratch =
+      (ms->num_batches > num_offsets ? ms->num_batches : num_offsets) + 1;
+  return realloc_or_fail(ms, (void **)&sweep->offsets,
+                         num_offsets * sizeof(size_t)) ||
+         realloc_or_fail(ms, (void **)&sweep->medians,
+                         num_offsets * num_functions * sizeof(uint64_t)) ||
+         realloc_or_fail(ms, (void **)&sweep->functions,
+                         num_functions * sizeof(struct ms_sweep_function)) ||
+         realloc_or_fail(ms, (void **)&sweep->saved,
+                         2 * num_functions * sizeof(size_t)) ||
+         realloc_or_fail(ms, (void **)&sweep->scratch,
+                         num_scratch * sizeof(uint64_t));
+}
+
+// what a sweep moves
+enum sweep_target { SWEEP_CODE, SWEEP_DATA };
+
+// places all movable functions @param offset bytes into a @param window
+static int place_all(struct measuresuite *ms, size_t window, size_t offset) {
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    if (code_movable(&ms->functions[f]) &&
+        set_placement(ms, f, window, offset)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// moves the code, or the outputs relative to the inputs, to @param offset
+static int move_all(struct measuresuite *ms, enum sweep_target target,
+                    size_t window, size_t offset) {
+  if (target == SWEEP_CODE) {
+    return place_all(ms, window, offset);
+  }
+  const size_t in_offset = ms->sweep.saved_in_offset;
+  return data_arena_set_offsets(ms, 1, in_offset,
+                                (in_offset + offset) % window);
+}
+
+// stores the median cycles of each function of the last measurement in
+// @param row
+static void store_medians(struct measuresuite *ms, uint64_t *row) {
+  const struct ms_results *res = &ms->results;
+  for (size_t f = 0; f < res->num_functions; f++) {
+    row[f] = median(res->functions[f].cycles, res->num_batches, 1,
+                    ms->sweep.scratch);
+  }
+}
+
+// summarizes the medians of each function over @param num_offsets offsets
+static void summarize(struct measuresuite *ms, enum sweep_target target,
+                      size_t num_offsets) {
+  struct sweep *sweep = &ms->sweep;
+  const size_t num_functions = ms->num_functions;
+  for (size_t f = 0; f < num_functions; f++) {
+    struct ms_sweep_function *sum = &sweep->functions[f];
+    const uint64_t *column = &sweep->medians[f];
+    *sum = (struct ms_sweep_function){
+        .min = column[0],
+        .max = column[0],
+        .median = median(column, num_offsets, num_functions, sweep->scratch),
+        .best = 0,
+        // the data of all functions moves
+        .moved = target == SWEEP_DATA || code_movable(&ms->functions[f]),
+    };
+    for (size_t i = 1; i < num_offsets; i++) {
+      const uint64_t value = column[i * num_functions];
+      if (value < sum->min) {
+        sum->min = value;
+        sum->best = i;
+      }
+      if (value > sum->max) {
+        sum->max = value;
+      }
+    }
+  }
+}
+
+// saves what @param target moves, to restore it afterwards
+static void save(struct measuresuite *ms, enum sweep_target target) {
+  struct sweep *sweep = &ms->sweep;
+  if (target == SWEEP_DATA) {
+    sweep->saved_placed = ms->data_arena.placed;
+    sweep->saved_in_offset = ms->data_arena.in_offset;
+    sweep->saved_out_offset = ms->data_arena.out_offset;
+    return;
+  }
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    sweep->saved[2 * f] = ms->functions[f].placement_alignment;
+    sweep->saved[2 * f + 1] = ms->functions[f].placement_offset;
+  }
+}
+
+static int restore(struct measuresuite *ms, enum sweep_target target) {
+  struct sweep *sweep = &ms->sweep;
+  if (target == SWEEP_DATA) {
+    return data_arena_set_offsets(ms, sweep->saved_placed,
+                                  sweep->saved_in_offset,
+                                  sweep->saved_out_offset);
+  }
+  for (size_t f = 0; f < ms->num_functions; f++) {
+    if (code_movable(&ms->functions[f]) &&
+        set_placement(ms, f, sweep->saved[2 * f], sweep->saved[2 * f + 1])) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// measures at @param num_offsets offsets into @param window, multiples of
+// @param granularity bytes
+static int sweep_offsets(struct measuresuite *ms, enum sweep_target target,
+                         size_t window, size_t num_offsets,
+                         size_t granularity) {
+  struct sweep *sweep = &ms->sweep;
+  sweep->results.num_offsets = 0;
+  if (grow(ms, num_offsets)) {
+    return 1;
+  }
+  save(ms, target);
+
+  int ret = 0;
+  for (size_t i = 0; i < num_offsets && !ret; i++) {
+    sweep->offsets[i] = i * window / num_offsets / granularity * granularity;
+    DEBUG("sweep: measuring at offset %lu of %lu\n", sweep->offsets[i],
+          window);
+    ret = move_all(ms, target, window, sweep->offsets[i]) ||
+          run_measurement(ms);
+    if (!ret) {
+      store_medians(ms, &sweep->medians[i * ms->num_functions]);
+    }
+  }
+
+  // put them back, also if a measurement failed
+  ERROR_NUMBER errorno = ms->errorno;
+  if (restore(ms, target)) {
+    return 1;
+  }
+  if (ret) {
+    ms->errorno = errorno;
+    return 1;
+  }
+
+  summarize(ms, target, num_offsets);
+  sweep->results = (struct ms_sweep_results){
+      .window = window,
+      .num_offsets = num_offsets,
+      .num_functions = ms->num_functions,
+      .offsets = sweep->offsets,
+      .medians = sweep->medians,
+      .functions = sweep->functions,
+  };
+  return 0;
+}
+
+int run_sweep(struct measuresuite *ms, size_t window, size_t num_offsets) {
+  return sweep_offsets(ms, SWEEP_CODE, window, num_offsets, 1);
+}
+
+int run_data_sweep(struct measuresuite *ms, size_t num_offsets) {
+  // whole qwords, the arguments are uint64_t's
+  return sweep_offsets(ms, SWEEP_DATA, MS_DATA_PAGE_SIZE, num_offsets,
+                       sizeof(uint64_t));
+}
+
+int run_working_set_sweep(struct measuresuite *ms) {
+  struct sweep *sweep = &ms->sweep;
+  sweep->working_set_results.num_levels = 0;
+  size_t num_levels = 0;
+  if (working_set_cache_levels(ms, sweep->levels, &num_levels)) {
+    return 1;
+  }
+  // half of each cache, and memory beyond the last one
+  for (size_t l = 0; l < num_levels; l++) {
+    sweep->levels[l].working_set = sweep->levels[l].cache_size / 2;
+  }
+  sweep->levels[num_levels] = (struct ms_working_set_level){
+      .level = 0,
+      .cache_size = 0,
+      .working_set = 2 * sweep->levels[num_levels - 1].cache_size,
+  };
+  num_levels++;
+
+  // one more, such that nothing is allocated with 0 bytes
+  const size_t num_functions = ms->num_functions + 1;
+  if (realloc_or_fail(ms, (void **)&sweep->cycles_per_call,
+                      num_levels * num_functions * sizeof(double)) ||
+      realloc_or_fail(ms, (void **)&sweep->scratch,
+                      (ms->num_batches + 1) * sizeof(uint64_t))) {
+    return 1;
+  }
+
+  const size_t saved = ms->working_set.bytes;
+  int ret = 0;
+  for (size_t l = 0; l < num_levels; l++) {
+    DEBUG("sweep: measuring with a working set of %lu bytes\n",
+          sweep->levels[l].working_set);
+    ret = working_set_resize(ms, sweep->levels[l].working_set) ||
+          run_measurement(ms);
+    if (ret) {
+      break;
+    }
+    const struct ms_results *res = &ms->results;
+    for (size_t f = 0; f < res->num_functions; f++) {
+      const uint64_t batch = median(res->functions[f].cycles, res->num_batches,
+                                    1, sweep->scratch);
+      sweep->cycles_per_call[l * ms->num_functions + f] =
+          (double)batch / (double)ms->batch_size;
+    }
+  }
+
+  // put it back, also if a measurement failed
+  ERROR_NUMBER errorno = ms->errorno;
+  if (working_set_resize(ms, saved)) {
+    return 1;
+  }
+  if (ret) {
+    ms->errorno = errorno;
+    return 1;
+  }
+
+  sweep->working_set_results = (struct ms_working_set_results){
+      .num_levels = num_levels,
+      .num_functions = ms->num_functions,
+      .levels = sweep->levels,
+      .cycles_per_call = sweep->cycles_per_call,
+  };
+  return 0;
+}
+
+void end_sweep(struct measuresuite *ms) {
+  struct sweep *sweep = &ms->sweep;
+  free(sweep->offsets);
+  free(sweep->medians);
+  free(sweep->functions);
+  free(sweep->saved);
+  free(sweep->scratch);
+  free(sweep->cycles_per_call);
+  memset(sweep, 0, sizeof(*sweep));
+}
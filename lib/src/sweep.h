@@ -0,0 +1,46 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * Runs one measurement per offset with all movable functions placed at it,
+ * see ms_measure_sweep. Batch size and number of batches must be set.
+ * The statistics end up in ms->sweep.results.
+ */
+int run_sweep(struct measuresuite *ms, size_t window, size_t num_offsets);
+
+/**
+ * Runs one measurement per distance of the outputs from the inputs, see
+ * ms_measure_data_sweep. Batch size and number of batches must be set.
+ * The statistics end up in ms->sweep.results.
+ */
+int run_data_sweep(struct measuresuite *ms, size_t num_offsets);
+
+/**
+ * Runs one measurement per level of the cache hierarchy, see
+ * ms_measure_working_set_sweep. Batch size and number of batches must be set.
+ * The statistics end up in ms->sweep.working_set_results.
+ */
+int run_working_set_sweep(struct measuresuite *ms);
+
+void end_sweep(struct measuresuite *ms);
+
+#endif
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+// clock_gettime is not part of strict C17
+#define _POSIX_C_SOURCE 199309L
+
 #include "timer.h"
 #include "assert.h"
 #include "debug.h"
@@ -26,6 +29,7 @@
 #include <sys/syscall.h>      // SYS_perf_event_open
 #include <sys/time.h>
 #include <sys/types.h>
+#include <time.h> // clock_gettime
 #include <unistd.h>
 
 static int get_fdperf(volatile struct perf_event_attr *attr) {
@@ -249,3 +253,11 @@ uint64_t stop_timer(struct measuresuite *ms, uint64_t start) {
 
   return delta;
 }
+
+uint64_t current_timestamp_ns() {
+  struct timespec time = {0};
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  const uint64_t nanoseconds_per_second = 1000000000ULL;
+  return (uint64_t)time.tv_sec * nanoseconds_per_second + time.tv_nsec;
+}
@@ -26,5 +26,7 @@ void start_timer(struct measuresuite *ms, uint64_t *start);
 uint64_t stop_timer(struct measuresuite *ms, uint64_t start);
 
 uint64_t current_timestamp();
+// monotonic, in nanoseconds
+uint64_t current_timestamp_ns();
 
 #endif
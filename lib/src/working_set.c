@@ -0,0 +1,169 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "working_set.h"
+#include "debug.h"       // DEBUG
+#include "error/error.h" // ERROR_NUMBER
+#include "memory.h"      // memory_{map,unmap}
+#include "randomizer.h"  // get_random_qword
+#include <errno.h>       // errno
+#include <stdio.h>       // fopen / fscanf
+#include <string.h>      // strerror / strcmp
+
+// bytes each argument set starts at a multiple of, so no two share a line
+#define WORKING_SET_ALIGNMENT 64
+
+static const char cache_dir[] = {"/sys/devices/system/cpu/cpu0/cache"};
+
+// @returns the next number of the generator (splitmix64). Filling hundreds of
+// MiB from /dev/urandom before each measurement would take seconds.
+static uint64_t next_random(struct working_set *ws) {
+  uint64_t z = (ws->state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+int working_set_resize(struct measuresuite *ms, size_t bytes) {
+  struct working_set *ws = &ms->working_set;
+  if (memory_unmap(ms, ws->pool, ws->len)) {
+    return 1;
+  }
+  ws->pool = NULL;
+  ws->len = 0;
+  ws->bytes = 0;
+  ws->num_sets = 0;
+  if (bytes == 0) {
+    return 0;
+  }
+
+  const size_t set_bytes =
+      ms->arg_width * (ms->num_arg_in + ms->num_arg_out) * sizeof(uint64_t);
+  const size_t set_size = (set_bytes + WORKING_SET_ALIGNMENT - 1) /
+                          WORKING_SET_ALIGNMENT * WORKING_SET_ALIGNMENT;
+  if (bytes < set_size) {
+    ms->errorno = E_INVALID_INPUT__WORKING_SET;
+    return 1;
+  }
+  size_t len = bytes / set_size * set_size;
+  if (memory_map(ms, &len, 0, (void **)&ws->pool)) {
+    return 1;
+  }
+  ws->len = len;
+  ws->bytes = bytes;
+  ws->set_size = set_size / sizeof(uint64_t);
+  ws->num_sets = bytes / set_size;
+  DEBUG("working set: %lu sets of %lu bytes at %p\n", ws->num_sets, set_size,
+        (void *)ws->pool);
+  return 0;
+}
+
+int end_working_set(struct measuresuite *ms) {
+  return working_set_resize(ms, 0);
+}
+
+int working_set_begin(struct measuresuite *ms) {
+  struct working_set *ws = &ms->working_set;
+  ws->next = 0;
+  if (ws->num_sets == 0) {
+    return 0;
+  }
+  if (get_random_qword(ms, &ws->state)) {
+    return 1;
+  }
+  const size_t num_in = ms->arg_width * ms->num_arg_in;
+  for (size_t s = 0; s < ws->num_sets; s++) {
+    uint64_t *in = ws->pool + s * ws->set_size;
+    for (size_t i = 0; i < num_in; i++) {
+      in[i] = next_random(ws);
+      if (ms->bounds != NULL) {
+        in[i] &= ms->bounds[i % ms->arg_width];
+      }
+    }
+  }
+  return 0;
+}
+
+// reads "<number>" or "<number>K" (or M, G) from @param path into @param value
+static int read_size(const char *path, size_t *value) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return 1;
+  }
+  char unit = '\0';
+  const int read = fscanf(file, "%lu%c", value, &unit);
+  fclose(file);
+  if (read < 1) {
+    return 1;
+  }
+  const char *units = "KMG";
+  for (size_t i = 0; units[i] != '\0'; i++) {
+    if (unit == units[i]) {
+      *value <<= 10 * (i + 1);
+    }
+  }
+  return 0;
+}
+
+int working_set_cache_levels(struct measuresuite *ms,
+                             struct ms_working_set_level *levels,
+                             size_t *num_levels) {
+  *num_levels = 0;
+  char path[128] = {0};
+  for (int index = 0;; index++) {
+    snprintf(path, sizeof(path), "%s/index%d/type", cache_dir, index);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+      break; // no more caches
+    }
+    char type[32] = {0};
+    const int read = fscanf(file, "%31s", type);
+    fclose(file);
+    if (read != 1 || strcmp(type, "Instruction") == 0) {
+      continue;
+    }
+
+    size_t level = 0;
+    size_t size = 0;
+    snprintf(path, sizeof(path), "%s/index%d/level", cache_dir, index);
+    if (read_size(path, &level)) {
+      break;
+    }
+    snprintf(path, sizeof(path), "%s/index%d/size", cache_dir, index);
+    if (read_size(path, &size)) {
+      break;
+    }
+    if (*num_levels == MS_MAX_CACHE_LEVELS - 1) {
+      continue;
+    }
+    // keep them sorted by level, whatever order the indices are in
+    size_t i = (*num_levels)++;
+    for (; i > 0 && levels[i - 1].level > (int)level; i--) {
+      levels[i] = levels[i - 1];
+    }
+    levels[i] = (struct ms_working_set_level){
+        .level = (int)level,
+        .cache_size = size,
+    };
+  }
+
+  if (*num_levels == 0) {
+    ms->errorno = E_INTERNAL_MEASURE__AI__CACHE_INFO;
+    ms->additional_info = strerror(errno);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WORKING_SET_H
+#define WORKING_SET_H
+
+#include "struct_measuresuite.h"
+#include <stddef.h>
+
+/**
+ * Maps a pool of as many argument sets as fit into @param bytes, see
+ * ms_set_working_set. 0 unmaps it.
+ */
+int working_set_resize(struct measuresuite *ms, size_t bytes);
+int end_working_set(struct measuresuite *ms);
+
+/**
+ * Fills the inputs of the pool with fresh random data, masked with the bounds,
+ * and starts striding at its first set. Called before each measurement.
+ */
+int working_set_begin(struct measuresuite *ms);
+
+/**
+ * Reads the data and unified caches of cpu0 from sysfs, by level. Sets the
+ * level and cache_size of at most MS_MAX_CACHE_LEVELS - 1 of @param levels,
+ * and @param num_levels to how many.
+ */
+int working_set_cache_levels(struct measuresuite *ms,
+                             struct ms_working_set_level *levels,
+                             size_t *num_levels);
+
+#endif
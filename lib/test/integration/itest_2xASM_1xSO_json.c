@@ -64,8 +64,8 @@ static int test_measure_load_check_ok() {
   assert_string_in_json(ms, "\"incorrect\":0,\"timer\":\"");
   assert_string_in_json(ms, "},\"functions\":["
                             "{\"type\":\"SHARED_OBJECT\"},"
-                            "{\"type\":\"ASM\", \"chunks\":0},"
-                            "{\"type\":\"ASM\", \"chunks\":0}"
+                            "{\"type\":\"ASM\", \"chunks\":0,\"codeSize\":10},"
+                            "{\"type\":\"ASM\", \"chunks\":0,\"codeSize\":10}"
                             "],\"cycles\":[[");
 
   ms_assert_ok(ms_terminate(ms));
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+// mov qword [rdi], 0; then as add_two_bin. Different only if out1 == arg1.
+static const uint8_t clear_then_add_two_bin[] = {
+    0x48, 0xc7, 0x07, 0x00, 0x00, 0x00, 0x00, 0x48, 0x8b, 0x06,
+    0x48, 0x03, 0x02, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+
+static int test_aliasing_invalid() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 2, 2));
+
+  const int out_of_range[] = {2, MS_ALIAS_NONE};
+  ms_assert(ms_set_aliasing(ms, out_of_range) == 1);
+  const int negative[] = {-2, MS_ALIAS_NONE};
+  ms_assert(ms_set_aliasing(ms, negative) == 1);
+  const int twice[] = {1, 1};
+  ms_assert(ms_set_aliasing(ms, twice) == 1);
+
+  const int both[] = {1, 0};
+  ms_assert_ok(ms_set_aliasing(ms, both));
+  ms_assert_ok(ms_set_aliasing(ms, NULL));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// measures add_two_bin and clear_then_add_two_bin with out1 aliasing
+// @param alias, @returns 0 if the result of checking is @param incorrect
+static int test_clear_then_add(int alias, size_t incorrect) {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 2, 1));
+  ms_set_checking(ms, 1);
+
+  int id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+  id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, clear_then_add_two_bin,
+                            sizeof(clear_then_add_two_bin), NULL, &id));
+
+  const int aliases[] = {alias};
+  ms_assert_ok(ms_set_aliasing(ms, aliases));
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == incorrect);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_aliasing_checked() {
+  int res = 0;
+  // separate outputs: both add
+  res |= test_clear_then_add(MS_ALIAS_NONE, 0);
+  // out1 == arg1 or arg2: clearing it clears an input
+  res |= test_clear_then_add(0, 1);
+  res |= test_clear_then_add(1, 1);
+  return res;
+}
+
+static int test_aliasing_in_place() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 3, 3));
+  ms_set_checking(ms, 1);
+
+  // out1 == arg3 and out3 == arg1, out2 separate
+  const int aliases[] = {2, MS_ALIAS_NONE, 0};
+  ms_assert_ok(ms_set_aliasing(ms, aliases));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "six_param_add1", &id));
+  id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "six_param_add1", &id));
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->num_functions == 2);
+  ms_assert(res->incorrect == 0);
+  for (size_t f = 0; f < res->num_functions; f++) {
+    for (int b = 0; b < number_of_batches; b++) {
+      ms_assert(res->functions[f].cycles[b] > 0);
+    }
+  }
+
+  // with randomized data, too
+  ms_assert_ok(ms_set_layout_randomization(ms, 0, 256, 0));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_aliasing_invalid();
+  res |= test_aliasing_checked();
+  res |= test_aliasing_in_place();
+  return res;
+}
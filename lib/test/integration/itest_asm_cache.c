@@ -0,0 +1,141 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char file_shared_object[] = {"./test_data/add_two_numbers.so"};
+static const char symbol[] = {"add_two_numbers"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 10;
+
+static const char add_a[] = {"mov rax, [rsi]\n"
+                             "add rax, [rdx]\n"
+                             "mov [rdi], rax\n"
+                             "ret\n"};
+static const char add_b[] = {"mov rax, [rdx]\n"
+                             "add rax, [rsi]\n"
+                             "mov [rdi], rax\n"
+                             "ret\n"};
+static const char add_c[] = {"mov rcx, [rsi]\n"
+                             "add rcx, [rdx]\n"
+                             "mov [rdi], rcx\n"
+                             "ret\n"};
+
+static int load(measuresuite_t ms, const char *text, int *id) {
+  return ms_load_data(ms, ASM, (const uint8_t *)text, strlen(text), NULL, id);
+}
+
+#define assert_stats(exp_hits, exp_misses)                                     \
+  do {                                                                         \
+    uint64_t hits = 0;                                                         \
+    uint64_t misses = 0;                                                       \
+    ms_get_asm_cache_stats(ms, &hits, &misses);                                \
+    ms_assert(hits == (exp_hits));                                             \
+    ms_assert(misses == (exp_misses));                                         \
+  } while (0)
+
+static int test_hit_miss_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(ms_set_asm_cache_size(ms, 2));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object, symbol,
+                            &id));
+
+  int ids[4] = {-1, -1, -1, -1};
+  ms_assert_ok(load(ms, add_a, &ids[0]));
+  assert_stats(0, 1);
+  ms_assert_ok(load(ms, add_a, &ids[1]));
+  assert_stats(1, 1);
+  ms_assert_ok(load(ms, add_b, &ids[2]));
+  assert_stats(1, 2);
+
+  // the cached code must compute the same
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // c evicts a (least recently used), b stays
+  ms_assert_ok(load(ms, add_c, &ids[3]));
+  assert_stats(1, 3);
+  ms_assert_ok(ms_replace_code(ms, ids[3], ASM, (const uint8_t *)add_b,
+                               strlen(add_b)));
+  assert_stats(2, 3);
+  ms_assert_ok(ms_replace_code(ms, ids[0], ASM, (const uint8_t *)add_a,
+                               strlen(add_a)));
+  assert_stats(2, 4);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_chunk_size_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_asm_cache_size(ms, 16));
+
+  int id = -1;
+  ms_assert_ok(load(ms, add_a, &id));
+  // a different chunk size is a different key
+  ms_assert_ok(ms_set_chunk_size(ms, 16));
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(0, 2);
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(1, 2);
+
+  // resizing drops everything
+  ms_assert_ok(ms_set_asm_cache_size(ms, 4));
+  assert_stats(0, 0);
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(0, 1);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_disabled_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert_ok(load(ms, add_a, &id));
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(0, 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+#if USE_ASSEMBLYLINE
+  int res = 0;
+  res |= test_hit_miss_ok();
+  res |= test_chunk_size_ok();
+  res |= test_disabled_ok();
+  return res;
+#else
+  return SKIP;
+#endif
+}
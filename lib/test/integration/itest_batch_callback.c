@@ -0,0 +1,161 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 2;
+static const int number_of_batches = 10;
+
+static const uint8_t code[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+#define NUM_FUNCTIONS 3
+
+// what the callback has seen
+struct seen {
+  size_t calls;
+  size_t stop_after; // 0 to never stop
+  uint64_t samples[20][NUM_FUNCTIONS];
+};
+
+static enum ms_batch_callback_result record(void *ctx, size_t batch,
+                                            const uint64_t *cycles,
+                                            size_t num_functions) {
+  struct seen *seen = ctx;
+  if (batch != seen->calls || num_functions != NUM_FUNCTIONS) {
+    abort();
+  }
+  memcpy(seen->samples[batch], cycles, num_functions * sizeof(uint64_t));
+  seen->calls++;
+  return seen->calls == seen->stop_after ? MS_BATCH_STOP : MS_BATCH_CONTINUE;
+}
+
+static measuresuite_t load_three() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  for (int i = 0; i < NUM_FUNCTIONS; i++) {
+    int id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+  }
+  return ms;
+}
+
+// the samples passed are the ones in the results
+static void assert_seen_in_results(measuresuite_t ms, const struct seen *seen) {
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->num_batches == seen->calls);
+  for (size_t b = 0; b < seen->calls; b++) {
+    for (size_t f = 0; f < NUM_FUNCTIONS; f++) {
+      ms_assert(res->functions[f].cycles[b] == seen->samples[b][f]);
+    }
+  }
+}
+
+static int test_all_batches_ok() {
+  measuresuite_t ms = load_three();
+  struct seen seen = {0};
+  ms_set_batch_callback(ms, record, &seen);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert(seen.calls == (size_t)number_of_batches);
+  assert_seen_in_results(ms, &seen);
+
+  // disabled again
+  ms_set_batch_callback(ms, NULL, NULL);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert(seen.calls == (size_t)number_of_batches);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_stop_early_ok() {
+  measuresuite_t ms = load_three();
+  struct seen seen = {.stop_after = 4};
+  ms_set_batch_callback(ms, record, &seen);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert(seen.calls == 4);
+  assert_seen_in_results(ms, &seen);
+
+  // the cycles are compacted to the batches run
+  assert_string_in_json(ms, "\"numFunctions\":3");
+  uint64_t *cycles = NULL;
+  size_t num_f = 0;
+  size_t num_b = 0;
+  ms_assert_ok(ms_take_cycles(ms, &cycles, &num_f, &num_b));
+  ms_assert(num_f == NUM_FUNCTIONS);
+  ms_assert(num_b == 4);
+  for (size_t f = 0; f < num_f; f++) {
+    for (size_t b = 0; b < num_b; b++) {
+      ms_assert(cycles[f * num_b + b] == seen.samples[b][f]);
+    }
+  }
+  free(cycles);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// stopped measurements are not cached, cached functions report cached samples
+static int test_result_cache_ok() {
+  measuresuite_t ms = load_three();
+  ms_assert_ok(ms_set_result_cache(ms, 8, 0));
+  struct seen seen = {.stop_after = 2};
+  ms_set_batch_callback(ms, record, &seen);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  ms_get_result_cache_stats(ms, &hits, &misses);
+  ms_assert(hits == 0 && misses == NUM_FUNCTIONS);
+
+  // not stored, hence missed again. Now stored
+  seen = (struct seen){0};
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_get_result_cache_stats(ms, &hits, &misses);
+  ms_assert(hits == 0 && misses == 2 * NUM_FUNCTIONS);
+
+  // all hits. Nothing is run, hence no batches are reported
+  seen = (struct seen){0};
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_get_result_cache_stats(ms, &hits, &misses);
+  ms_assert(hits == NUM_FUNCTIONS);
+  ms_assert(seen.calls == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_all_batches_ok();
+  res |= test_stop_early_ok();
+  res |= test_result_cache_ok();
+  return res;
+}
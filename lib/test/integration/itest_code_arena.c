@@ -0,0 +1,112 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 2;
+static const int number_of_batches = 10;
+
+static const uint8_t code[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+// load-measure-unload many times, slots should be recycled
+static int test_churn_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const int rounds = 100;
+  const int num_functions = 50;
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < num_functions; i++) {
+      int id = -1;
+      ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+      ms_assert(id == i);
+    }
+    ms_assert_ok(ms_measure(ms, batch_size, 1));
+    ms_assert_ok(ms_unload_all(ms));
+  }
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// code larger than the first chunk, and larger than the largest size class
+static int test_large_code_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const uint8_t nop = 0x90;
+  const size_t sizes[] = {(size_t)1 << 20, (size_t)3 << 20};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    // nop sled followed by the actual function
+    uint8_t *large = malloc(sizes[i]);
+    ms_assert(large != NULL);
+    memset(large, nop, sizes[i]);
+    memcpy(large + sizes[i] - sizeof(code), code, sizeof(code));
+
+    int id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, large, sizes[i], NULL, &id));
+    free(large);
+  }
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// re-using an id with more code than fits into its slot
+static int test_grow_slot_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+  ms_assert(id == 0);
+
+  const size_t size = 4096;
+  uint8_t *larger = malloc(size);
+  ms_assert(larger != NULL);
+  memset(larger, 0x90, size);
+  memcpy(larger + size - sizeof(code), code, sizeof(code));
+
+  ms_assert_ok(ms_load_data(ms, BIN, larger, size, NULL, &id));
+  ms_assert(id == 0); // should not have changed
+  free(larger);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_churn_ok();
+  res |= test_large_code_ok();
+  res |= test_grow_slot_ok();
+  return res;
+}
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const int arg_width = 4;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+// more than fit into the first mapping of the inputs and outputs
+static const int number_of_functions = 20;
+static const size_t number_of_offsets = 8;
+
+static int test_data_offsets_invalid() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  // not whole qwords, not in a page, only one of them compact
+  ms_assert(ms_set_data_offsets(ms, 4, 0) == 1);
+  ms_assert(ms_set_data_offsets(ms, 0, MS_DATA_PAGE_SIZE) == 1);
+  ms_assert(ms_set_data_offsets(ms, MS_DATA_OFFSET_COMPACT, 8) == 1);
+
+  const struct ms_sweep_results *sweep = NULL;
+  ms_assert(ms_measure_data_sweep(ms, batch_size, number_of_batches, 0,
+                                  &sweep) == 1);
+  ms_assert(ms_measure_data_sweep(ms, batch_size, number_of_batches,
+                                  MS_DATA_PAGE_SIZE / 8 + 1, &sweep) == 1);
+
+  // the data is copied elsewhere while it is randomized
+  ms_assert_ok(ms_set_layout_randomization(ms, 0, 256, 0));
+  ms_assert(ms_measure_data_sweep(ms, batch_size, number_of_batches,
+                                  number_of_offsets, &sweep) == 1);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_data_offsets() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  // outputs on the same page offset as the inputs
+  ms_assert_ok(ms_set_data_offsets(ms, 8, 8));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &id));
+  for (int i = 1; i < number_of_functions; i++) {
+    id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                              &id));
+  }
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->num_functions == (size_t)number_of_functions);
+  ms_assert(res->incorrect == 0);
+
+  const struct ms_sweep_results *sweep = NULL;
+  ms_assert_ok(ms_measure_data_sweep(ms, batch_size, number_of_batches,
+                                     number_of_offsets, &sweep));
+  ms_assert(sweep->window == MS_DATA_PAGE_SIZE);
+  ms_assert(sweep->num_offsets == number_of_offsets);
+  ms_assert(sweep->num_functions == (size_t)number_of_functions);
+  for (size_t i = 0; i < number_of_offsets; i++) {
+    ms_assert(sweep->offsets[i] == i * MS_DATA_PAGE_SIZE / number_of_offsets);
+  }
+  for (int f = 0; f < number_of_functions; f++) {
+    ms_assert(sweep->functions[f].moved == 1);
+    ms_assert(sweep->functions[f].min <= sweep->functions[f].median &&
+              sweep->functions[f].median <= sweep->functions[f].max);
+    ms_assert(sweep->functions[f].best < number_of_offsets);
+  }
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  // odd distances are rounded down to whole qwords
+  ms_assert_ok(ms_measure_data_sweep(ms, batch_size, number_of_batches, 3,
+                                     &sweep));
+  ms_assert(sweep->offsets[1] == MS_DATA_PAGE_SIZE / 3 / 8 * 8);
+
+  // the outputs are still where they were, and back to compact
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert_ok(ms_set_data_offsets(ms, MS_DATA_OFFSET_COMPACT,
+                                   MS_DATA_OFFSET_COMPACT));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// a mapping failing leaves the inputs and outputs where they were
+static int test_data_offsets_no_memory() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &id));
+  id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+
+  // no new mappings for a moment
+  struct rlimit limit;
+  ms_assert(getrlimit(RLIMIT_AS, &limit) == 0);
+  const rlim_t soft = limit.rlim_cur;
+  limit.rlim_cur = 0;
+  ms_assert(setrlimit(RLIMIT_AS, &limit) == 0);
+  const int ret = ms_set_data_offsets(ms, 8, 8);
+  limit.rlim_cur = soft;
+  ms_assert(setrlimit(RLIMIT_AS, &limit) == 0);
+  ms_assert(ret == 1);
+
+  // the arena still grows and measures as it is laid out
+  for (int i = 2; i < number_of_functions; i++) {
+    id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                              &id));
+  }
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert_ok(ms_set_data_offsets(ms, 8, 8));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_data_offsets_invalid();
+  res |= test_data_offsets();
+  res |= test_data_offsets_no_memory();
+  return res;
+}
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char file_reference[] = {"./test_data/add_two_numbers.o"};
+static const char file_aligned[] = {"./test_data/aligned.o"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+
+// the functions of aligned.o only add correctly (or at all, with pxor) if
+// their .rodata keeps its alignment of 16, 32 and 128 bytes
+static const char *symbols[] = {"add_aligned16", "add_aligned32",
+                                "add_aligned128"};
+static const size_t alignments[] = {16, 32, 128};
+#define NUM_ALIGNED 3
+
+// loads add_two_numbers to check against, then the aligned functions
+static int load_aligned(measuresuite_t ms) {
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, ELF, file_reference, "add_two_numbers", &id));
+  for (size_t i = 0; i < NUM_ALIGNED; i++) {
+    id = -1;
+    ms_assert_ok(ms_load_file(ms, ELF, file_aligned, symbols[i], &id));
+    ms_assert(id == (int)i + 1);
+  }
+  return 0;
+}
+
+// the image starts at a multiple of its largest section alignment, also
+// beyond the cache line its slot starts at
+static int test_alignment_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(load_aligned(ms));
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  for (size_t i = 0; i < NUM_ALIGNED; i++) {
+    ms_assert(res->functions[i + 1].page_offset % alignments[i] == 0);
+  }
+
+  // reloading keeps it aligned, also when the slot has to grow
+  for (int i = 0; i < 4; i++) {
+    int id = 3;
+    ms_assert_ok(ms_load_file(ms, ELF, file_aligned, symbols[i % 3], &id));
+    ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+    ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+    ms_assert(res->incorrect == 0);
+    ms_assert(res->functions[3].page_offset % alignments[i % 3] == 0);
+  }
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// placements keep the alignment, or are refused
+static int test_placement() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(load_aligned(ms));
+
+  // pxor would fault at byte 5 of a cache line
+  ms_assert(ms_set_placement(ms, 1, 64, 5) == 1);
+  ms_assert(ms_set_placement(ms, 2, 4096, 16) == 1);
+  ms_assert(ms_set_placement(ms, 3, 4096, 64) == 1);
+  ms_assert_ok(ms_set_placement(ms, 1, 64, 16));
+  ms_assert_ok(ms_set_placement(ms, 2, 4096, 96));
+  ms_assert_ok(ms_set_placement(ms, 3, 4096, 384));
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[1].page_offset % 64 == 16);
+  ms_assert(res->functions[2].page_offset == 96);
+  ms_assert(res->functions[3].page_offset == 384);
+
+  // nor can it be loaded where the placement would misalign it
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, ELF, file_reference, "add_two_numbers", &id));
+  ms_assert_ok(ms_set_placement(ms, id, 64, 5));
+  ms_assert(ms_load_file(ms, ELF, file_aligned, symbols[0], &id) == 1);
+  ms_assert_ok(ms_set_placement(ms, id, 64, 48));
+  ms_assert_ok(ms_load_file(ms, ELF, file_aligned, symbols[0], &id));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// a sweep over byte offsets leaves the aligned functions in place
+static int test_sweep() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(load_aligned(ms));
+
+  const struct ms_sweep_results *sweep = NULL;
+  ms_assert_ok(ms_measure_sweep(ms, batch_size, number_of_batches, 64, 8,
+                                &sweep));
+  ms_assert(sweep->functions[0].moved);
+  for (size_t i = 0; i < NUM_ALIGNED; i++) {
+    ms_assert(!sweep->functions[i + 1].moved);
+  }
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// randomized layouts move the aligned functions, too, by their alignment
+static int test_layout() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(load_aligned(ms));
+  ms_assert_ok(
+      ms_set_layout_randomization(ms, 4096, 0, MS_LAYOUT_REQUIRE_MOVABLE));
+
+  const struct ms_results *res = NULL;
+  for (int i = 0; i < 4; i++) {
+    ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+    ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+    ms_assert(res->incorrect == 0);
+  }
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_alignment_ok();
+  res |= test_placement();
+  res |= test_sweep();
+  res |= test_layout();
+  return res;
+}
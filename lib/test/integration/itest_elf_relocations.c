@@ -0,0 +1,87 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char file_reference[] = {"./test_data/add_two_numbers.o"};
+static const char file_elf[] = {"./test_data/relocations.o"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+// .rodata, .data, .data.rel and .bss of relocations.o
+static const size_t data_size = 64 + 64 + 8 + 8;
+
+// add_with_tables only adds correctly if its tables and callee are linked
+static int test_relocate_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int id = -1;
+  ms_assert_ok(
+      ms_load_file(ms, ELF, file_reference, "add_two_numbers", &id));
+  id = -1;
+  ms_assert_ok(ms_load_file(ms, ELF, file_elf, "add_with_tables", &id));
+  ms_assert(id == 1);
+
+  // again, in place and through a handle
+  ms_elf_t elf = NULL;
+  ms_assert_ok(ms_elf_open(ms, file_elf, &elf));
+  const char *symbols[] = {"add_with_tables", "add_with_tables"};
+  int ids[] = {1, -1};
+  ms_assert_ok(ms_load_elf_symbols(ms, elf, 2, symbols, ids));
+  ms_assert(ids[0] == 1 && ids[1] == 2);
+  ms_assert_ok(ms_elf_close(ms, elf));
+
+  // the checker compares them with add_two_numbers
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->functions[1].code_size > data_size);
+  ms_assert(res->functions[2].code_size == res->functions[1].code_size);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_undefined_reference_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert(ms_load_file(ms, ELF, file_elf, "add_external", &id) == 1);
+  ms_assert(id == -1);
+
+  // nothing was loaded
+  ms_assert(ms_unload_last(ms) == 1);
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_relocate_ok();
+  res |= test_undefined_reference_fail();
+  return res;
+}
@@ -0,0 +1,175 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char file_shared_object[] = {"./test_data/add_two_numbers.so"};
+static const char symbol[] = {"add_two_numbers"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 10;
+static const size_t num_lines = 64;
+
+static const char add_a[] = {"mov rax, [rsi]\n"
+                             "add rax, [rdx]\n"
+                             "mov [rdi], rax\n"
+                             "ret\n"};
+// differs from add_a in the first two lines
+static const char add_b[] = {"mov rax, [rdx]  ; comment\n"
+                             "  add rax, [rsi]\n"
+                             "mov [rdi], rax\n"
+                             "\n"
+                             "ret\n"};
+// forward and backward branches, conditional and unconditional
+static const char add_branches[] = {"mov rax, [rsi]\n"
+                                    "jmp skip\n"
+                                    "mov rax, 0\n"
+                                    "skip:\n"
+                                    "add rax, [rdx]\n"
+                                    "mov rcx, 3\n"
+                                    "again: dec rcx\n"
+                                    "jnz again\n"
+                                    "test rax, rax\n"
+                                    "JZ done\n"
+                                    "nop\n"
+                                    "done:\n"
+                                    "mov [rdi], rax\n"
+                                    "ret\n"};
+
+static int load(measuresuite_t ms, const char *text, int *id) {
+  return ms_load_data(ms, ASM, (const uint8_t *)text, strlen(text), NULL, id);
+}
+
+#define assert_stats(exp_hits, exp_misses)                                     \
+  do {                                                                         \
+    uint64_t hits = 0;                                                         \
+    uint64_t misses = 0;                                                       \
+    ms_get_incremental_assembly_stats(ms, &hits, &misses);                     \
+    ms_assert(hits == (exp_hits));                                             \
+    ms_assert(misses == (exp_misses));                                         \
+  } while (0)
+
+static int test_memo_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(ms_set_incremental_assembly(ms, num_lines));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object, symbol,
+                            &id));
+
+  id = -1;
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(0, 4);
+  ms_assert_ok(
+      ms_replace_code(ms, id, ASM, (const uint8_t *)add_b, strlen(add_b)));
+  assert_stats(2, 6);
+
+  uint64_t ns = 0;
+  ms_assert_ok(ms_get_assembly_time(ms, id, &ns));
+  ms_assert(ns > 0);
+  ms_assert(ms_get_assembly_time(ms, id + 1, &ns) == 1);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_branches_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(ms_set_incremental_assembly(ms, num_lines));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object, symbol,
+                            &id));
+
+  // twice, the second time from the memo only
+  for (int i = 0; i < 2; i++) {
+    id = -1;
+    ms_assert_ok(load(ms, add_branches, &id));
+  }
+  // 12 lines with an instruction, 3 of which are branches
+  assert_stats(9, 9);
+
+  // the fixed up branches must compute the same as the SO
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_chunk_size_falls_back_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_incremental_assembly(ms, num_lines));
+  ms_assert_ok(ms_set_chunk_size(ms, 16));
+
+  int id = -1;
+  ms_assert_ok(load(ms, add_a, &id));
+  assert_stats(0, 0);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "{\"type\":\"ASM\", \"chunks\":0,\"codeSize\":10}");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_not_in_asm_cache_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_asm_cache_size(ms, 4));
+  ms_assert_ok(ms_set_incremental_assembly(ms, num_lines));
+
+  int id = -1;
+  ms_assert_ok(load(ms, add_branches, &id));
+  ms_assert_ok(ms_set_incremental_assembly(ms, 0));
+  id = -1;
+  ms_assert_ok(load(ms, add_branches, &id));
+
+  // the rel32 branches of the first must not be taken for those of AL
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  ms_get_asm_cache_stats(ms, &hits, &misses);
+  ms_assert(hits == 0);
+  ms_assert(misses == 2);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+#if USE_ASSEMBLYLINE
+  int res = 0;
+  res |= test_memo_ok();
+  res |= test_branches_ok();
+  res |= test_chunk_size_falls_back_ok();
+  res |= test_not_in_asm_cache_ok();
+  return res;
+#else
+  return SKIP;
+#endif
+}
@@ -51,7 +51,7 @@ static int test_measure_long_json_ok() {
   assert_string_in_json(ms, "{\"stats\":{\"numFunctions\":1,\"runtime\":");
   assert_string_in_json(ms, "\"incorrect\":0,\"timer\":");
   assert_string_in_json(ms, "},\"functions\":[{\"type\":\"ASM\","
-                            " \"chunks\":0}],\"cycles\":[[");
+                            " \"chunks\":0,\"codeSize\":10}],\"cycles\":[[");
 
   ms_assert_ok(ms_terminate(ms));
 
@@ -86,7 +86,8 @@ static int test_measure_two_ok() {
   assert_string_in_json(ms, "\"incorrect\":0,\"timer\":\"");
   assert_string_in_json(
       ms, "},\"functions\":[{\"type\":\"ASM\", "
-          "\"chunks\":0},{\"type\":\"SHARED_OBJECT\"}],\"cycles\":[[");
+          "\"chunks\":0,\"codeSize\":10},{\"type\":\"SHARED_OBJECT\"}],"
+          "\"cycles\":[[");
 
   ms_assert_ok(ms_terminate(ms));
 
@@ -0,0 +1,153 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+// lea rax, [rip]; and eax, 63; mov [rdi], rax; ret
+// writes where in its cache line the code is
+static const uint8_t own_line_offset_bin[] = {
+    0x48, 0x8d, 0x05, 0x00, 0x00, 0x00, 0x00, 0x83,
+    0xe0, 0x3f, 0x48, 0x89, 0x07, 0xc3};
+// mov rax, rsi; or rax, rdi; and eax, 63; mov [rdi], rax; ret
+// writes 0 if the inputs and outputs start at cache lines
+static const uint8_t data_line_offset_bin[] = {
+    0x48, 0x89, 0xf0, 0x48, 0x09, 0xf8, 0x83,
+    0xe0, 0x3f, 0x48, 0x89, 0x07, 0xc3};
+// xor eax, eax; mov [rdi], rax; ret
+static const uint8_t zero_bin[] = {0x31, 0xc0, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 20;
+
+static int test_layout_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int ids[] = {-1, -1, -1};
+  ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                            &ids[0]));
+  ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                            &ids[1]));
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &ids[2]));
+  ms_assert_ok(ms_set_placement(ms, ids[1], 64, 5));
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_set_layout_randomization(ms, 256, 4096, 0));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->num_batches == (size_t)number_of_batches);
+  // the placements are back
+  ms_assert(res->functions[0].page_offset % 64 == 0);
+  ms_assert(res->functions[1].page_offset % 64 == 5);
+
+  // the shared object cannot move
+  ms_assert_ok(ms_set_layout_randomization(ms, 256, 0,
+                                           MS_LAYOUT_REQUIRE_MOVABLE));
+  ms_assert(ms_measure(ms, batch_size, number_of_batches) == 1);
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[1].page_offset % 64 == 5);
+
+  // no sweeping while the code moves anyway
+  const struct ms_sweep_results *sweep = NULL;
+  ms_assert(ms_measure_sweep(ms, batch_size, number_of_batches, 64, 4,
+                             &sweep) == 1);
+  ms_assert_ok(ms_set_layout_randomization(ms, 0, 64, 0));
+  ms_assert_ok(ms_measure_sweep(ms, batch_size, number_of_batches, 64, 4,
+                                &sweep));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_layout_moves() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int ids[] = {-1, -1};
+  for (int i = 0; i < 2; i++) {
+    ms_assert_ok(ms_load_data(ms, BIN, own_line_offset_bin,
+                              sizeof(own_line_offset_bin), NULL, &ids[i]));
+  }
+
+  // both at the start of their slot, they calculate the same
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  // at random offsets, they do not (but for a chance of 64^-20)
+  ms_assert_ok(ms_set_layout_randomization(ms, 64, 0, 0));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 1);
+  ms_assert_ok(ms_unload_all(ms));
+
+  // the data moves by cache lines
+  ids[0] = ids[1] = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, data_line_offset_bin,
+                            sizeof(data_line_offset_bin), NULL, &ids[0]));
+  ms_assert_ok(
+      ms_load_data(ms, BIN, zero_bin, sizeof(zero_bin), NULL, &ids[1]));
+  ms_assert_ok(ms_set_layout_randomization(ms, 0, 4096, 0));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_layout_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  ms_assert(ms_set_layout_randomization(ms, 3, 0, 0) == 1);
+  ms_assert(ms_set_layout_randomization(ms, 8192, 0, 0) == 1);
+  ms_assert(ms_set_layout_randomization(ms, 0, 32, 0) == 1);
+  ms_assert(ms_set_layout_randomization(ms, 0, 96, 0) == 1);
+  ms_assert(ms_set_layout_randomization(ms, 0, 8192, 0) == 1);
+  ms_assert_ok(ms_set_layout_randomization(ms, 0, 0, 0));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_layout_ok();
+  res |= test_layout_moves();
+  res |= test_layout_fail();
+  return res;
+}
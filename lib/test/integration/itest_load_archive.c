@@ -0,0 +1,122 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// add_two_numbers.o, three_functions.o and relocations.o
+static const char file_archive[] = {"./test_data/candidates.a"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+
+// one symbol per member, from short and long (GNU) member names
+static int test_load_symbol_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  ms_assert_ok(
+      ms_load_archive(ms, file_archive, "add_first", &first_id, &num_loaded));
+  ms_assert(first_id == 0 && num_loaded == 1);
+  ms_assert_ok(ms_load_archive(ms, file_archive, "add_with_tables", &first_id,
+                               &num_loaded));
+  ms_assert(first_id == 1 && num_loaded == 1);
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(strcmp(res->functions[0].member, "three_functions.o") == 0);
+  ms_assert(strcmp(res->functions[1].member, "relocations.o") == 0);
+  assert_string_in_json(
+      ms, "{\"type\":\"ELF\",\"codeSize\":10,\"member\":\"three_functions.o\"}");
+
+  // loading something else into it forgets the member
+  ms_assert_ok(ms_replace_code(ms, 0, BIN, (const uint8_t *)"\xc3", 1));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->functions[0].member == NULL);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// all functions of all members, from memory
+static int test_load_all_from_data_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  FILE *file = fopen(file_archive, "rb");
+  ms_assert(file != NULL);
+  uint8_t data[1 << 16];
+  const size_t size = fread(data, 1, sizeof(data), file);
+  fclose(file);
+  ms_assert(size > 0 && size < sizeof(data));
+
+  // add_external of relocations.o cannot be linked, the ones before stay
+  int first_id = -1;
+  size_t num_loaded = 0;
+  ms_assert(ms_load_archive_data(ms, data, size, NULL, &first_id,
+                                 &num_loaded) == 1);
+  ms_assert(first_id == 0);
+  // add_two_numbers and the three of three_functions.o at least
+  ms_assert(num_loaded >= 4);
+  for (size_t i = 0; i < num_loaded; i++) {
+    ms_assert_ok(ms_unload_last(ms));
+  }
+  ms_assert(ms_unload_last(ms) == 1);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_load_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  // not defined in any member
+  ms_assert(ms_load_archive(ms, file_archive, "add_", &first_id,
+                            &num_loaded) == 1);
+  ms_assert(num_loaded == 0);
+  // not an archive
+  ms_assert(ms_load_archive(ms, "./test_data/three_functions.o", NULL,
+                            &first_id, &num_loaded) == 1);
+  ms_assert(ms_load_archive(ms, "./test_data/does_not_exist.a", NULL,
+                            &first_id, &num_loaded) == 1);
+
+  ms_assert(ms_unload_last(ms) == 1);
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_load_symbol_ok();
+  res |= test_load_all_from_data_ok();
+  res |= test_load_fail();
+  return res;
+}
@@ -179,6 +179,52 @@ static int test_load_elf_ok() {
   return 0;
 }
 
+// reads @param filename into @param data, @returns its size or 0
+static size_t read_file(const char *filename, uint8_t *data, size_t size) {
+  FILE *file = fopen(filename, "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  const size_t read = fread(data, 1, size, file);
+  fclose(file);
+  return read < size ? read : 0;
+}
+
+static int test_load_shared_object_ok() {
+  measuresuite_t ms = NULL;
+  static uint8_t lib_add[1 << 16];
+  static uint8_t lib_all[1 << 16];
+  const size_t size_add =
+      read_file("./test_data/add_two_numbers.so", lib_add, sizeof(lib_add));
+  const size_t size_all =
+      read_file("./test_data/liball.so", lib_all, sizeof(lib_all));
+  ms_assert(size_add > 0 && size_all > 0);
+
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int ids[] = {-1, -1, -1};
+  ms_assert_ok(
+      ms_load_data(ms, SHARED_OBJECT, lib_add, size_add, symbol, &ids[0]));
+  // a library of its own, although the memfds share a name
+  ms_assert_ok(
+      ms_load_data(ms, SHARED_OBJECT, lib_all, size_all, symbol, &ids[1]));
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, "./test_data/liball.so",
+                            symbol, &ids[2]));
+  ms_assert(ids[0] == 0 && ids[1] == 1 && ids[2] == 2);
+  ms_assert_ok(ms_measure(ms, 10, 5));
+  assert_string_in_json(ms, "\"incorrect\":0,");
+
+  // replacing closes the first library
+  ms_assert_ok(
+      ms_load_data(ms, SHARED_OBJECT, lib_all, size_all, symbol, &ids[0]));
+  ms_assert(ids[0] == 0);
+  ms_assert_ok(ms_measure(ms, 10, 5));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
 static int test_load_shared_object_fail() {
 
   measuresuite_t ms = NULL;
@@ -191,6 +237,20 @@ static int test_load_shared_object_fail() {
             1);
   ms_assert(id == -1);
 
+  // not a shared object, or no such symbol
+  const uint8_t garbage[] = {0x7f, 'E', 'L', 'F', 0, 0, 0, 0};
+  ms_assert(ms_load_data(ms, SHARED_OBJECT, garbage, sizeof(garbage), symbol,
+                         &id) == 1);
+  static uint8_t lib[1 << 16];
+  const size_t size =
+      read_file("./test_data/add_two_numbers.so", lib, sizeof(lib));
+  ms_assert(size > 0);
+  ms_assert(ms_load_data(ms, SHARED_OBJECT, lib, size, "increment", &id) ==
+            1);
+  ms_assert(ms_load_data(ms, SHARED_OBJECT, lib, size, NULL, &id) == 1);
+  ms_assert(id == -1);
+  ms_assert(ms_unload_last(ms) == 1);
+
   ms_assert_ok(ms_terminate(ms));
 
   return 0;
@@ -203,6 +263,7 @@ int main() {
   res |= test_load_asm_ok();
   res |= test_load_many_asm_ok();
   res |= test_load_bin_ok();
+  res |= test_load_shared_object_ok();
   res |= test_load_shared_object_fail();
   res |= test_load_elf_ok();
   return res;
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char file_elf[] = {"./test_data/three_functions.o"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+// bytes of each function in the file
+static const size_t function_size = 10;
+
+// typed, typed and untyped global functions
+static int test_load_all_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  ms_elf_t elf = NULL;
+  ms_assert_ok(ms_elf_open(ms, file_elf, &elf));
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  ms_assert_ok(ms_load_elf_all(ms, elf, &first_id, &num_loaded));
+  ms_assert(first_id == 0);
+  ms_assert(num_loaded == 3);
+
+  // again, appended
+  ms_assert_ok(ms_load_elf_all(ms, elf, &first_id, &num_loaded));
+  ms_assert(first_id == 3);
+  ms_assert(num_loaded == 3);
+  ms_assert_ok(ms_elf_close(ms, elf));
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // each one is only its own code. Without st_size, up to the next function.
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  for (size_t i = 0; i < res->num_functions; i++) {
+    ms_assert(res->functions[i].code_size == function_size);
+  }
+  assert_string_in_json(ms, "{\"type\":\"ELF\",\"codeSize\":10}");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_load_symbols_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  ms_elf_t elf = NULL;
+  ms_assert_ok(ms_elf_open(ms, file_elf, &elf));
+
+  const char *symbols[] = {"add_second", "add_untyped", "add_first"};
+  int ids[] = {-1, -1, -1};
+  ms_assert_ok(ms_load_elf_symbols(ms, elf, 3, symbols, ids));
+  ms_assert(ids[0] == 0 && ids[1] == 1 && ids[2] == 2);
+
+  // in place
+  ids[0] = 2;
+  ms_assert_ok(ms_load_elf_symbols(ms, elf, 1, symbols, ids));
+  ms_assert(ids[0] == 2);
+
+  // NULL is the whole .text
+  ids[0] = -1;
+  ms_assert_ok(ms_load_elf_symbols(ms, elf, 1, (const char *[]){NULL}, ids));
+  ms_assert(ids[0] == 3);
+  ms_assert_ok(ms_elf_close(ms, elf));
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->functions[0].code_size == function_size);
+  ms_assert(res->functions[3].code_size == 3 * function_size);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_load_symbols_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  ms_elf_t elf = NULL;
+  ms_assert(ms_elf_open(ms, "./test_data/does_not_exist.o", &elf) == 1);
+  ms_assert(elf == NULL);
+  ms_assert(ms_elf_open(ms, "./test_data/three_functions.asm", &elf) == 1);
+
+  ms_assert_ok(ms_elf_open(ms, file_elf, &elf));
+  // names must match exactly, not by prefix
+  const char *symbols[] = {"add_first", "add_"};
+  int ids[] = {-1, -1};
+  ms_assert(ms_load_elf_symbols(ms, elf, 2, symbols, ids) == 1);
+  ms_assert(ids[0] == 0 && ids[1] == -1);
+  ms_assert_ok(ms_elf_close(ms, elf));
+
+  // the failed one was not loaded
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert(ms_unload_last(ms) == 1);
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_load_all_ok();
+  res |= test_load_symbols_ok();
+  res |= test_load_symbols_fail();
+  return res;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+static const char file_shared_object[] = {"./test_data/liball.so"};
+// the same file, through another path
+static const char file_shared_object_2[] = {"./test_data/../test_data/liball.so"};
+static const int arg_width = 3;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+
+static int test_load_symbols_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const char *symbols[] = {"add_two_numbers", "array_width_three_add_pair",
+                           "add_two_numbers"};
+  int ids[] = {-1, -1, -1};
+  ms_assert_ok(ms_load_so_symbols(ms, file_shared_object, 3, symbols, ids));
+  ms_assert(ids[0] == 0 && ids[1] == 1 && ids[2] == 2);
+
+  // replacing keeps the library open for the others
+  const char *replacement[] = {"array_width_three_mul"};
+  ms_assert_ok(
+      ms_load_so_symbols(ms, file_shared_object_2, 1, replacement, ids));
+  ms_assert(ids[0] == 0);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // the last references go one by one
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_unload_last(ms));
+
+  // and it can be opened again
+  ids[0] = -1;
+  ms_assert_ok(ms_load_so_symbols(ms, file_shared_object, 1, symbols, ids));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_load_matching_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  ms_assert_ok(ms_load_so_matching(ms, file_shared_object,
+                                   "array_width_three_*", &first_id,
+                                   &num_loaded));
+  ms_assert(first_id == 0 && num_loaded == 3);
+
+  ms_assert_ok(ms_load_so_matching(ms, file_shared_object, "add_two_number?",
+                                   &first_id, &num_loaded));
+  ms_assert(first_id == 3 && num_loaded == 1);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "{\"type\":\"SHARED_OBJECT\"}");
+
+  // everything the library exports
+  ms_assert_ok(ms_unload_all(ms));
+  ms_assert_ok(
+      ms_load_so_matching(ms, file_shared_object, "*", &first_id, &num_loaded));
+  ms_assert(first_id == 0 && num_loaded == 10);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_load_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  // the ones before the missing symbol stay loaded
+  const char *symbols[] = {"add_two_numbers", "does_not_exist"};
+  int ids[] = {-1, -1};
+  ms_assert(ms_load_so_symbols(ms, file_shared_object, 2, symbols, ids) == 1);
+  ms_assert(ids[0] == 0 && ids[1] == -1);
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert(ms_unload_last(ms) == 1);
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  ms_assert(ms_load_so_matching(ms, file_shared_object, "none_*", &first_id,
+                                &num_loaded) == 1);
+  ms_assert(num_loaded == 0);
+  ms_assert(ms_load_so_matching(ms, "./test_data/does_not_exist.so", "*",
+                                &first_id, &num_loaded) == 1);
+  // not a shared object
+  ms_assert(ms_load_so_matching(ms, "./test_data/add_two_numbers.o", "*",
+                                &first_id, &num_loaded) == 1);
+
+  ms_assert(ms_unload_last(ms) == 1);
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_load_symbols_ok();
+  res |= test_load_matching_ok();
+  res |= test_load_fail();
+  return res;
+}
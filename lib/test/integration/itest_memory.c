@@ -0,0 +1,106 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const int arg_width = 4;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+// more than fit into the first mapping of the inputs and outputs
+static const int number_of_functions = 100;
+
+static int test_memory_default() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  struct ms_memory_status status = {0};
+  ms_assert_ok(ms_get_memory_status(ms, &status));
+  // transparent huge pages may be on for all memory, but nothing is locked
+  ms_assert(status.data_pages != MS_PAGES_HUGE &&
+            status.code_pages != MS_PAGES_HUGE);
+  ms_assert(status.locked == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_memory_options() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  // with whatever pages the system can provide
+  ms_assert_ok(
+      ms_set_memory_options(ms, MS_MEMORY_HUGE_PAGES | MS_MEMORY_LOCK));
+  struct ms_memory_status status = {0};
+  ms_assert_ok(ms_get_memory_status(ms, &status));
+  ms_assert(status.code_pages <= MS_PAGES_HUGE &&
+            status.data_pages <= MS_PAGES_HUGE);
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &id));
+  for (int i = 1; i < number_of_functions; i++) {
+    id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                              &id));
+  }
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->num_functions == (size_t)number_of_functions);
+  ms_assert(res->incorrect == 0);
+
+  // back to normal pages, with the code in place
+  ms_assert_ok(ms_set_memory_options(ms, 0));
+  ms_assert_ok(ms_get_memory_status(ms, &status));
+  ms_assert(status.data_pages != MS_PAGES_HUGE);
+  ms_assert_ok(ms_set_layout_randomization(ms, 64, 256, 0));
+  ms_assert_ok(ms_set_memory_options(ms, MS_MEMORY_LOCK));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  // without code, the arena is mapped anew
+  ms_assert_ok(ms_unload_all(ms));
+  ms_assert_ok(ms_set_memory_options(ms, MS_MEMORY_HUGE_PAGES));
+  id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_memory_default();
+  res |= test_memory_options();
+  return res;
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const char file_relocations[] = {"./test_data/relocations.o"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 5;
+
+static int test_placement_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int ids[] = {-1, -1};
+  ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                            &ids[0]));
+  ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                            &ids[1]));
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  // slots start at cache lines
+  ms_assert(res->functions[0].page_offset % 64 == 0);
+
+  // loaded code is moved
+  ms_assert_ok(ms_set_placement(ms, ids[0], 64, 5));
+  ms_assert_ok(ms_set_placement(ms, ids[1], 4096, 4000));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[0].page_offset % 64 == 5);
+  ms_assert(res->functions[1].page_offset == 4000);
+
+  // later loads keep it
+  ms_assert_ok(ms_replace_code(ms, ids[1], BIN, add_two_bin,
+                               sizeof(add_two_bin)));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[1].page_offset == 4000);
+
+  // back to the start of the slot
+  ms_assert_ok(ms_set_placement(ms, ids[1], 0, 0));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[1].page_offset % 64 == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_placement_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert(ms_set_placement(ms, 0, 64, 0) == 1);
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+  ms_assert(ms_set_placement(ms, id, 48, 0) == 1);
+  ms_assert(ms_set_placement(ms, id, 64, 64) == 1);
+  ms_assert(ms_set_placement(ms, id, 8192, 0) == 1);
+  ms_assert(ms_set_placement(ms, id, 0, 1) == 1);
+
+  id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &id));
+  ms_assert(ms_set_placement(ms, id, 64, 1) == 1);
+
+  // pointers in .data.rel to .data and .bss
+  id = -1;
+  ms_assert_ok(ms_load_file(ms, ELF, file_relocations, "add_with_tables", &id));
+  ms_assert(ms_set_placement(ms, id, 64, 1) == 1);
+  // staying put is fine
+  ms_assert_ok(ms_set_placement(ms, id, 0, 0));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_sweep_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int ids[] = {-1, -1, -1};
+  ms_assert_ok(ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL,
+                            &ids[0]));
+  ms_assert_ok(ms_set_placement(ms, ids[0], 128, 3));
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &ids[1]));
+  ms_assert_ok(ms_load_file(ms, ELF, "./test_data/add_two_numbers.o",
+                            "add_two_numbers", &ids[2]));
+
+  const struct ms_sweep_results *sweep = NULL;
+  ms_assert_ok(ms_measure_sweep(ms, batch_size, number_of_batches, 64, 4,
+                                &sweep));
+  ms_assert(sweep->window == 64 && sweep->num_offsets == 4 &&
+            sweep->num_functions == 3);
+  for (size_t i = 0; i < 4; i++) {
+    ms_assert(sweep->offsets[i] == i * 16);
+    for (size_t f = 0; f < 3; f++) {
+      ms_assert(sweep->medians[i * 3 + f] > 0);
+    }
+  }
+  for (size_t f = 0; f < 3; f++) {
+    const struct ms_sweep_function *fct = &sweep->functions[f];
+    ms_assert(fct->min <= fct->median && fct->median <= fct->max);
+    ms_assert(sweep->medians[fct->best * 3 + f] == fct->min);
+  }
+  ms_assert(sweep->functions[0].moved && !sweep->functions[1].moved &&
+            sweep->functions[2].moved);
+
+  // the last offset was measured, then the placements were restored
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->functions[0].page_offset % 64 == 48);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->functions[0].page_offset % 128 == 3);
+
+  ms_assert(ms_measure_sweep(ms, batch_size, number_of_batches, 48, 4,
+                             &sweep) == 1);
+  ms_assert(ms_measure_sweep(ms, batch_size, number_of_batches, 64, 0,
+                             &sweep) == 1);
+  ms_assert(ms_measure_sweep(ms, batch_size, number_of_batches, 4, 8,
+                             &sweep) == 1);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_placement_ok();
+  res |= test_placement_fail();
+  res |= test_sweep_ok();
+  return res;
+}
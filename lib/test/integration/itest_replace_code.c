@@ -0,0 +1,153 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char file_shared_object[] = {"./test_data/add_two_numbers.so"};
+static const char symbol[] = {"add_two_numbers"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 10;
+
+static const uint8_t add_bin[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+// same, but with the operands swapped
+static const uint8_t add_swapped_bin[] = {
+    0x48, 0x8b, 0x02, // mov rax, [rdx]
+    0x48, 0x03, 0x06, // add rax, [rsi]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+static int test_replace_bin_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_set_checking(ms, 1);
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object, symbol,
+                            &id));
+  ms_assert(id == 0);
+  id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+  ms_assert(id == 1);
+
+  // measure, replace, measure again. The check against the SO must still pass.
+  for (int i = 0; i < 10; i++) {
+    ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+    const uint8_t *next = i % 2 == 0 ? add_swapped_bin : add_bin;
+    ms_assert_ok(ms_replace_code(ms, 1, BIN, next, sizeof(add_bin)));
+  }
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "\"numFunctions\":2");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_replace_many_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const size_t num = 5;
+  int ids[num];
+  const uint8_t *data[num];
+  size_t lens[num];
+  for (size_t i = 0; i < num; i++) {
+    ids[i] = -1;
+    ms_assert_ok(
+        ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &ids[i]));
+    data[i] = add_swapped_bin;
+    lens[i] = sizeof(add_swapped_bin);
+  }
+
+  ms_assert_ok(ms_replace_code_many(ms, num, ids, BIN, data, lens));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "\"numFunctions\":5");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_replace_asm_ok() {
+#if USE_ASSEMBLYLINE
+  const char add_asm[] = {"mov rax, [rsi]\n"
+                          "add rax, [rdx]\n"
+                          "mov [rdi], rax\n"
+                          "ret\n"};
+  const char add_swapped_asm[] = {"mov rax, [rdx]\n"
+                                  "add rax, [rsi]\n"
+                                  "mov [rdi], rax\n"
+                                  "ret\n"};
+
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, ASM, (uint8_t *)add_asm, strlen(add_asm), NULL, &id));
+  ms_assert(id == 0);
+  ms_assert_ok(ms_replace_code(ms, id, ASM, (uint8_t *)add_swapped_asm,
+                               strlen(add_swapped_asm)));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // replacing with a different type is fine, too
+  ms_assert_ok(ms_replace_code(ms, id, BIN, add_bin, sizeof(add_bin)));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "{\"type\":\"BIN\",\"codeSize\":10}");
+
+  ms_assert_ok(ms_terminate(ms));
+#endif
+  return 0;
+}
+
+static int test_replace_oob_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  // nothing loaded yet
+  ms_assert(ms_replace_code(ms, 0, BIN, add_bin, sizeof(add_bin)) == 1);
+  // -1 does not mean 'next free slot' here
+  ms_assert(ms_replace_code(ms, -1, BIN, add_bin, sizeof(add_bin)) == 1);
+
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+  ms_assert(ms_replace_code(ms, 1, BIN, add_bin, sizeof(add_bin)) == 1);
+  ms_assert(ms_replace_code(ms, 0, SHARED_OBJECT, add_bin, 0) == 1);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_replace_bin_ok();
+  res |= test_replace_many_ok();
+  res |= test_replace_asm_ok();
+  res |= test_replace_oob_fail();
+  return res;
+}
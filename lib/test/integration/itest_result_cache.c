@@ -0,0 +1,208 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char file_shared_object[] = {"./test_data/add_two_numbers.so"};
+static const char file_asm[] = {"./test_data/add_two_numbers.asm"};
+static const char file_cache[] = {"./test_data/result_cache.tmp"};
+static const char symbol[] = {"add_two_numbers"};
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 10;
+static const int number_of_batches = 10;
+static const size_t num_entries = 16;
+
+static const uint8_t add_bin[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+#define assert_stats(exp_hits, exp_misses)                                     \
+  do {                                                                         \
+    uint64_t hits = 0;                                                         \
+    uint64_t misses = 0;                                                       \
+    ms_get_result_cache_stats(ms, &hits, &misses);                             \
+    ms_assert(hits == (exp_hits));                                             \
+    ms_assert(misses == (exp_misses));                                         \
+  } while (0)
+
+// copies the cycles of function 0 to @param dest
+static int measure_copy(measuresuite_t ms, int batches, uint64_t *dest) {
+  uint64_t *cycles = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, batches));
+  ms_assert_ok(ms_get_cycles(ms, &cycles, 0));
+  memcpy(dest, cycles, batches * sizeof(uint64_t));
+  return 0;
+}
+
+static int test_hit_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, 0));
+
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+
+  uint64_t first[number_of_batches];
+  uint64_t second[number_of_batches];
+  ms_assert_ok(measure_copy(ms, number_of_batches, first));
+  assert_stats(0, 1);
+  ms_assert_ok(measure_copy(ms, number_of_batches, second));
+  assert_stats(1, 1);
+  ms_assert(memcmp(first, second, sizeof(first)) == 0);
+
+  // another config is another key
+  ms_assert_ok(measure_copy(ms, number_of_batches - 1, second));
+  assert_stats(1, 2);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_top_up_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  const int top_up = 2;
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, top_up));
+
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+
+  uint64_t first[number_of_batches];
+  uint64_t second[number_of_batches];
+  ms_assert_ok(measure_copy(ms, number_of_batches, first));
+  ms_assert_ok(measure_copy(ms, number_of_batches, second));
+  assert_stats(1, 1);
+
+  // the oldest samples have been replaced by the fresh ones
+  for (int i = 0; i < number_of_batches - top_up; i++) {
+    ms_assert(second[i] == first[i + top_up]);
+  }
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_checking_bypasses_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, 0));
+  ms_set_checking(ms, 1);
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object, symbol,
+                            &id));
+  id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_stats(0, 0);
+
+  // but the results have been stored
+  ms_set_checking(ms, 0);
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_stats(1, 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_save_load_ok() {
+  uint64_t first[number_of_batches];
+  uint64_t second[number_of_batches];
+
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, 0));
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+  ms_assert_ok(measure_copy(ms, number_of_batches, first));
+  ms_assert_ok(ms_result_cache_save(ms, file_cache));
+  ms_assert_ok(ms_terminate(ms));
+
+  // a new instance
+  ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert(ms_result_cache_load(ms, file_cache) == 1); // disabled
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, 0));
+  ms_assert(ms_result_cache_load(ms, file_asm) == 1); // not a cache file
+  ms_assert_ok(ms_result_cache_load(ms, file_cache));
+
+  id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+  ms_assert_ok(measure_copy(ms, number_of_batches, second));
+  assert_stats(1, 0);
+  ms_assert(memcmp(first, second, sizeof(first)) == 0);
+
+  ms_assert_ok(ms_terminate(ms));
+  remove(file_cache);
+  return 0;
+}
+
+// overwrites the uint64_t at @param offset of the cache file with @param value
+static int patch_file(long offset, uint64_t value) {
+  FILE *file = fopen(file_cache, "r+b");
+  const int ret = file == NULL || fseek(file, offset, SEEK_SET) != 0 ||
+                  fwrite(&value, sizeof(value), 1, file) != 1;
+  if (file != NULL) {
+    fclose(file);
+  }
+  return ret;
+}
+
+static int test_load_corrupt() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+  ms_assert_ok(ms_set_result_cache(ms, num_entries, 0));
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, add_bin, sizeof(add_bin), NULL, &id));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // magic, version, number of entries, then key, code_len, num_batches, next
+  const long num_batches_at = 4 + 4 + 8 + 2 * 8;
+  // more samples than there are, or so many that their size wraps around
+  const uint64_t corrupt[] = {number_of_batches + 1, UINT64_C(1) << 61,
+                              UINT64_MAX};
+  for (size_t i = 0; i < sizeof(corrupt) / sizeof(corrupt[0]); i++) {
+    ms_assert_ok(ms_result_cache_save(ms, file_cache));
+    ms_assert(patch_file(num_batches_at, corrupt[i]) == 0);
+    ms_assert(ms_result_cache_load(ms, file_cache) == 1);
+  }
+
+  ms_assert_ok(ms_terminate(ms));
+  remove(file_cache);
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_hit_ok();
+  res |= test_top_up_ok();
+  res |= test_checking_bypasses_ok();
+  res |= test_save_load_ok();
+  res |= test_load_corrupt();
+  return res;
+}
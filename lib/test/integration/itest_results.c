@@ -0,0 +1,115 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 2;
+static const int number_of_batches = 10;
+
+static const uint8_t code[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+static int test_results_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const struct ms_results *res = NULL;
+  ms_assert(ms_get_results(ms, MS_RESULTS_VERSION, &res) != 0);
+
+  const size_t num_functions = 2;
+  for (size_t i = 0; i < num_functions; i++) {
+    int id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+  }
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert(ms_get_results(ms, MS_RESULTS_VERSION + 1, &res) != 0);
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->version == MS_RESULTS_VERSION);
+  ms_assert(res->num_functions == num_functions);
+  ms_assert(res->num_batches == (size_t)number_of_batches);
+  ms_assert(res->batch_size == (size_t)batch_size);
+  ms_assert(res->incorrect == 0);
+  ms_assert(res->timer == ms_get_timer(ms));
+  for (size_t i = 0; i < num_functions; i++) {
+    uint64_t *cycles = NULL;
+    ms_assert_ok(ms_get_cycles(ms, &cycles, i));
+    ms_assert(res->functions[i].type == BIN);
+    ms_assert(res->functions[i].chunks == 0);
+    ms_assert(res->functions[i].cycles == cycles);
+    ms_assert(res->functions[i].code_size == sizeof(code));
+  }
+
+  // the results describe the measurement, not what is loaded now
+  ms_assert_ok(ms_unload_last(ms));
+  ms_assert(res->num_functions == num_functions);
+  assert_string_in_json(ms, "\"numFunctions\":2");
+  assert_string_in_json(ms, "{\"type\":\"BIN\",\"codeSize\":10},"
+                            "{\"type\":\"BIN\",\"codeSize\":10}");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// the JSON can only be generated while the cycles have not been taken
+static int test_json_after_take_fail() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  int id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  uint64_t *cycles = NULL;
+  size_t num_f = 0;
+  size_t num_b = 0;
+  ms_assert_ok(ms_take_cycles(ms, &cycles, &num_f, &num_b));
+  free(cycles);
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->functions[0].cycles == NULL);
+
+  const char *json = NULL;
+  size_t len = 0;
+  ms_get_json(ms, &json, &len);
+  ms_assert(json == NULL);
+
+  // but again after the next measurement
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  assert_string_in_json(ms, "\"numFunctions\":1");
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_results_ok();
+  res |= test_json_after_take_fail();
+  return res;
+}
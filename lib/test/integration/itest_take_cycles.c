@@ -0,0 +1,103 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int arg_width = 1;
+static const int arg_num_in = 2;
+static const int arg_num_out = 1;
+static const int batch_size = 2;
+static const int number_of_batches = 10;
+
+static const uint8_t code[] = {
+    0x48, 0x8b, 0x06, // mov rax, [rsi]
+    0x48, 0x03, 0x02, // add rax, [rdx]
+    0x48, 0x89, 0x07, // mov [rdi], rax
+    0xc3,             // ret
+};
+
+static int test_take_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  const size_t num_functions = 3;
+  for (size_t i = 0; i < num_functions; i++) {
+    int id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+  }
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  // the rows are the same as the ones from ms_get_cycles
+  uint64_t *rows[3];
+  for (size_t i = 0; i < num_functions; i++) {
+    ms_assert_ok(ms_get_cycles(ms, &rows[i], i));
+  }
+
+  uint64_t *cycles = NULL;
+  size_t num_f = 0;
+  size_t num_b = 0;
+  ms_assert_ok(ms_take_cycles(ms, &cycles, &num_f, &num_b));
+  ms_assert(num_f == num_functions);
+  ms_assert(num_b == (size_t)number_of_batches);
+  for (size_t i = 0; i < num_functions; i++) {
+    ms_assert(rows[i] == &cycles[i * num_b]);
+    for (size_t b = 0; b < num_b; b++) {
+      ms_assert(cycles[i * num_b + b] > 0);
+    }
+  }
+
+  // taken once only
+  uint64_t *again = NULL;
+  ms_assert(ms_take_cycles(ms, &again, &num_f, &num_b) != 0);
+
+  // which does not affect the next measurement
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_take_cycles(ms, &again, &num_f, &num_b));
+  ms_assert(again != cycles);
+  free(cycles);
+  free(again);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+// the cycles are reused across measurements, also with more functions
+static int test_grow_ok() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, arg_width, arg_num_in, arg_num_out));
+
+  for (int i = 0; i < 5; i++) {
+    int id = -1;
+    ms_assert_ok(ms_load_data(ms, BIN, code, sizeof(code), NULL, &id));
+    ms_assert_ok(ms_measure(ms, batch_size, number_of_batches + i));
+  }
+  ms_assert_ok(ms_unload_all(ms));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_take_ok();
+  res |= test_grow_ok();
+  return res;
+}
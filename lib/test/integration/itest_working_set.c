@@ -0,0 +1,142 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "helper.h"
+#include <measuresuite.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdlib.h>
+
+// mov rax, [rsi]; add rax, [rdx]; mov [rdi], rax; ret
+static const uint8_t add_two_bin[] = {0x48, 0x8b, 0x06, 0x48, 0x03,
+                                      0x02, 0x48, 0x89, 0x07, 0xc3};
+// mov qword [rdi], 0; then as add_two_bin. Different only if out1 == arg1.
+static const uint8_t clear_then_add_two_bin[] = {
+    0x48, 0xc7, 0x07, 0x00, 0x00, 0x00, 0x00, 0x48, 0x8b, 0x06,
+    0x48, 0x03, 0x02, 0x48, 0x89, 0x07, 0xc3};
+static const char file_shared_object[] = {"./test_data/liball.so"};
+static const int batch_size = 10;
+static const int number_of_batches = 3;
+// beyond the L1 of most cpus
+static const size_t working_set = 256 << 10;
+
+static int test_working_set_invalid() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 2, 1));
+
+  // one set is three qwords, rounded up to a cache line
+  ms_assert(ms_set_working_set(ms, 63) == 1);
+  ms_assert_ok(ms_set_working_set(ms, 64));
+  ms_assert_ok(ms_set_working_set(ms, 0));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_working_set() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 2, 1));
+  ms_set_checking(ms, 1);
+  ms_assert_ok(ms_set_working_set(ms, working_set));
+
+  int id = -1;
+  ms_assert_ok(ms_load_file(ms, SHARED_OBJECT, file_shared_object,
+                            "add_two_numbers", &id));
+  id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->num_functions == 2);
+  ms_assert(res->incorrect == 0);
+
+  // in place, and with huge pages where there are some
+  const int aliases[] = {0};
+  ms_assert_ok(ms_set_aliasing(ms, aliases));
+  ms_assert_ok(ms_set_memory_options(ms, MS_MEMORY_HUGE_PAGES));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  // the results of the normal inputs are still checked
+  id = -1;
+  ms_assert_ok(ms_load_data(ms, BIN, clear_then_add_two_bin,
+                            sizeof(clear_then_add_two_bin), NULL, &id));
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 2);
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+static int test_working_set_sweep() {
+  measuresuite_t ms = NULL;
+  ms_assert_ok(ms_initialize(&ms, 1, 2, 1));
+  ms_set_checking(ms, 1);
+
+  int id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+  id = -1;
+  ms_assert_ok(
+      ms_load_data(ms, BIN, add_two_bin, sizeof(add_two_bin), NULL, &id));
+
+  const struct ms_working_set_results *sweep = NULL;
+  ms_assert_ok(
+      ms_measure_working_set_sweep(ms, batch_size, number_of_batches, &sweep));
+  ms_assert(sweep->num_functions == 2);
+  // at least one cache, and memory
+  ms_assert(sweep->num_levels >= 2 && sweep->num_levels <= MS_MAX_CACHE_LEVELS);
+  for (size_t l = 0; l + 1 < sweep->num_levels; l++) {
+    ms_assert(sweep->levels[l].level > 0);
+    ms_assert(sweep->levels[l].cache_size > 0);
+    ms_assert(sweep->levels[l].working_set ==
+              sweep->levels[l].cache_size / 2);
+    if (l > 0) {
+      ms_assert(sweep->levels[l].level >= sweep->levels[l - 1].level);
+    }
+  }
+  const struct ms_working_set_level *memory =
+      &sweep->levels[sweep->num_levels - 1];
+  ms_assert(memory->level == 0 && memory->cache_size == 0);
+  ms_assert(memory->working_set ==
+            2 * sweep->levels[sweep->num_levels - 2].cache_size);
+  for (size_t i = 0; i < sweep->num_levels * sweep->num_functions; i++) {
+    ms_assert(sweep->cycles_per_call[i] > 0);
+  }
+
+  const struct ms_results *res = NULL;
+  ms_assert_ok(ms_get_results(ms, MS_RESULTS_VERSION, &res));
+  ms_assert(res->incorrect == 0);
+
+  // back to reusing the inputs
+  ms_assert_ok(ms_measure(ms, batch_size, number_of_batches));
+
+  ms_assert_ok(ms_terminate(ms));
+  return 0;
+}
+
+int main() {
+  int res = 0;
+  res |= test_working_set_invalid();
+  res |= test_working_set();
+  res |= test_working_set_sweep();
+  return res;
+}
@@ -0,0 +1,40 @@
+SECTION .text
+GLOBAL add_aligned16:function
+GLOBAL add_aligned32:function
+GLOBAL add_aligned128:function
+; all three do [rdi]= [rsi] + [rdx] with data which must stay aligned
+
+; like SSE code from a compiler, pxor faults on an unaligned memory operand
+add_aligned16:
+movq xmm0, [rsi]
+movq xmm1, [rdx]
+paddq xmm0, xmm1
+pxor xmm0, [rel zero16]
+movq [rdi], xmm0
+ret
+
+; add how far the table is off its alignment, which the check catches
+add_aligned32:
+lea rax, [rel zero32]
+and eax, 31
+add rax, [rsi]
+add rax, [rdx]
+mov [rdi], rax
+ret
+
+add_aligned128:
+lea rax, [rel zero128]
+and eax, 127
+add rax, [rsi]
+add rax, [rdx]
+mov [rdi], rax
+ret
+
+SECTION .rodata.cst16 progbits alloc noexec nowrite align=16
+zero16: dq 0, 0
+
+SECTION .rodata.cst32 progbits alloc noexec nowrite align=32
+zero32: dq 0, 0, 0, 0
+
+SECTION .rodata.table progbits alloc noexec nowrite align=128
+zero128: times 16 dq 0
@@ -0,0 +1,49 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+// Each function computes *out0 = *in0 + *in1, like add_two_numbers, but only
+// if the loader applies their relocations. Compiled with -ffunction-sections.
+
+// .rodata
+static const uint64_t offsets[8] = {0x5a, 0x13, 0x77, 0x2f,
+                                    0x01, 0x99, 0x3c, 0x80};
+// .data
+uint64_t negated_offsets[8] = {-0x5aUL, -0x13UL, -0x77UL, -0x2fUL,
+                               -0x01UL, -0x99UL, -0x3cUL, -0x80UL};
+// .data.rel, an absolute address
+const uint64_t *offset_table = offsets;
+// .bss
+uint64_t num_calls;
+
+__attribute__((noinline)) uint64_t offset_of(uint64_t x) {
+  return offset_table[x & 7];
+}
+
+// calls offset_of in another section and reads .data
+void add_with_tables(uint64_t *out0, const uint64_t *in0,
+                     const uint64_t *in1) {
+  num_calls++;
+  *out0 = *in0 + *in1 + offset_of(*in0) + negated_offsets[*in0 & 7];
+}
+
+extern uint64_t not_defined_here(uint64_t x);
+
+// cannot be linked
+void add_external(uint64_t *out0, const uint64_t *in0, const uint64_t *in1) {
+  *out0 = *in0 + *in1 + not_defined_here(*in0);
+}
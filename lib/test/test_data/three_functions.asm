@@ -0,0 +1,20 @@
+SECTION .text
+GLOBAL add_first:function
+GLOBAL add_second:function
+GLOBAL add_untyped
+; all three do [rdi]= [rsi] + [rdx]
+add_first:
+mov rax, [rsi]
+add rax, [rdx]
+mov [rdi], rax
+ret
+add_second:
+mov rax, [rdx]
+add rax, [rsi]
+mov [rdi], rax
+ret
+add_untyped:
+mov rax, [rsi]
+add rax, [rdx]
+mov [rdi], rax
+ret
@@ -0,0 +1,86 @@
+/**
+ * Copyright 2023 University of Adelaide
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// unit-test
+#include "json.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// compares against snprintf, @returns 1 on mismatch
+static int dec_same(uint64_t value) {
+  char expected[32];
+  char actual[32];
+  snprintf(expected, sizeof(expected), "%" PRIu64, value);
+
+  char *end = u64_to_dec(actual, value);
+  *end = '\0';
+  if (strcmp(expected, actual) != 0 ||
+      u64_dec_len(value) != strlen(expected)) {
+    fprintf(stderr, "%s != %s (len %zu)\n", expected, actual,
+            u64_dec_len(value));
+    return 1;
+  }
+  return 0;
+}
+
+// around each power of ten, where the number of digits changes
+static int powers_of_ten() {
+  int res = 0;
+  uint64_t p = 1;
+  for (int i = 0; i < 20; i++) {
+    res |= dec_same(p - 1);
+    res |= dec_same(p);
+    res |= dec_same(p + 1);
+    if (i < 19) {
+      p *= 10;
+    }
+  }
+  return res;
+}
+
+// and around each power of two, where the estimate from log2 changes
+static int powers_of_two() {
+  int res = 0;
+  for (int i = 0; i < 64; i++) {
+    const uint64_t p = 1ULL << i;
+    res |= dec_same(p - 1);
+    res |= dec_same(p);
+    res |= dec_same(p + 1);
+  }
+  res |= dec_same(UINT64_MAX);
+  return res;
+}
+
+static int random_values() {
+  int res = 0;
+  srand(42);
+  for (int i = 0; i < 100000; i++) {
+    const uint64_t v = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^
+                       (uint64_t)rand();
+    res |= dec_same(v >> (i % 64));
+  }
+  return res;
+}
+
+int main() {
+  int res = 0;
+  res |= powers_of_ten();
+  res |= powers_of_two();
+  res |= random_values();
+  return res;
+}
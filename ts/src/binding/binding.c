@@ -39,36 +39,114 @@ napi_value Init(napi_env env, napi_value exports) {
   // init(argWidth: number, numArgIn: number, numArgOut: number): void;
   register_function(env, exports, init, "init");
 
-  // load_asm_string(assembly: string): number;
+  // load_asm_string(assembly: string | Uint8Array): number;
   register_function(env, exports, load_asm_string, "load_asm_string");
+  // replace_asm_string(id: number, assembly: string | Uint8Array): number;
+  register_function(env, exports, replace_asm_string, "replace_asm_string");
   // load_asm_file(path: string): number;
   register_function(env, exports, load_asm_file, "load_asm_file");
   // load_bin_file(path: string): number;
   register_function(env, exports, load_bin_file, "load_bin_file");
+  // load_bin_buffer(code: Uint8Array): number;
+  register_function(env, exports, load_bin_buffer, "load_bin_buffer");
+  // replace_bin_buffer(id: number, code: Uint8Array): number;
+  register_function(env, exports, replace_bin_buffer, "replace_bin_buffer");
   // load_elf_file(path: string, symbol?: string): number;
   register_function(env, exports, load_elf_file, "load_elf_file");
+  // load_archive_file(path: string, symbol?: string): number[];
+  register_function(env, exports, load_archive_file, "load_archive_file");
   // load_shared_object_file(path: string, symbol: string): number;
   register_function(env, exports, load_shared_object_file,
                     "load_shared_object_file");
+  // load_shared_object_matching(path: string, pattern: string): number[];
+  register_function(env, exports, load_shared_object_matching,
+                    "load_shared_object_matching");
+  // load_shared_object_buffer(library: Uint8Array, symbol: string): number;
+  register_function(env, exports, load_shared_object_buffer,
+                    "load_shared_object_buffer");
+
+  // load_many(functions: (string | Uint8Array)[] | Uint8Array,
+  //           offsets?: Uint32Array): number[];
+  register_function(env, exports, load_many, "load_many");
+  // replace_many(ids: number[], functions: (string | Uint8Array)[] |
+  //              Uint8Array, offsets?: Uint32Array): void;
+  register_function(env, exports, replace_many, "replace_many");
+  // set_max_asm_length(maxLength: number): void;
+  register_function(env, exports, set_max_asm_length, "set_max_asm_length");
 
   // unload_all(): void;
   register_function(env, exports, unload_all, "unload_all");
   // unload(id: number): void;
   register_function(env, exports, unload_last, "unload_last");
+  // unload_many(count: number): void;
+  register_function(env, exports, unload_many, "unload_many");
 
   // enable_checking(): void;
   register_function(env, exports, enable_checking, "enable_checking");
   // enable_chunk_counting(chunkSize: number): void;
   register_function(env, exports, enable_chunk_counting,
                     "enable_chunk_counting");
+  // enable_asm_cache(numEntries: number): void;
+  register_function(env, exports, enable_asm_cache, "enable_asm_cache");
+  // enable_incremental_assembly(numLines: number): void;
+  register_function(env, exports, enable_incremental_assembly,
+                    "enable_incremental_assembly");
+  // enable_result_cache(numEntries: number, topUpBatches: number): void;
+  register_function(env, exports, enable_result_cache, "enable_result_cache");
+  // enable_layout_randomization(codeWindow: number, dataWindow: number,
+  //                             requireMovable: boolean): void;
+  register_function(env, exports, enable_layout_randomization,
+                    "enable_layout_randomization");
+  // set_memory_options(hugePages: boolean, lock: boolean): void;
+  register_function(env, exports, set_memory_options, "set_memory_options");
+  // set_aliasing(aliases: number[] | null): void;
+  register_function(env, exports, set_aliasing, "set_aliasing");
+  // set_working_set(bytes: number): void;
+  register_function(env, exports, set_working_set, "set_working_set");
+  // set_batch_callback(callback: ((batch: number, cycles: BigUint64Array)
+  //                     => boolean | "stop" | void) | null): void;
+  register_function(env, exports, set_batch_callback, "set_batch_callback");
   // set_bounds(bounds: BigUint64Array): void;
   register_function(env, exports, binding_set_bounds, "set_bounds");
+  // set_placement(id: number, alignment: number, offset: number): void;
+  register_function(env, exports, binding_set_placement, "set_placement");
+  // set_data_offsets(inOffset: number, outOffset: number): void;
+  register_function(env, exports, set_data_offsets, "set_data_offsets");
   // measure(batchSize: number, numBatches: number): string;
   register_function(env, exports, measure, "measure");
+  // measure_typed(batchSize: number, numBatches: number): TypedResult;
+  register_function(env, exports, measure_typed, "measure_typed");
+  // measure_sweep(batchSize: number, numBatches: number, window: number,
+  //               numOffsets: number): SweepResult;
+  register_function(env, exports, measure_sweep, "measure_sweep");
+  // measure_data_sweep(batchSize: number, numBatches: number,
+  //                    numOffsets: number): SweepResult;
+  register_function(env, exports, measure_data_sweep, "measure_data_sweep");
+  // measure_working_set_sweep(batchSize: number,
+  //                           numBatches: number): WorkingSetResult;
+  register_function(env, exports, measure_working_set_sweep,
+                    "measure_working_set_sweep");
+  // measure_async(batchSize: number, numBatches: number,
+  //               cpu?: number): Promise<TypedResult>;
+  register_function(env, exports, measure_async, "measure_async");
 
   // get_timer(): number;
   register_function(env, exports, get_timer, "get_timer");
 
+  // get_asm_cache_stats(): { hits: number; misses: number };
+  register_function(env, exports, get_asm_cache_stats, "get_asm_cache_stats");
+  // get_memory_status(): MemoryStatus;
+  register_function(env, exports, get_memory_status, "get_memory_status");
+  // get_assembly_time(id: number): number;
+  register_function(env, exports, get_assembly_time, "get_assembly_time");
+  // get_result_cache_stats(): { hits: number; misses: number };
+  register_function(env, exports, get_result_cache_stats,
+                    "get_result_cache_stats");
+  // save_result_cache(path: string): void;
+  register_function(env, exports, save_result_cache, "save_result_cache");
+  // load_result_cache(path: string): void;
+  register_function(env, exports, load_result_cache, "load_result_cache");
+
   // destroy(): number;
   register_function(env, exports, destroy, "destroy");
 
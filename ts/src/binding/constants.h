@@ -22,7 +22,8 @@
 static const size_t max_len_symbol = 10240;
 // how many chars are allowed for the paths
 static const size_t max_len_paths = 10240;
-// how many chars are allowed for the asmStrings
-static const size_t max_len_asmstrings = 1024000;
+// how many chars are allowed for the asmStrings, unless set otherwise with
+// set_max_asm_length
+static const size_t default_max_len_asmstrings = 1024000;
 
 #endif /* CONSTANTS_H */
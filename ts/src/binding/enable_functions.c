@@ -17,16 +17,15 @@
 #include "constants.h"
 #include "helper.h"
 #include <measuresuite.h>
+#include <stdlib.h>
 
 napi_value enable_checking(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
 
-  measuresuite_t ms = (measuresuite_t)instance_data;
-
   const size_t argc_measure = 2;
   size_t argc = argc_measure;
 
@@ -44,11 +43,10 @@ napi_value enable_checking(napi_env env, napi_callback_info info) {
 }
 napi_value enable_chunk_counting(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   const size_t argc_init = 1;
   size_t argc = argc_init;
@@ -76,3 +74,445 @@ napi_value enable_chunk_counting(napi_env env, napi_callback_info info) {
   napi_create_int32(env, 0, &napi_result);
   return napi_result;
 }
+
+napi_value enable_asm_cache(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  uint32_t num_entries = 0;
+  // parse number of cache entries
+  if (napi_get_value_uint32(env, argv[0], &num_entries) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of cache entries was passed as argument 0");
+  }
+
+  if (ms_set_asm_cache_size(ms, num_entries) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set asm cache size.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value enable_incremental_assembly(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  uint32_t num_lines = 0;
+  // parse number of memoized lines
+  if (napi_get_value_uint32(env, argv[0], &num_lines) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of lines was passed as argument 0");
+  }
+
+  if (ms_set_incremental_assembly(ms, num_lines) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env,
+                                     "Could not set incremental assembly.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value enable_result_cache(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  uint32_t num_entries = 0;
+  // parse number of cache entries
+  if (napi_get_value_uint32(env, argv[0], &num_entries) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of cache entries was passed as argument 0");
+  }
+  uint32_t top_up = 0;
+  // parse number of top up batches
+  if (napi_get_value_uint32(env, argv[1], &top_up) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of top up batches was passed as argument 1");
+  }
+
+  if (ms_set_result_cache(ms, num_entries, top_up) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set result cache.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value enable_layout_randomization(napi_env env,
+                                       napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 3;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  uint32_t code_window = 0;
+  if (napi_get_value_uint32(env, argv[0], &code_window) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid code window was passed as argument 0");
+  }
+  uint32_t data_window = 0;
+  if (napi_get_value_uint32(env, argv[1], &data_window) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid data window was passed as argument 1");
+  }
+  bool require_movable = false;
+  if (napi_get_value_bool(env, argv[2], &require_movable) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid require movable flag was passed as argument 2");
+  }
+
+  if (ms_set_layout_randomization(
+          ms, code_window, data_window,
+          require_movable ? MS_LAYOUT_REQUIRE_MOVABLE : 0) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env,
+                                     "Could not set layout randomization.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value set_memory_options(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  bool huge_pages = false;
+  if (napi_get_value_bool(env, argv[0], &huge_pages) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid huge pages flag was passed as argument 0");
+  }
+  bool lock = false;
+  if (napi_get_value_bool(env, argv[1], &lock) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid lock flag was passed as argument 1");
+  }
+
+  const int flags =
+      (huge_pages ? MS_MEMORY_HUGE_PAGES : 0) | (lock ? MS_MEMORY_LOCK : 0);
+  if (ms_set_memory_options(ms, flags) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set memory options.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value set_aliasing(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // anything but an array (e.g. null) disables it
+  bool is_array = false;
+  if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok ||
+      !is_array) {
+    ms_set_aliasing(ms, NULL);
+    napi_value napi_result = NULL;
+    napi_get_undefined(env, &napi_result);
+    return napi_result;
+  }
+
+  // one per out argument, at most 6; the rest are not aliased
+  int aliases[6] = {MS_ALIAS_NONE, MS_ALIAS_NONE, MS_ALIAS_NONE,
+                    MS_ALIAS_NONE, MS_ALIAS_NONE, MS_ALIAS_NONE};
+  uint32_t num_aliases = 0;
+  if (napi_get_array_length(env, argv[0], &num_aliases) != napi_ok ||
+      num_aliases > 6) {
+    return throw_and_return_napi_val(
+        env, "Aliases must be an array of at most 6 in argument indices.");
+  }
+  for (uint32_t j = 0; j < num_aliases; j++) {
+    napi_value napi_alias = NULL;
+    if (napi_get_element(env, argv[0], j, &napi_alias) != napi_ok ||
+        napi_get_value_int32(env, napi_alias, &aliases[j]) != napi_ok) {
+      return throw_and_return_napi_val(env,
+                                       "Invalid index in the aliases array.");
+    }
+  }
+
+  if (ms_set_aliasing(ms, aliases) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set the aliasing.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_get_undefined(env, &napi_result);
+  return napi_result;
+}
+
+napi_value set_working_set(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  int64_t bytes = 0;
+  if (napi_get_value_int64(env, argv[0], &bytes) != napi_ok || bytes < 0) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of bytes was passed as argument 0");
+  }
+
+  if (ms_set_working_set(ms, (size_t)bytes) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set the working set.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_get_undefined(env, &napi_result);
+  return napi_result;
+}
+
+// one batch, passed from forward_batch to call_batch_callback, which sets stop
+// and then done once JS has returned
+struct batch_report {
+  size_t batch;
+  size_t num_functions;
+  const uint64_t *cycles;
+  int stop;
+  int done;
+};
+
+// @returns 1 if @param result of the JS batch callback is true or "stop"
+static int is_stop(napi_env env, napi_value result) {
+  bool stop = false;
+  if (napi_get_value_bool(env, result, &stop) == napi_ok) {
+    return stop;
+  }
+  // the length first, a longer string would be cut to "stop"
+  char str[5] = {0};
+  size_t len = 0;
+  return napi_get_value_string_latin1(env, result, NULL, 0, &len) == napi_ok &&
+         len == 4 &&
+         napi_get_value_string_latin1(env, result, str, sizeof(str), &len) ==
+             napi_ok &&
+         strcmp(str, "stop") == 0;
+}
+
+// calls @param js_callback with @param report on the JS thread of @param env,
+// @returns 1 if it asked to stop, or threw. What it threw is kept in
+// @param instance, then it is not called again.
+static int call_js(napi_env env, struct binding_instance *instance,
+                   napi_value js_callback, const struct batch_report *report) {
+  if (instance->batch_exception != NULL) {
+    return 1;
+  }
+  napi_handle_scope scope = NULL;
+  if (napi_open_handle_scope(env, &scope) != napi_ok) {
+    return 0;
+  }
+
+  const size_t byte_length = report->num_functions * sizeof(uint64_t);
+  void *cycles = NULL;
+  napi_value buffer = NULL;
+  napi_value argv[2];
+  napi_value undefined = NULL;
+  napi_value result = NULL;
+  int stop = 0;
+  if (napi_create_arraybuffer(env, byte_length, &cycles, &buffer) != napi_ok ||
+      napi_create_typedarray(env, napi_biguint64_array, report->num_functions,
+                             buffer, 0, &argv[1]) != napi_ok ||
+      napi_create_int64(env, (int64_t)report->batch, &argv[0]) != napi_ok ||
+      napi_get_undefined(env, &undefined) != napi_ok) {
+    napi_close_handle_scope(env, scope);
+    return 0;
+  }
+  memcpy(cycles, report->cycles, byte_length);
+
+  if (napi_call_function(env, undefined, js_callback, 2, argv, &result) !=
+      napi_ok) {
+    // rethrown by the measure* call once the measurement has stopped
+    napi_value exception = NULL;
+    if (napi_get_and_clear_last_exception(env, &exception) == napi_ok) {
+      napi_create_reference(env, exception, 1, &instance->batch_exception);
+    }
+    stop = 1;
+  } else {
+    stop = is_stop(env, result);
+  }
+  napi_close_handle_scope(env, scope);
+  return stop;
+}
+
+// runs on the JS thread while measure_async waits in forward_batch, calls the
+// JS batch callback with @param data
+static void call_batch_callback(napi_env env, napi_value js_callback,
+                                void *context, void *data) {
+  struct binding_instance *instance = context;
+  struct batch_report *report = data;
+  // NULL when the function is released, then only the wait ends
+  const int stop = env != NULL && call_js(env, instance, js_callback, report);
+
+  pthread_mutex_lock(&instance->batch_lock);
+  report->stop = stop;
+  report->done = 1;
+  pthread_cond_broadcast(&instance->batch_done);
+  pthread_mutex_unlock(&instance->batch_lock);
+}
+
+// the ms_batch_callback, forwards the batch to JS. A stop from JS ends the
+// measurement after this batch.
+static enum ms_batch_callback_result
+forward_batch(void *ctx, size_t batch, const uint64_t *cycles,
+              size_t num_functions) {
+  struct binding_instance *instance = ctx;
+  struct batch_report report = {
+      .batch = batch, .num_functions = num_functions, .cycles = cycles};
+
+  if (pthread_equal(pthread_self(), instance->js_thread)) {
+    // measuring blocks the JS thread, a queued call would only run afterwards
+    napi_value js_callback = NULL;
+    report.stop = napi_get_reference_value(instance->env,
+                                           instance->batch_callback_ref,
+                                           &js_callback) == napi_ok &&
+                  call_js(instance->env, instance, js_callback, &report);
+  } else if (napi_call_threadsafe_function(instance->batch_callback, &report,
+                                           napi_tsfn_blocking) == napi_ok) {
+    pthread_mutex_lock(&instance->batch_lock);
+    while (!report.done) {
+      pthread_cond_wait(&instance->batch_done, &instance->batch_lock);
+    }
+    pthread_mutex_unlock(&instance->batch_lock);
+  }
+  return report.stop ? MS_BATCH_STOP : MS_BATCH_CONTINUE;
+}
+
+napi_value set_batch_callback(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+  struct binding_instance *instance = get_binding_instance(env);
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  release_batch_callback(env, instance);
+
+  // anything but a function (e.g. null) just disables it
+  napi_valuetype type = napi_undefined;
+  if (argc < 1 || napi_typeof(env, argv[0], &type) != napi_ok ||
+      type != napi_function) {
+    napi_value napi_result = NULL;
+    napi_create_int32(env, 0, &napi_result);
+    return napi_result;
+  }
+
+  napi_value resource_name = NULL;
+  if (napi_create_reference(env, argv[0], 1, &instance->batch_callback_ref) !=
+      napi_ok) {
+    instance->batch_callback_ref = NULL;
+    return throw_and_return_napi_val(env, "Unable to wrap batch callback.");
+  }
+  if (napi_create_string_utf8(env, "batch_callback", NAPI_AUTO_LENGTH,
+                              &resource_name) != napi_ok ||
+      napi_create_threadsafe_function(
+          env, argv[0], NULL, resource_name, 0, 1, NULL, NULL, instance,
+          call_batch_callback, &instance->batch_callback) != napi_ok) {
+    napi_delete_reference(env, instance->batch_callback_ref);
+    instance->batch_callback = NULL;
+    instance->batch_callback_ref = NULL;
+    return throw_and_return_napi_val(env, "Unable to wrap batch callback.");
+  }
+  instance->env = env;
+  instance->js_thread = pthread_self();
+  // it must not keep the event loop alive
+  napi_unref_threadsafe_function(env, instance->batch_callback);
+  ms_set_batch_callback(ms, forward_batch, instance);
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
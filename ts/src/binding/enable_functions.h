@@ -19,5 +19,14 @@
 #include <node/node_api.h>
 napi_value enable_checking(napi_env env, napi_callback_info info);
 napi_value enable_chunk_counting(napi_env env, napi_callback_info info);
+napi_value enable_asm_cache(napi_env env, napi_callback_info info);
+napi_value enable_incremental_assembly(napi_env env, napi_callback_info info);
+napi_value enable_result_cache(napi_env env, napi_callback_info info);
+napi_value enable_layout_randomization(napi_env env,
+                                       napi_callback_info info);
+napi_value set_memory_options(napi_env env, napi_callback_info info);
+napi_value set_aliasing(napi_env env, napi_callback_info info);
+napi_value set_working_set(napi_env env, napi_callback_info info);
+napi_value set_batch_callback(napi_env env, napi_callback_info info);
 
 #endif /* ENABLE_FUNCTIONS_H */
@@ -15,21 +15,109 @@
  */
 
 #include "helper.h"
+#include <stdlib.h>
 // NOLINTNEXTLINE (must declare hint as a valid callback for NODE_API)
 void finalise(napi_env env, void *finalise_data, void *finalize_hint) {
-  if (finalise_data != NULL && ms_terminate((measuresuite_t)finalise_data)) {
-    if (napi_throw_error(env, NULL, "ms_terminate didnt work.") != napi_ok) {
-      fprintf(stderr, "Unable to throw error.\n");
-    }
+  struct binding_instance *instance = finalise_data;
+  if (instance == NULL) {
+    return;
+  }
+  // a worker thread may still be measuring, it is safer to leak ms then
+  if (!instance->busy && instance->ms != NULL && ms_terminate(instance->ms)) {
+    fprintf(stderr, "ms_terminate didnt work.\n");
+  }
+  free(instance->asm_scratch);
+  pthread_mutex_destroy(&instance->batch_lock);
+  pthread_cond_destroy(&instance->batch_done);
+  free(instance);
+}
+
+void release_batch_callback(napi_env env, struct binding_instance *instance) {
+  if (instance->batch_callback == NULL) {
+    return;
+  }
+  napi_release_threadsafe_function(instance->batch_callback, napi_tsfn_abort);
+  napi_delete_reference(env, instance->batch_callback_ref);
+  instance->batch_callback = NULL;
+  instance->batch_callback_ref = NULL;
+  if (instance->ms != NULL) {
+    ms_set_batch_callback(instance->ms, NULL, NULL);
   }
 }
 
+napi_value take_batch_exception(napi_env env,
+                                struct binding_instance *instance) {
+  if (instance->batch_exception == NULL) {
+    return NULL;
+  }
+  napi_value exception = NULL;
+  napi_get_reference_value(env, instance->batch_exception, &exception);
+  napi_delete_reference(env, instance->batch_exception);
+  instance->batch_exception = NULL;
+  return exception;
+}
+
+struct binding_instance *get_binding_instance(napi_env env) {
+  void *instance_data = NULL;
+  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
+    return NULL;
+  }
+  if (instance_data != NULL) {
+    return instance_data;
+  }
+
+  struct binding_instance *instance = calloc(1, sizeof(*instance));
+  if (instance == NULL) {
+    return NULL;
+  }
+  if (pthread_mutex_init(&instance->batch_lock, NULL) != 0) {
+    free(instance);
+    return NULL;
+  }
+  if (pthread_cond_init(&instance->batch_done, NULL) != 0 ||
+      napi_set_instance_data(env, instance, &finalise, NULL) != napi_ok) {
+    pthread_mutex_destroy(&instance->batch_lock);
+    free(instance);
+    return NULL;
+  }
+  return instance;
+}
+
+measuresuite_t get_ms(napi_env env) {
+  void *instance_data = NULL;
+  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
+    throw_error_return_void(env, "Unable to get instance data.");
+    return NULL;
+  }
+
+  // not using throw_error_return_void, which would terminate ms
+  const char *msg = NULL;
+  struct binding_instance *instance = instance_data;
+  if (instance == NULL || instance->ms == NULL) {
+    msg = "Measuresuite instance is not initialised.";
+  } else if (instance->busy) {
+    msg = "Measuresuite instance is busy measuring.";
+  } else {
+    return instance->ms;
+  }
+  if (napi_throw_error(env, NULL, msg) != napi_ok) {
+    fprintf(stderr, "Unable to throw error.\n");
+  }
+  return NULL;
+}
+
 void throw_error_return_void(napi_env env, const char *msg) {
   // getting back the instance
   void *instance_data = NULL;
   if (napi_get_instance_data(env, &instance_data) == napi_ok) {
-    // and call finalise here (to not cause memory leaks)
-    finalise(env, instance_data, NULL);
+    // and terminate ms here (to not cause memory leaks)
+    struct binding_instance *instance = instance_data;
+    if (instance != NULL && !instance->busy && instance->ms != NULL) {
+      if (ms_terminate(instance->ms)) {
+        fprintf(stderr, "ms_terminate didnt work.\n");
+      }
+      instance->ms = NULL;
+    }
   } else {
     fprintf(stderr, "Unable to get instance data.\n");
   }
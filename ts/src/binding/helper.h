@@ -19,11 +19,57 @@
 
 #include <measuresuite.h>
 #include <node/node_api.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 
+// instance data of each napi_env
+struct binding_instance {
+  // NULL if not initialised or destroyed
+  measuresuite_t ms;
+  // set while measuring, synchronously or while a measure_async is in flight.
+  // Then, all other calls (e.g. from the batch callback) are rejected.
+  int busy;
+
+  // JS function called after each batch, NULL if there is none. Measuring on
+  // the JS thread of env calls it through batch_callback_ref right away,
+  // measure_async through batch_callback, and waits for it on batch_done.
+  napi_threadsafe_function batch_callback;
+  napi_ref batch_callback_ref;
+  napi_env env;
+  pthread_t js_thread;
+  pthread_mutex_t batch_lock;
+  pthread_cond_t batch_done;
+  // what the batch callback threw, which stopped the measurement. NULL if
+  // nothing, see take_batch_exception
+  napi_ref batch_exception;
+
+  // longest assembly string accepted, in chars, 0 for no limit
+  size_t max_asm_len;
+  // NUL-terminated copies of assembly strings are read into this buffer,
+  // which grows to the longest one read so far
+  char *asm_scratch;
+  size_t asm_scratch_size;
+};
+
+// releases the batch_callback of @param instance, if any, and unsets it in ms
+void release_batch_callback(napi_env env, struct binding_instance *instance);
+
+// @returns what the batch callback of @param instance threw during the last
+// measurement, and forgets it. NULL if it threw nothing.
+napi_value take_batch_exception(napi_env env,
+                                struct binding_instance *instance);
+
+// frees the binding_instance @param finalise_data, and terminates its ms
 void finalise(napi_env env, void *finalise_data, void *finalize_hint);
 
+// @returns the binding_instance of @param env, creates one if there is none
+struct binding_instance *get_binding_instance(napi_env env);
+
+// @returns the ms of @param env, or throws and returns NULL if there is none
+// or if it is measuring
+measuresuite_t get_ms(napi_env env);
+
 void throw_error_return_void(napi_env env, const char *msg);
 
 napi_value throw_and_return_napi_val(napi_env env, const char *msg);
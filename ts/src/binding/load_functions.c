@@ -19,42 +19,135 @@
 #include "helper.h"
 #include "measuresuite.h"
 #include <node/js_native_api.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// @returns NULL if @param len chars are an acceptable assembly string length
+// for @param instance, an error message otherwise
+static const char *check_asm_len(const struct binding_instance *instance,
+                                 size_t len) {
+  if (len == 0) {
+    return "Empty assembly string.";
+  }
+  if (instance->max_asm_len != 0 && len > instance->max_asm_len) {
+    return "Assembly string is longer than the maximum length, which can be "
+           "raised with set_max_asm_length.";
+  }
+  return NULL;
+}
+
+// makes sure the scratch buffer of @param instance can hold @param len chars
+// plus NUL
+static const char *reserve_scratch(struct binding_instance *instance,
+                                   size_t len) {
+  if (instance->asm_scratch_size > len) {
+    return NULL;
+  }
+  char *grown = realloc(instance->asm_scratch, len + 1);
+  if (grown == NULL) {
+    return "Unable to allocate memory for the assembly string.";
+  }
+  instance->asm_scratch = grown;
+  instance->asm_scratch_size = len + 1;
+  return NULL;
+}
+
+// points @param *text to the @param len bytes at @param data, NUL-terminated,
+// and sets @param *text_len to the number of chars. Data already ending in NUL
+// is used in place, other data is copied into the scratch buffer.
+// @returns NULL on success, an error message otherwise
+static const char *terminated_text(struct binding_instance *instance,
+                                   const uint8_t *data, size_t len,
+                                   const char **text, size_t *text_len) {
+  const size_t chars = len > 0 && data[len - 1] == '\0' ? len - 1 : len;
+  const char *err = check_asm_len(instance, chars);
+  if (err != NULL) {
+    return err;
+  }
+  *text_len = chars;
+  if (chars < len) {
+    *text = (const char *)data;
+    return NULL;
+  }
+  if ((err = reserve_scratch(instance, chars)) != NULL) {
+    return err;
+  }
+  memcpy(instance->asm_scratch, data, chars);
+  instance->asm_scratch[chars] = '\0';
+  *text = instance->asm_scratch;
+  return NULL;
+}
+
+// reads the assembly string or Uint8Array @param value NUL-terminated into
+// @param *text, which is @param *len chars long. Strings are read into the
+// scratch buffer of @param instance after querying their length.
+// @returns NULL on success, an error message otherwise
+static const char *read_asm_text(napi_env env,
+                                 struct binding_instance *instance,
+                                 napi_value value, const char **text,
+                                 size_t *len) {
+  napi_valuetype type = napi_undefined;
+  if (napi_typeof(env, value, &type) != napi_ok) {
+    return "Failed to parse an assembly string.";
+  }
+
+  if (type == napi_string) {
+    const char *err = NULL;
+    if (napi_get_value_string_latin1(env, value, NULL, 0, len) != napi_ok) {
+      return "Failed to read an assembly string.";
+    }
+    if ((err = check_asm_len(instance, *len)) != NULL ||
+        (err = reserve_scratch(instance, *len)) != NULL) {
+      return err;
+    }
+    if (napi_get_value_string_latin1(env, value, instance->asm_scratch,
+                                     instance->asm_scratch_size,
+                                     len) != napi_ok) {
+      return "Failed to read an assembly string.";
+    }
+    *text = instance->asm_scratch;
+    return NULL;
+  }
+
+  napi_typedarray_type array_type; // NOLINT
+  const uint8_t *data = NULL;
+  size_t byte_offset = 0;
+  if (napi_get_typedarray_info(env, value, &array_type, len, (void **)&data,
+                               NULL, &byte_offset) != napi_ok ||
+      array_type != napi_uint8_array) {
+    return "Assembly must be passed as a string or a Uint8Array.";
+  }
+  return terminated_text(instance, data, *len, text, len);
+}
 
 napi_value load_asm_string(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   const size_t argc_init = 1;
   size_t argc = argc_init;
 
   napi_value argv[argc]; // holds the values
 
-  char asm_string[max_len_asmstrings];
-
   // parse all args
   if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
     return throw_and_return_napi_val(env, "Failed to parse arguments");
 
   // parse asmString
-  size_t read_bytes = 0;
-  if (napi_get_value_string_latin1(env, *argv, asm_string, max_len_asmstrings,
-                                   &read_bytes) != napi_ok // read
-      || read_bytes == 0                      // none read err check
-      || read_bytes == max_len_asmstrings - 1 // too long err check
-
-  ) {
-    return throw_and_return_napi_val(env,
-                                     "Invalid assemblyString was passed as "
-                                     "argument 0, may have been too long.");
+  const char *asm_string = NULL;
+  size_t len = 0;
+  const char *err =
+      read_asm_text(env, get_binding_instance(env), argv[0], &asm_string, &len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
   }
 
   // load Asm data in instance
   int idAsm = -1;
-  if (ms_load_data(ms, ASM, (uint8_t *)asm_string, read_bytes, NULL, &idAsm) !=
+  if (ms_load_data(ms, ASM, (const uint8_t *)asm_string, len, NULL, &idAsm) !=
       0) {
     ms_fprintf_error(ms, stderr);
     return throw_and_return_napi_val(
@@ -66,6 +159,50 @@ napi_value load_asm_string(napi_env env, napi_callback_info info) {
   return napi_result;
 }
 
+napi_value replace_asm_string(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // parse id
+  int id = -1;
+  if (napi_get_value_int32(env, argv[0], &id) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid id was passed as argument 0");
+  }
+
+  // parse asmString
+  const char *asm_string = NULL;
+  size_t len = 0;
+  const char *err =
+      read_asm_text(env, get_binding_instance(env), argv[1], &asm_string, &len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  // replace the code of function id in place
+  if (ms_replace_code(ms, id, ASM, (const uint8_t *)asm_string, len) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(
+        env, "MS error'ed while replacing with assemblyString.");
+  };
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, id, &napi_result);
+  return napi_result;
+}
+
 napi_value load_asm_file(napi_env env, napi_callback_info info) {
 
   const size_t argc_init = 1;
@@ -81,10 +218,10 @@ napi_value load_asm_file(napi_env env, napi_callback_info info) {
 
   // parse asmString
   size_t read_bytes = 0;
-  if (napi_get_value_string_latin1(env, *argv, asm_file, max_len_asmstrings,
+  if (napi_get_value_string_latin1(env, *argv, asm_file, max_len_paths,
                                    &read_bytes) != napi_ok // read
-      || read_bytes == 0                      // none read err check
-      || read_bytes == max_len_asmstrings - 1 // too long err check
+      || read_bytes == 0                 // none read err check
+      || read_bytes == max_len_paths - 1 // too long err check
 
   ) {
     return throw_and_return_napi_val(env,
@@ -93,11 +230,10 @@ napi_value load_asm_file(napi_env env, napi_callback_info info) {
   }
 
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   // load Asm data in instance
   int idAsm = -1;
@@ -114,11 +250,10 @@ napi_value load_asm_file(napi_env env, napi_callback_info info) {
 
 napi_value load_bin_file(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   const size_t argc_init = 1;
   size_t argc = argc_init;
@@ -156,54 +291,157 @@ napi_value load_bin_file(napi_env env, napi_callback_info info) {
   return napi_result;
 }
 
-napi_value load_elf_file(napi_env env, napi_callback_info info) {
+// @returns the bytes of the Uint8Array @param value in @param *data, or an
+// error message
+static const char *get_code_bytes(napi_env env, napi_value value,
+                                  const uint8_t **data, size_t *len) {
+  napi_typedarray_type type; // NOLINT
+  size_t byte_offset = 0;
+  if (napi_get_typedarray_info(env, value, &type, len, (void **)data, NULL,
+                               &byte_offset) != napi_ok ||
+      type != napi_uint8_array) {
+    return "Machine code must be passed as a Uint8Array.";
+  }
+  return *len == 0 ? "Empty machine code." : NULL;
+}
+
+napi_value load_bin_buffer(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
-  const size_t argc_init = 2;
+  const size_t argc_init = 1;
   size_t argc = argc_init;
 
   napi_value argv[argc]; // holds the values
 
-  char elf_filename[max_len_paths];
-  char elf_symbol[max_len_symbol];
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // parse code, not copied until it lands in the code slot
+  const uint8_t *code = NULL;
+  size_t len = 0;
+  const char *err = get_code_bytes(env, argv[0], &code, &len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  // load bin data in instance
+  int id_bin = -1;
+  if (ms_load_data(ms, BIN, code, len, NULL, &id_bin) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not load machine code to MS.");
+  };
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, id_bin, &napi_result);
+  return napi_result;
+}
+
+napi_value replace_bin_buffer(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
 
   // parse all args
   if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
     return throw_and_return_napi_val(env, "Failed to parse arguments");
 
+  // parse id
+  int id = -1;
+  if (napi_get_value_int32(env, argv[0], &id) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid id was passed as argument 0");
+  }
+
+  // parse code
+  const uint8_t *code = NULL;
+  size_t len = 0;
+  const char *err = get_code_bytes(env, argv[1], &code, &len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  // replace the code of function id in place
+  if (ms_replace_code(ms, id, BIN, code, len) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(
+        env, "MS error'ed while replacing with machine code.");
+  };
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, id, &napi_result);
+  return napi_result;
+}
+
+// parses a path and a symbol, which may be empty, into @param filename
+// (max_len_paths chars) and @param symbol (max_len_symbol chars).
+// @returns an error message or NULL
+static const char *get_path_and_symbol(napi_env env, napi_callback_info info,
+                                       char *filename, char *symbol,
+                                       size_t *symbol_len) {
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return "Failed to parse arguments";
+
   // parse filename
   size_t read_bytes = 0;
-  if (napi_get_value_string_latin1(env, argv[0], elf_filename, max_len_paths,
+  if (napi_get_value_string_latin1(env, argv[0], filename, max_len_paths,
                                    &read_bytes) != napi_ok // read
       || read_bytes == 0                 // none read err check
       || read_bytes == max_len_paths - 1 // too long err check
 
   ) {
-    return throw_and_return_napi_val(env,
-                                     "Invalid elf filename was passed as "
-                                     "argument 0, may have been too long.");
+    return "Invalid filename was passed as argument 0, may have been too "
+           "long.";
   }
 
   // parse symbol name
-  if (napi_get_value_string_latin1(env, argv[1], elf_symbol, max_len_symbol,
-                                   &read_bytes) != napi_ok // read
+  if (napi_get_value_string_latin1(env, argv[1], symbol, max_len_symbol,
+                                   symbol_len) != napi_ok // read
       // may have been empty, which is ok
-      || read_bytes == max_len_symbol - 1 // too long err check
+      || *symbol_len == max_len_symbol - 1 // too long err check
 
   ) {
-    return throw_and_return_napi_val(env,
-                                     "Invalid elf symbol was passed as "
-                                     "argument 1, may have been too long.");
+    return "Invalid symbol was passed as argument 1, may have been too long.";
+  }
+  return NULL;
+}
+
+napi_value load_elf_file(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  char elf_filename[max_len_paths];
+  char elf_symbol[max_len_symbol];
+  size_t symbol_len = 0;
+  const char *err =
+      get_path_and_symbol(env, info, elf_filename, elf_symbol, &symbol_len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
   }
 
   // load elf data in instance
   int id_elf = -1;
-  if (ms_load_file(ms, ELF, elf_filename, read_bytes == 0 ? NULL : elf_symbol,
+  if (ms_load_file(ms, ELF, elf_filename, symbol_len == 0 ? NULL : elf_symbol,
                    &id_elf) != 0) {
     ms_fprintf_error(ms, stderr);
     return throw_and_return_napi_val(env, "Could not load elf file to MS.");
@@ -214,13 +452,92 @@ napi_value load_elf_file(napi_env env, napi_callback_info info) {
   return napi_result;
 }
 
+// @returns the array [@param first_id, ..., @param first_id + @param num - 1]
+static napi_value create_id_range(napi_env env, int first_id, size_t num) {
+  napi_value napi_result = NULL;
+  if (napi_create_array_with_length(env, num, &napi_result) != napi_ok) {
+    return throw_and_return_napi_val(env, "Unable to create the result array.");
+  }
+  for (size_t i = 0; i < num; i++) {
+    napi_value napi_id = NULL;
+    if (napi_create_int32(env, first_id + (int)i, &napi_id) != napi_ok ||
+        napi_set_element(env, napi_result, i, napi_id) != napi_ok) {
+      return throw_and_return_napi_val(env, "Unable to set the result array.");
+    }
+  }
+  return napi_result;
+}
+
+napi_value load_archive_file(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  char filename[max_len_paths];
+  char symbol[max_len_symbol];
+  size_t symbol_len = 0;
+  const char *err =
+      get_path_and_symbol(env, info, filename, symbol, &symbol_len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  if (ms_load_archive(ms, filename, symbol_len == 0 ? NULL : symbol,
+                      &first_id, &num_loaded) != 0) {
+    ms_fprintf_error(ms, stderr);
+    // don't leave some of them loaded
+    while (num_loaded-- > 0) {
+      ms_unload_last(ms);
+    }
+    return throw_and_return_napi_val(env, "Could not load archive to MS.");
+  }
+
+  return create_id_range(env, first_id, num_loaded);
+}
+
+napi_value load_shared_object_matching(napi_env env,
+                                       napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  char filename[max_len_paths];
+  char pattern[max_len_symbol];
+  size_t pattern_len = 0;
+  const char *err =
+      get_path_and_symbol(env, info, filename, pattern, &pattern_len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  int first_id = -1;
+  size_t num_loaded = 0;
+  if (ms_load_so_matching(ms, filename, pattern_len == 0 ? "*" : pattern,
+                          &first_id, &num_loaded) != 0) {
+    ms_fprintf_error(ms, stderr);
+    // don't leave some of them loaded
+    while (num_loaded-- > 0) {
+      ms_unload_last(ms);
+    }
+    return throw_and_return_napi_val(env,
+                                     "Could not load shared object to MS.");
+  }
+
+  return create_id_range(env, first_id, num_loaded);
+}
+
 napi_value load_shared_object_file(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   const size_t argc_init = 2;
   size_t argc = argc_init;
@@ -270,13 +587,61 @@ napi_value load_shared_object_file(napi_env env, napi_callback_info info) {
   return napi_result;
 }
 
+napi_value load_shared_object_buffer(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // parse the library, it is written to a memfd straight from here
+  const uint8_t *data = NULL;
+  size_t len = 0;
+  const char *err = get_code_bytes(env, argv[0], &data, &len);
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+
+  char so_symbol[max_len_symbol];
+  size_t read_bytes = 0;
+  if (napi_get_value_string_latin1(env, argv[1], so_symbol, max_len_symbol,
+                                   &read_bytes) != napi_ok // read
+      || read_bytes == 0                  // none read err check
+      || read_bytes == max_len_symbol - 1 // too long err check
+
+  ) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid so symbolname was passed as "
+                                     "argument 1, may have been too long.");
+  }
+
+  int id_so = -1;
+  if (ms_load_data(ms, SHARED_OBJECT, data, len, so_symbol, &id_so) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env,
+                                     "Could not load shared object to MS.");
+  };
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, id_so, &napi_result);
+  return napi_result;
+}
+
 napi_value unload_last(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   // unload_last function in instance
   if (ms_unload_last(ms) != 0) {
@@ -292,11 +657,10 @@ napi_value unload_last(napi_env env, napi_callback_info info) {
 
 napi_value unload_all(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-  measuresuite_t ms = (measuresuite_t)instance_data;
 
   if (ms_unload_all(ms)) {
     ms_fprintf_error(ms, stderr);
@@ -307,3 +671,252 @@ napi_value unload_all(napi_env env, napi_callback_info info) {
   napi_create_int32(env, 0, &napi_result);
   return napi_result;
 }
+
+// input of load_many / replace_many: either an array of strings / Uint8Arrays,
+// or one Uint8Array with the start offsets of each function in a Uint32Array.
+struct many_input {
+  napi_value array; // NULL if concatenated
+  const uint8_t *data;
+  size_t data_len;
+  const uint32_t *offsets;
+  size_t count;
+};
+
+// @returns NULL on success, an error message otherwise
+static const char *parse_many(napi_env env, napi_value input,
+                              napi_value offsets, struct many_input *dest) {
+  memset(dest, 0, sizeof(*dest));
+
+  bool is_array = false;
+  if (napi_is_array(env, input, &is_array) != napi_ok) {
+    return "Failed to parse functions.";
+  }
+  if (is_array) {
+    uint32_t count = 0;
+    if (napi_get_array_length(env, input, &count) != napi_ok) {
+      return "Failed to get the length of the functions array.";
+    }
+    dest->array = input;
+    dest->count = count;
+    return NULL;
+  }
+
+  napi_typedarray_type type; // NOLINT as there is no non-init'ed type.
+  size_t byte_offset = 0;
+  if (napi_get_typedarray_info(env, input, &type, &dest->data_len,
+                               (void **)&dest->data, NULL,
+                               &byte_offset) != napi_ok ||
+      type != napi_uint8_array) {
+    return "Functions must be an array or a Uint8Array.";
+  }
+  if (napi_get_typedarray_info(env, offsets, &type, &dest->count,
+                               (void **)&dest->offsets, NULL,
+                               &byte_offset) != napi_ok ||
+      type != napi_uint32_array) {
+    return "Offsets must be a Uint32Array when passing one buffer.";
+  }
+  for (size_t i = 0; i < dest->count; i++) {
+    uint32_t end = i + 1 < dest->count ? dest->offsets[i + 1] : dest->data_len;
+    if (dest->offsets[i] > end || end > dest->data_len) {
+      return "Offsets must be ascending and within the buffer.";
+    }
+  }
+  return NULL;
+}
+
+// reads function @param i of @param input NUL-terminated into @param *text,
+// which is @param *len chars long
+static const char *get_nth(napi_env env, struct binding_instance *instance,
+                           const struct many_input *input, size_t i,
+                           const char **text, size_t *len) {
+  if (input->array == NULL) {
+    const size_t start = input->offsets[i];
+    const size_t end =
+        i + 1 < input->count ? input->offsets[i + 1] : input->data_len;
+    return terminated_text(instance, input->data + start, end - start, text,
+                           len);
+  }
+
+  napi_value element = NULL;
+  if (napi_get_element(env, input->array, i, &element) != napi_ok) {
+    return "Failed to get an element of the functions array.";
+  }
+  return read_asm_text(env, instance, element, text, len);
+}
+
+napi_value load_many(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  struct many_input input;
+  const char *err = parse_many(env, argv[0], argv[1], &input);
+  napi_value napi_result = NULL;
+  if (err == NULL &&
+      napi_create_array_with_length(env, input.count, &napi_result) !=
+          napi_ok) {
+    err = "Unable to create the result array.";
+  }
+
+  struct binding_instance *instance = get_binding_instance(env);
+  const char *asm_string = NULL;
+  size_t len = 0;
+  size_t loaded = 0;
+  while (err == NULL && loaded < input.count) {
+    err = get_nth(env, instance, &input, loaded, &asm_string, &len);
+    if (err != NULL) {
+      break;
+    }
+
+    int id = -1;
+    if (ms_load_data(ms, ASM, (const uint8_t *)asm_string, len, NULL, &id) !=
+        0) {
+      ms_fprintf_error(ms, stderr);
+      err = "MS error'ed while loading assemblyString.";
+      break;
+    }
+
+    napi_value napi_id = NULL;
+    if (napi_create_int32(env, id, &napi_id) != napi_ok ||
+        napi_set_element(env, napi_result, loaded, napi_id) != napi_ok) {
+      err = "Unable to set the result array.";
+    }
+    loaded++;
+  }
+
+  if (err != NULL) {
+    // don't leave some of them loaded
+    while (loaded-- > 0) {
+      ms_unload_last(ms);
+    }
+    return throw_and_return_napi_val(env, err);
+  }
+  return napi_result;
+}
+
+napi_value replace_many(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 3;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  struct many_input input;
+  const char *err = parse_many(env, argv[1], argv[2], &input);
+  uint32_t num_ids = 0;
+  if (err == NULL && (napi_get_array_length(env, argv[0], &num_ids) !=
+                          napi_ok ||
+                      num_ids != input.count)) {
+    err = "Ids must be an array of the same length as functions.";
+  }
+
+  struct binding_instance *instance = get_binding_instance(env);
+  const char *asm_string = NULL;
+  size_t len = 0;
+  for (size_t i = 0; err == NULL && i < input.count; i++) {
+    napi_value napi_id = NULL;
+    int id = -1;
+    if (napi_get_element(env, argv[0], i, &napi_id) != napi_ok ||
+        napi_get_value_int32(env, napi_id, &id) != napi_ok) {
+      err = "Invalid id in the ids array.";
+      break;
+    }
+    err = get_nth(env, instance, &input, i, &asm_string, &len);
+    if (err == NULL && ms_replace_code(ms, id, ASM,
+                                       (const uint8_t *)asm_string, len) != 0) {
+      ms_fprintf_error(ms, stderr);
+      err = "MS error'ed while replacing with assemblyString.";
+    }
+  }
+
+  if (err != NULL) {
+    return throw_and_return_napi_val(env, err);
+  }
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value unload_many(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  uint32_t count = 0;
+  if (napi_get_value_uint32(env, argv[0], &count) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid count was passed as argument 0");
+  }
+
+  // unload the last count functions
+  for (uint32_t i = 0; i < count; i++) {
+    if (ms_unload_last(ms) != 0) {
+      ms_fprintf_error(ms, stderr);
+      return throw_and_return_napi_val(env, "Could not unload functions.");
+    }
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value set_max_asm_length(napi_env env, napi_callback_info info) {
+  // getting back the instance
+  if (get_ms(env) == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // parse the length, 0 lifts the limit
+  double max_len = 0;
+  if (napi_get_value_double(env, argv[0], &max_len) != napi_ok ||
+      !(max_len >= 0) || max_len > (double)SIZE_MAX) {
+    return throw_and_return_napi_val(
+        env, "Invalid maximum length was passed as argument 0");
+  }
+  get_binding_instance(env)->max_asm_len = (size_t)max_len;
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
@@ -19,12 +19,24 @@
 #include <node/node_api.h>
 
 napi_value load_asm_string(napi_env env, napi_callback_info info);
+napi_value replace_asm_string(napi_env env, napi_callback_info info);
 napi_value load_asm_file(napi_env env, napi_callback_info info);
 napi_value load_bin_file(napi_env env, napi_callback_info info);
+napi_value load_bin_buffer(napi_env env, napi_callback_info info);
+napi_value replace_bin_buffer(napi_env env, napi_callback_info info);
 napi_value load_elf_file(napi_env env, napi_callback_info info);
+napi_value load_archive_file(napi_env env, napi_callback_info info);
+napi_value load_shared_object_matching(napi_env env, napi_callback_info info);
+napi_value load_shared_object_buffer(napi_env env, napi_callback_info info);
 napi_value load_shared_object_file(napi_env env, napi_callback_info info);
 
+napi_value load_many(napi_env env, napi_callback_info info);
+napi_value replace_many(napi_env env, napi_callback_info info);
+
 napi_value unload_all(napi_env env, napi_callback_info info);
 napi_value unload_last(napi_env env, napi_callback_info info);
+napi_value unload_many(napi_env env, napi_callback_info info);
+
+napi_value set_max_asm_length(napi_env env, napi_callback_info info);
 
 #endif /* LOAD_FUNCTIONS_H */
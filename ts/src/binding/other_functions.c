@@ -13,12 +13,20 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+// CPU_SET and pthread_setaffinity_np
+#define _GNU_SOURCE
+
 #include "other_functions.h"
+#include "constants.h"
 #include "helper.h"
 #include "measuresuite.h"
 #include <node/js_native_api.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 void init(napi_env env, napi_callback_info info) {
   const size_t argc_init = 3;
   size_t argc = argc_init;
@@ -49,6 +57,16 @@ void init(napi_env env, napi_callback_info info) {
     return throw_error_return_void(
         env, "Invalid num_arg_out was passed as argument 2");
 
+  struct binding_instance *instance = get_binding_instance(env);
+  if (instance == NULL) {
+    return throw_error_return_void(
+        env, "Unable to get / set instance data / finalize_cb.");
+  }
+  if (instance->busy) {
+    return throw_error_return_void(env,
+                                   "Measuresuite instance is busy measuring.");
+  }
+
   // execute measure_init
   measuresuite_t ms = NULL;
   if (ms_initialize(&ms, arg_width, num_arg_in, num_arg_out) != 0) {
@@ -57,39 +75,43 @@ void init(napi_env env, napi_callback_info info) {
                                    "Unable to create measuresuite instance.");
   }
 
-  // save the measuresuite_t handle in as the instance data. and set the
-  // finalise callback to call ms_teminate
-  if (napi_set_instance_data(env, ms, &finalise, NULL) != napi_ok) {
-    return throw_error_return_void(
-        env, "Unable to set instance data / finalize_cb.");
+  // save the measuresuite_t handle in the instance data. Its finalise
+  // callback calls ms_teminate. A previous instance is replaced.
+  release_batch_callback(env, instance);
+  if (instance->ms != NULL && ms_terminate(instance->ms)) {
+    fprintf(stderr, "ms_terminate didnt work.\n");
   }
+  instance->ms = ms;
+  instance->max_asm_len = default_max_len_asmstrings;
 }
 napi_value destroy(napi_env env, napi_callback_info info) {
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
+  struct binding_instance *instance = get_binding_instance(env);
+  if (instance == NULL) {
     return throw_and_return_napi_val(env, "Unable to get instance data.");
   }
-
-  measuresuite_t ms = (measuresuite_t)instance_data;
-  if (ms != NULL && ms_terminate(ms)) {
-    throw_and_return_napi_val(env, "Unable to destroy measuresuite instance.");
+  if (instance->busy) {
+    // not via throw_and_return_napi_val, which would terminate ms
+    napi_throw_error(env, NULL, "Measuresuite instance is busy measuring.");
+    return NULL;
   }
-  if (napi_set_instance_data(env, NULL, &finalise, NULL) != napi_ok) {
-    throw_and_return_napi_val(env, "Unable to set instance_data to NULL.");
+
+  release_batch_callback(env, instance);
+  if (instance->ms != NULL && ms_terminate(instance->ms)) {
+    instance->ms = NULL;
+    return throw_and_return_napi_val(env,
+                                     "Unable to destroy measuresuite instance.");
   }
+  instance->ms = NULL;
   napi_value napi_result = NULL;
   napi_create_int32(env, 0, &napi_result);
   return napi_result;
 }
 
 napi_value get_timer(napi_env env, napi_callback_info info) {
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok &&
-      instance_data != NULL) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
-
-  measuresuite_t ms = (measuresuite_t)instance_data;
   enum TIMER timer = ms_get_timer(ms);
   napi_value napi_result = NULL;
 
@@ -105,15 +127,173 @@ napi_value get_timer(napi_env env, napi_callback_info info) {
   return napi_result;
 }
 
+// @returns { hits: number, misses: number }
+static napi_value create_stats(napi_env env, uint64_t hits, uint64_t misses) {
+  napi_value napi_result = NULL;
+  napi_value napi_hits = NULL;
+  napi_value napi_misses = NULL;
+  if (napi_create_object(env, &napi_result) != napi_ok ||
+      napi_create_int64(env, (int64_t)hits, &napi_hits) != napi_ok ||
+      napi_create_int64(env, (int64_t)misses, &napi_misses) != napi_ok ||
+      napi_set_named_property(env, napi_result, "hits", napi_hits) !=
+          napi_ok ||
+      napi_set_named_property(env, napi_result, "misses", napi_misses) !=
+          napi_ok) {
+    return throw_and_return_napi_val(env, "Unable to create stats object.");
+  }
+  return napi_result;
+}
+
+napi_value get_asm_cache_stats(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  ms_get_asm_cache_stats(ms, &hits, &misses);
+  return create_stats(env, hits, misses);
+}
+
+napi_value get_result_cache_stats(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  ms_get_result_cache_stats(ms, &hits, &misses);
+  return create_stats(env, hits, misses);
+}
+
+// calls @param save_or_load with the filename passed as argument 0
+static napi_value result_cache_file(napi_env env, napi_callback_info info,
+                                    int (*save_or_load)(measuresuite_t,
+                                                        const char *)) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  char filename[max_len_paths];
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // parse filename
+  size_t read_bytes = 0;
+  if (napi_get_value_string_latin1(env, argv[0], filename, max_len_paths,
+                                   &read_bytes) != napi_ok // read
+      || read_bytes == 0                 // none read err check
+      || read_bytes == max_len_paths - 1 // too long err check
+
+  ) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid result cache filename was "
+                                     "passed as argument 0, may have been too "
+                                     "long.");
+  }
+
+  if (save_or_load(ms, filename) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env,
+                                     "Could not save / load result cache.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_int32(env, 0, &napi_result);
+  return napi_result;
+}
+
+napi_value save_result_cache(napi_env env, napi_callback_info info) {
+  return result_cache_file(env, info, ms_result_cache_save);
+}
+
+napi_value load_result_cache(napi_env env, napi_callback_info info) {
+  return result_cache_file(env, info, ms_result_cache_load);
+}
+
+static const char *const page_size_names[] = {"SMALL", "TRANSPARENT_HUGE",
+                                              "HUGE"};
+
+// @returns { codePages: string, dataPages: string, locked: boolean }
+napi_value get_memory_status(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  struct ms_memory_status status;
+  if (ms_get_memory_status(ms, &status) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not get the memory status.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_value code_pages = NULL;
+  napi_value data_pages = NULL;
+  napi_value locked = NULL;
+  if (napi_create_object(env, &napi_result) != napi_ok ||
+      napi_create_string_latin1(env, page_size_names[status.code_pages],
+                                NAPI_AUTO_LENGTH, &code_pages) != napi_ok ||
+      napi_create_string_latin1(env, page_size_names[status.data_pages],
+                                NAPI_AUTO_LENGTH, &data_pages) != napi_ok ||
+      napi_get_boolean(env, status.locked != 0, &locked) != napi_ok ||
+      napi_set_named_property(env, napi_result, "codePages", code_pages) !=
+          napi_ok ||
+      napi_set_named_property(env, napi_result, "dataPages", data_pages) !=
+          napi_ok ||
+      napi_set_named_property(env, napi_result, "locked", locked) != napi_ok) {
+    return throw_and_return_napi_val(env, "Could not create the status.");
+  }
+  return napi_result;
+}
+
+napi_value get_assembly_time(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 1;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  int32_t id = -1;
+  if (napi_get_value_int32(env, argv[0], &id) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid id was passed as argument 0");
+  }
+
+  uint64_t ns = 0;
+  if (ms_get_assembly_time(ms, id, &ns) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not get assembly time.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_create_double(env, (double)ns, &napi_result);
+  return napi_result;
+}
+
 napi_value binding_set_bounds(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
 
-  measuresuite_t ms = (measuresuite_t)instance_data;
-
   const size_t argc_setBounds = 1;
   size_t argc = argc_setBounds;
 
@@ -156,15 +336,93 @@ napi_value binding_set_bounds(napi_env env, napi_callback_info info) {
   return napi_result;
 };
 
+napi_value binding_set_placement(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 3;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  int32_t id = -1;
+  if (napi_get_value_int32(env, argv[0], &id) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid id was passed as argument 0");
+  }
+  uint32_t alignment = 0;
+  if (napi_get_value_uint32(env, argv[1], &alignment) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid alignment was passed as argument 1");
+  }
+  uint32_t offset = 0;
+  if (napi_get_value_uint32(env, argv[2], &offset) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid offset was passed as argument 2");
+  }
+
+  if (ms_set_placement(ms, id, alignment, offset) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set the placement.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_get_undefined(env, &napi_result);
+  return napi_result;
+}
+
+napi_value set_data_offsets(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_init = 2;
+  size_t argc = argc_init;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  // -1 for both restores the compact layout
+  int32_t in_offset = -1;
+  if (napi_get_value_int32(env, argv[0], &in_offset) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid input offset was passed as argument 0");
+  }
+  int32_t out_offset = -1;
+  if (napi_get_value_int32(env, argv[1], &out_offset) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid output offset was passed as argument 1");
+  }
+
+  if (ms_set_data_offsets(
+          ms, in_offset < 0 ? MS_DATA_OFFSET_COMPACT : (size_t)in_offset,
+          out_offset < 0 ? MS_DATA_OFFSET_COMPACT : (size_t)out_offset) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not set the data offsets.");
+  }
+
+  napi_value napi_result = NULL;
+  napi_get_undefined(env, &napi_result);
+  return napi_result;
+}
+
 napi_value measure(napi_env env, napi_callback_info info) {
   // getting back the instance
-  void *instance_data = NULL;
-  if (napi_get_instance_data(env, &instance_data) != napi_ok) {
-    return throw_and_return_napi_val(env, "Unable to get instance data.");
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
   }
 
-  measuresuite_t ms = (measuresuite_t)instance_data;
-
   const size_t argc_measure = 2;
   size_t argc = argc_measure;
 
@@ -187,7 +445,17 @@ napi_value measure(napi_env env, napi_callback_info info) {
         env, "Invalid number of batches was passed as argument 1");
   }
 
-  if (ms_measure(ms, batch_size, num_batches) != 0) {
+  struct binding_instance *instance = get_binding_instance(env);
+  // the batch callback runs JS meanwhile, get_ms rejects what it calls
+  instance->busy = 1;
+  const int ret = ms_measure(ms, batch_size, num_batches);
+  instance->busy = 0;
+  napi_value exception = take_batch_exception(env, instance);
+  if (exception != NULL) {
+    napi_throw(env, exception);
+    return NULL;
+  }
+  if (ret != 0) {
     ms_fprintf_error(ms, stderr);
     return throw_and_return_napi_val(env, "Could not measure.");
   };
@@ -201,3 +469,596 @@ napi_value measure(napi_env env, napi_callback_info info) {
 
   return napi_result;
 };
+
+// NOLINTNEXTLINE (must declare hint as a valid callback for NODE_API)
+static void free_cycles(napi_env env, void *finalise_data,
+                        void *finalize_hint) {
+  free(finalise_data);
+}
+
+static const char *const type_names[] = {"ASM", "BIN", "ELF", "SHARED_OBJECT"};
+
+// sets the named property @param key of @param object to @param value
+static int set_int64(napi_env env, napi_value object, const char *key,
+                     int64_t value) {
+  napi_value napi_value = NULL;
+  return napi_create_int64(env, value, &napi_value) != napi_ok ||
+         napi_set_named_property(env, object, key, napi_value) != napi_ok;
+}
+
+static int set_string(napi_env env, napi_value object, const char *key,
+                      const char *value) {
+  napi_value napi_value = NULL;
+  return napi_create_string_latin1(env, value, NAPI_AUTO_LENGTH,
+                                   &napi_value) != napi_ok ||
+         napi_set_named_property(env, object, key, napi_value) != napi_ok;
+}
+
+/**
+ * Takes the cycles of the last measurement from @param ms and sets
+ * @param dest to an object like the JSON, but with a BigUint64Array per
+ * function in "cycles". Those are views on one external ArrayBuffer, which
+ * frees the cycles once it is garbage collected.
+ * @returns 0 on success. On failure, an exception may be pending.
+ */
+static int create_typed_result(napi_env env, measuresuite_t ms,
+                               napi_value *dest) {
+  // the cycles are taken below, all else is read from res
+  const struct ms_results *res = NULL;
+  uint64_t *cycles = NULL;
+  size_t num_functions = 0;
+  size_t num_batches = 0;
+  if (ms_get_results(ms, MS_RESULTS_VERSION, &res) != 0 ||
+      ms_take_cycles(ms, &cycles, &num_functions, &num_batches) != 0) {
+    ms_fprintf_error(ms, stderr);
+    return 1;
+  }
+
+  const size_t byte_length = num_functions * num_batches * sizeof(uint64_t);
+  napi_value buffer = NULL;
+  napi_status status = napi_create_external_arraybuffer(
+      env, cycles, byte_length, free_cycles, NULL, &buffer);
+  if (status == napi_no_external_buffers_allowed) {
+    // e.g. with the V8 sandbox. Fall back to copying.
+    void *data = NULL;
+    status = napi_create_arraybuffer(env, byte_length, &data, &buffer);
+    if (status == napi_ok) {
+      memcpy(data, cycles, byte_length);
+    }
+    free(cycles);
+  } else if (status != napi_ok) {
+    free(cycles);
+  }
+  if (status != napi_ok) {
+    return 1;
+  }
+
+  napi_value result = NULL;
+  napi_value stats = NULL;
+  napi_value functions = NULL;
+  napi_value cycle_views = NULL;
+  if (napi_create_object(env, &result) != napi_ok ||
+      napi_create_object(env, &stats) != napi_ok ||
+      napi_create_array_with_length(env, num_functions, &functions) !=
+          napi_ok ||
+      napi_create_array_with_length(env, num_functions, &cycle_views) !=
+          napi_ok ||
+      set_int64(env, stats, "numFunctions", (int64_t)num_functions) ||
+      set_int64(env, stats, "numBatches", (int64_t)num_batches) ||
+      set_int64(env, stats, "runtime", (int64_t)res->runtime) ||
+      set_int64(env, stats, "incorrect", (int64_t)res->incorrect) ||
+      set_string(env, stats, "timer", res->timer == PMC ? "PMC" : "RDTSCP") ||
+      napi_set_named_property(env, result, "stats", stats) != napi_ok ||
+      napi_set_named_property(env, result, "functions", functions) !=
+          napi_ok ||
+      napi_set_named_property(env, result, "cycles", cycle_views) != napi_ok) {
+    return 1;
+  }
+
+  for (size_t i = 0; i < num_functions; i++) {
+    const struct ms_function_result *fct = &res->functions[i];
+    napi_value function = NULL;
+    napi_value view = NULL;
+    if (napi_create_object(env, &function) != napi_ok ||
+        set_string(env, function, "type", type_names[fct->type]) ||
+        (fct->type == ASM && set_int64(env, function, "chunks", fct->chunks)) ||
+        (fct->type != SHARED_OBJECT &&
+         set_int64(env, function, "codeSize", (int64_t)fct->code_size)) ||
+        (fct->member != NULL &&
+         set_string(env, function, "member", fct->member)) ||
+        napi_set_element(env, functions, i, function) != napi_ok ||
+        napi_create_typedarray(env, napi_biguint64_array, num_batches, buffer,
+                               i * num_batches * sizeof(uint64_t),
+                               &view) != napi_ok ||
+        napi_set_element(env, cycle_views, i, view) != napi_ok) {
+      return 1;
+    }
+  }
+
+  *dest = result;
+  return 0;
+}
+
+napi_value measure_typed(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_measure = 2;
+  size_t argc = argc_measure;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+  int32_t batch_size = 0;
+  if (napi_get_value_int32(env, argv[0], &batch_size) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid batch size was passed as argument 0");
+  }
+  int32_t num_batches = 0;
+  if (napi_get_value_int32(env, argv[1], &num_batches) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of batches was passed as argument 1");
+  }
+
+  struct binding_instance *instance = get_binding_instance(env);
+  // the batch callback runs JS meanwhile, get_ms rejects what it calls
+  instance->busy = 1;
+  const int ret = ms_measure(ms, batch_size, num_batches);
+  instance->busy = 0;
+  napi_value exception = take_batch_exception(env, instance);
+  if (exception != NULL) {
+    napi_throw(env, exception);
+    return NULL;
+  }
+  if (ret != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not measure.");
+  };
+
+  napi_value napi_result = NULL;
+  if (create_typed_result(env, ms, &napi_result) != 0) {
+    return throw_and_return_napi_val(env, "Could not create the results.");
+  }
+  return napi_result;
+}
+
+/**
+ * Sets @param dest to { window, offsets: number[], medians: number[][],
+ * functions: { min, max, median, best, moved: boolean }[] } of @param sweep,
+ * with one row of medians per offset.
+ * @returns 0 on success. On failure, an exception may be pending.
+ */
+static int create_sweep_result(napi_env env,
+                               const struct ms_sweep_results *sweep,
+                               napi_value *dest) {
+  napi_value result = NULL;
+  napi_value offsets = NULL;
+  napi_value medians = NULL;
+  napi_value functions = NULL;
+  if (napi_create_object(env, &result) != napi_ok ||
+      napi_create_array_with_length(env, sweep->num_offsets, &offsets) !=
+          napi_ok ||
+      napi_create_array_with_length(env, sweep->num_offsets, &medians) !=
+          napi_ok ||
+      napi_create_array_with_length(env, sweep->num_functions, &functions) !=
+          napi_ok ||
+      set_int64(env, result, "window", (int64_t)sweep->window) ||
+      napi_set_named_property(env, result, "offsets", offsets) != napi_ok ||
+      napi_set_named_property(env, result, "medians", medians) != napi_ok ||
+      napi_set_named_property(env, result, "functions", functions) !=
+          napi_ok) {
+    return 1;
+  }
+
+  for (size_t i = 0; i < sweep->num_offsets; i++) {
+    napi_value offset = NULL;
+    napi_value row = NULL;
+    if (napi_create_int64(env, (int64_t)sweep->offsets[i], &offset) !=
+            napi_ok ||
+        napi_set_element(env, offsets, i, offset) != napi_ok ||
+        napi_create_array_with_length(env, sweep->num_functions, &row) !=
+            napi_ok ||
+        napi_set_element(env, medians, i, row) != napi_ok) {
+      return 1;
+    }
+    for (size_t f = 0; f < sweep->num_functions; f++) {
+      napi_value median = NULL;
+      if (napi_create_int64(
+              env, (int64_t)sweep->medians[i * sweep->num_functions + f],
+              &median) != napi_ok ||
+          napi_set_element(env, row, f, median) != napi_ok) {
+        return 1;
+      }
+    }
+  }
+
+  for (size_t f = 0; f < sweep->num_functions; f++) {
+    const struct ms_sweep_function *fct = &sweep->functions[f];
+    napi_value function = NULL;
+    napi_value moved = NULL;
+    if (napi_create_object(env, &function) != napi_ok ||
+        set_int64(env, function, "min", (int64_t)fct->min) ||
+        set_int64(env, function, "max", (int64_t)fct->max) ||
+        set_int64(env, function, "median", (int64_t)fct->median) ||
+        set_int64(env, function, "best", (int64_t)fct->best) ||
+        napi_get_boolean(env, fct->moved != 0, &moved) != napi_ok ||
+        napi_set_named_property(env, function, "moved", moved) != napi_ok ||
+        napi_set_element(env, functions, f, function) != napi_ok) {
+      return 1;
+    }
+  }
+
+  *dest = result;
+  return 0;
+}
+
+napi_value measure_sweep(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_measure = 4;
+  size_t argc = argc_measure;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+  int32_t batch_size = 0;
+  if (napi_get_value_int32(env, argv[0], &batch_size) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid batch size was passed as argument 0");
+  }
+  int32_t num_batches = 0;
+  if (napi_get_value_int32(env, argv[1], &num_batches) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of batches was passed as argument 1");
+  }
+  uint32_t window = 0;
+  if (napi_get_value_uint32(env, argv[2], &window) != napi_ok) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid window was passed as argument 2");
+  }
+  uint32_t num_offsets = 0;
+  if (napi_get_value_uint32(env, argv[3], &num_offsets) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of offsets was passed as argument 3");
+  }
+
+  const struct ms_sweep_results *sweep = NULL;
+  struct binding_instance *instance = get_binding_instance(env);
+  // the batch callback runs JS meanwhile, get_ms rejects what it calls
+  instance->busy = 1;
+  const int ret = ms_measure_sweep(ms, batch_size, num_batches, window,
+                                   num_offsets, &sweep);
+  instance->busy = 0;
+  napi_value exception = take_batch_exception(env, instance);
+  if (exception != NULL) {
+    napi_throw(env, exception);
+    return NULL;
+  }
+  if (ret != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not measure.");
+  }
+
+  napi_value napi_result = NULL;
+  if (create_sweep_result(env, sweep, &napi_result) != 0) {
+    return throw_and_return_napi_val(env, "Could not create the results.");
+  }
+  return napi_result;
+}
+
+napi_value measure_data_sweep(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_measure = 3;
+  size_t argc = argc_measure;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+  int32_t batch_size = 0;
+  if (napi_get_value_int32(env, argv[0], &batch_size) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid batch size was passed as argument 0");
+  }
+  int32_t num_batches = 0;
+  if (napi_get_value_int32(env, argv[1], &num_batches) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of batches was passed as argument 1");
+  }
+  uint32_t num_offsets = 0;
+  if (napi_get_value_uint32(env, argv[2], &num_offsets) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of offsets was passed as argument 2");
+  }
+
+  const struct ms_sweep_results *sweep = NULL;
+  struct binding_instance *instance = get_binding_instance(env);
+  // the batch callback runs JS meanwhile, get_ms rejects what it calls
+  instance->busy = 1;
+  const int ret = ms_measure_data_sweep(ms, batch_size, num_batches,
+                                        num_offsets, &sweep);
+  instance->busy = 0;
+  napi_value exception = take_batch_exception(env, instance);
+  if (exception != NULL) {
+    napi_throw(env, exception);
+    return NULL;
+  }
+  if (ret != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not measure.");
+  }
+
+  napi_value napi_result = NULL;
+  if (create_sweep_result(env, sweep, &napi_result) != 0) {
+    return throw_and_return_napi_val(env, "Could not create the results.");
+  }
+  return napi_result;
+}
+
+/**
+ * sets @param dest to { levels: { level, cacheSize, workingSet }[],
+ * cyclesPerCall: number[][] } of @param sweep, cyclesPerCall[l][f] being that
+ * of function f at levels[l].
+ */
+static int create_working_set_result(napi_env env,
+                                     const struct ms_working_set_results *sweep,
+                                     napi_value *dest) {
+  napi_value result = NULL;
+  napi_value levels = NULL;
+  napi_value cycles_per_call = NULL;
+  if (napi_create_object(env, &result) != napi_ok ||
+      napi_create_array_with_length(env, sweep->num_levels, &levels) !=
+          napi_ok ||
+      napi_create_array_with_length(env, sweep->num_levels,
+                                    &cycles_per_call) != napi_ok ||
+      napi_set_named_property(env, result, "levels", levels) != napi_ok ||
+      napi_set_named_property(env, result, "cyclesPerCall", cycles_per_call) !=
+          napi_ok) {
+    return 1;
+  }
+
+  for (size_t l = 0; l < sweep->num_levels; l++) {
+    const struct ms_working_set_level *level = &sweep->levels[l];
+    napi_value napi_level = NULL;
+    napi_value row = NULL;
+    if (napi_create_object(env, &napi_level) != napi_ok ||
+        set_int64(env, napi_level, "level", level->level) ||
+        set_int64(env, napi_level, "cacheSize", (int64_t)level->cache_size) ||
+        set_int64(env, napi_level, "workingSet", (int64_t)level->working_set) ||
+        napi_set_element(env, levels, l, napi_level) != napi_ok ||
+        napi_create_array_with_length(env, sweep->num_functions, &row) !=
+            napi_ok ||
+        napi_set_element(env, cycles_per_call, l, row) != napi_ok) {
+      return 1;
+    }
+    for (size_t f = 0; f < sweep->num_functions; f++) {
+      napi_value cycles = NULL;
+      if (napi_create_double(
+              env, sweep->cycles_per_call[l * sweep->num_functions + f],
+              &cycles) != napi_ok ||
+          napi_set_element(env, row, f, cycles) != napi_ok) {
+        return 1;
+      }
+    }
+  }
+
+  *dest = result;
+  return 0;
+}
+
+napi_value measure_working_set_sweep(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+
+  const size_t argc_measure = 2;
+  size_t argc = argc_measure;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+  int32_t batch_size = 0;
+  if (napi_get_value_int32(env, argv[0], &batch_size) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid batch size was passed as argument 0");
+  }
+  int32_t num_batches = 0;
+  if (napi_get_value_int32(env, argv[1], &num_batches) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of batches was passed as argument 1");
+  }
+
+  const struct ms_working_set_results *sweep = NULL;
+  struct binding_instance *instance = get_binding_instance(env);
+  // the batch callback runs JS meanwhile, get_ms rejects what it calls
+  instance->busy = 1;
+  const int ret =
+      ms_measure_working_set_sweep(ms, batch_size, num_batches, &sweep);
+  instance->busy = 0;
+  napi_value exception = take_batch_exception(env, instance);
+  if (exception != NULL) {
+    napi_throw(env, exception);
+    return NULL;
+  }
+  if (ret != 0) {
+    ms_fprintf_error(ms, stderr);
+    return throw_and_return_napi_val(env, "Could not measure.");
+  }
+
+  napi_value napi_result = NULL;
+  if (create_working_set_result(env, sweep, &napi_result) != 0) {
+    return throw_and_return_napi_val(env, "Could not create the results.");
+  }
+  return napi_result;
+}
+
+// one measure_async call, lives until its promise is settled
+struct measure_async_work {
+  struct binding_instance *instance;
+  napi_async_work work;
+  napi_deferred deferred;
+  int32_t batch_size;
+  int32_t num_batches;
+  // core to pin the worker thread to while measuring, -1 to not pin it
+  int32_t cpu;
+  // NULL on success, otherwise the message to reject with
+  const char *error;
+};
+
+// runs on a libuv worker thread, must not call into napi
+static void measure_async_execute(napi_env env, void *data) {
+  struct measure_async_work *work = data;
+
+  // the worker threads are shared, hence restore its affinity afterwards
+  pthread_t self = pthread_self();
+  cpu_set_t previous;
+  const int pin = work->cpu >= 0;
+  if (pin) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(work->cpu, &cpus);
+    if (pthread_getaffinity_np(self, sizeof(previous), &previous) != 0 ||
+        pthread_setaffinity_np(self, sizeof(cpus), &cpus) != 0) {
+      work->error = "Could not pin the measuring thread to the given cpu.";
+      return;
+    }
+  }
+
+  if (ms_measure(work->instance->ms, work->batch_size, work->num_batches) !=
+      0) {
+    ms_fprintf_error(work->instance->ms, stderr);
+    work->error = "Could not measure.";
+  }
+
+  if (pin) {
+    pthread_setaffinity_np(self, sizeof(previous), &previous);
+  }
+}
+
+// rejects @param deferred with an Error of @param msg
+static void reject_with_message(napi_env env, napi_deferred deferred,
+                                const char *msg) {
+  napi_value napi_msg = NULL;
+  napi_value error = NULL;
+  napi_create_string_utf8(env, msg, NAPI_AUTO_LENGTH, &napi_msg);
+  napi_create_error(env, NULL, napi_msg, &error);
+  napi_reject_deferred(env, deferred, error);
+}
+
+// runs on the JS thread, settles the promise
+static void measure_async_complete(napi_env env, napi_status status,
+                                   void *data) {
+  struct measure_async_work *work = data;
+  work->instance->busy = 0;
+
+  if (status != napi_ok && work->error == NULL) {
+    work->error = "Measuring was cancelled.";
+  }
+
+  napi_value napi_result = NULL;
+  napi_value exception = take_batch_exception(env, work->instance);
+  if (exception == NULL && work->error == NULL &&
+      create_typed_result(env, work->instance->ms, &napi_result) != 0) {
+    work->error = "Could not create the results.";
+  }
+  if (exception != NULL) {
+    // what the batch callback threw
+    napi_reject_deferred(env, work->deferred, exception);
+  } else if (work->error == NULL) {
+    napi_resolve_deferred(env, work->deferred, napi_result);
+  } else {
+    reject_with_message(env, work->deferred, work->error);
+  }
+
+  napi_delete_async_work(env, work->work);
+  free(work);
+}
+
+napi_value measure_async(napi_env env, napi_callback_info info) {
+  measuresuite_t ms = get_ms(env);
+  if (ms == NULL) {
+    return NULL;
+  }
+  struct binding_instance *instance = get_binding_instance(env);
+
+  const size_t argc_measure = 3;
+  size_t argc = argc_measure;
+
+  napi_value argv[argc]; // holds the values
+
+  // parse all args
+  if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok)
+    return throw_and_return_napi_val(env, "Failed to parse arguments");
+
+  int32_t batch_size = 0;
+  if (napi_get_value_int32(env, argv[0], &batch_size) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid batch size was passed as argument 0");
+  }
+  int32_t num_batches = 0;
+  if (napi_get_value_int32(env, argv[1], &num_batches) != napi_ok) {
+    return throw_and_return_napi_val(
+        env, "Invalid number of batches was passed as argument 1");
+  }
+  // cpu is optional
+  int32_t cpu = -1;
+  if (argc > 2 && (napi_get_value_int32(env, argv[2], &cpu) != napi_ok ||
+                   cpu >= CPU_SETSIZE)) {
+    return throw_and_return_napi_val(env,
+                                     "Invalid cpu was passed as argument 2");
+  }
+
+  struct measure_async_work *work = calloc(1, sizeof(*work));
+  if (work == NULL) {
+    return throw_and_return_napi_val(env, "Unable to allocate async work.");
+  }
+  work->instance = instance;
+  work->batch_size = batch_size;
+  work->num_batches = num_batches;
+  work->cpu = cpu;
+
+  napi_value promise = NULL;
+  if (napi_create_promise(env, &work->deferred, &promise) != napi_ok) {
+    free(work);
+    return throw_and_return_napi_val(env, "Unable to create async work.");
+  }
+
+  // from here on, failing settles the promise
+  napi_value resource_name = NULL;
+  if (napi_create_string_utf8(env, "measure_async", NAPI_AUTO_LENGTH,
+                              &resource_name) != napi_ok ||
+      napi_create_async_work(env, NULL, resource_name, measure_async_execute,
+                             measure_async_complete, work,
+                             &work->work) != napi_ok) {
+    reject_with_message(env, work->deferred, "Unable to create async work.");
+    free(work);
+    return promise;
+  }
+
+  if (napi_queue_async_work(env, work->work) != napi_ok) {
+    reject_with_message(env, work->deferred, "Unable to queue async work.");
+    napi_delete_async_work(env, work->work);
+    free(work);
+    return promise;
+  }
+  instance->busy = 1;
+
+  return promise;
+}
@@ -19,8 +19,21 @@
 #include <node/node_api.h>
 void init(napi_env env, napi_callback_info info);
 napi_value binding_set_bounds(napi_env env, napi_callback_info info);
+napi_value binding_set_placement(napi_env env, napi_callback_info info);
+napi_value set_data_offsets(napi_env env, napi_callback_info info);
 napi_value measure(napi_env env, napi_callback_info info);
+napi_value measure_typed(napi_env env, napi_callback_info info);
+napi_value measure_sweep(napi_env env, napi_callback_info info);
+napi_value measure_data_sweep(napi_env env, napi_callback_info info);
+napi_value measure_working_set_sweep(napi_env env, napi_callback_info info);
+napi_value measure_async(napi_env env, napi_callback_info info);
 napi_value destroy(napi_env env, napi_callback_info info);
 napi_value get_timer(napi_env env, napi_callback_info info);
+napi_value get_asm_cache_stats(napi_env env, napi_callback_info info);
+napi_value get_memory_status(napi_env env, napi_callback_info info);
+napi_value get_assembly_time(napi_env env, napi_callback_info info);
+napi_value get_result_cache_stats(napi_env env, napi_callback_info info);
+napi_value save_result_cache(napi_env env, napi_callback_info info);
+napi_value load_result_cache(napi_env env, napi_callback_info info);
 
 #endif /* OTHER_FUNCTIONS_H */
@@ -14,8 +14,28 @@
  * limitations under the License.
  */
 
-import type { MeasureResult, AsmFunctionSummary, FunctionSummary, FunctionType } from "./measure.interface";
+import type {
+  MeasureResult,
+  TypedMeasureResult,
+  SweepResult,
+  WorkingSetResult,
+  MemoryStatus,
+  PageSize,
+  AsmFunctionSummary,
+  FunctionSummary,
+  FunctionType,
+} from "./measure.interface";
 import { Measuresuite, native_ms } from "./measuresuite";
 
-export type { MeasureResult, AsmFunctionSummary, FunctionSummary, FunctionType };
+export type {
+  MeasureResult,
+  TypedMeasureResult,
+  SweepResult,
+  WorkingSetResult,
+  MemoryStatus,
+  PageSize,
+  AsmFunctionSummary,
+  FunctionSummary,
+  FunctionType,
+};
 export { Measuresuite, native_ms };
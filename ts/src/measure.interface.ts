@@ -26,7 +26,8 @@ export interface MeasureResult {
   //  "functions": [
   //    {
   //      "type": "ASM",
-  //      "chunks": 0
+  //      "chunks": 0,
+  //      "codeSize": 10
   //    },
   //    {
   //      "type": "SHARED_OBJECT"
@@ -48,13 +49,61 @@ export interface MeasureResult {
 
   cycles: number[][];
 }
+/**
+ * Same as MeasureResult, but without going through JSON:
+ * cycles[i] is a view on the cycles of function i, as measured by the native module.
+ */
+export interface TypedMeasureResult {
+  stats: MeasureResult["stats"] & {
+    numBatches: number;
+  };
+  functions: FunctionSummary[];
+
+  cycles: BigUint64Array[];
+}
+
+/**
+ * Result of measureSweep(): medians[i][f] is the median cycle count of function f, with all functions placed offsets[i] bytes into
+ * the window. Per function, best is the index of the offset with the smallest median. Functions which could not be moved
+ * (moved: false) ran at the same address at each offset.
+ */
+export interface SweepResult {
+  window: number;
+  offsets: number[];
+  medians: number[][];
+  functions: { min: number; max: number; median: number; best: number; moved: boolean }[];
+}
+
+/**
+ * Result of measureWorkingSetSweep(): cyclesPerCall[l][f] is the median number of cycles per call of function f, striding through a
+ * working set of levels[l].workingSet bytes, half of that cache level's size. The last level (level 0, cacheSize 0) is memory.
+ */
+export interface WorkingSetResult {
+  levels: { level: number; cacheSize: number; workingSet: number }[];
+  cyclesPerCall: number[][];
+}
+
+/**
+ * What the memory is backed by, see Measuresuite.setMemoryOptions(). TRANSPARENT_HUGE means at least part of it is in transparent
+ * huge pages, codePages is the smallest of all code chunks. locked: the code, inputs and outputs are mlocked.
+ */
+export type PageSize = "SMALL" | "TRANSPARENT_HUGE" | "HUGE";
+export interface MemoryStatus {
+  codePages: PageSize;
+  dataPages: PageSize;
+  locked: boolean;
+}
+
 export type FunctionSummary =
-  | BaseSummary<"ELF">
-  | BaseSummary<"BIN">
+  | ElfFunctionSummary
+  | CodeSummary<"BIN">
   | BaseSummary<"SHARED_OBJECT">
   | AsmFunctionSummary;
 
-export type AsmFunctionSummary = BaseSummary<"ASM"> & { chunks: number };
+export type AsmFunctionSummary = CodeSummary<"ASM"> & { chunks: number };
+
+// member: the archive member it has been loaded from, see loadArchive()
+export type ElfFunctionSummary = CodeSummary<"ELF"> & { member?: string };
 
 export type FunctionType = "ASM" | "BIN" | "ELF" | "SHARED_OBJECT";
 
@@ -62,6 +111,9 @@ interface BaseSummary<T extends FunctionType> {
   type: T;
 }
 
+// codeSize: bytes of machine code measured (not known for shared objects)
+type CodeSummary<T extends FunctionType> = BaseSummary<T> & { codeSize: number };
+
 /**
  * example:
 {
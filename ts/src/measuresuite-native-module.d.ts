@@ -18,20 +18,90 @@
 declare module "measuresuite-native-module" {
   function init(argWidth: number, numArgIn: number, numArgOut: number): void;
 
-  function load_asm_string(assembly: string): number; // returns id of where the function has been loaded into
+  // assembly may also be passed as latin1 bytes, which are used without copying if they end in a NUL
+  function load_asm_string(assembly: string | Uint8Array): number; // returns id of where the function has been loaded into
+  function replace_asm_string(id: number, assembly: string | Uint8Array): number; // replaces the code of an already loaded function, returns id
   function load_asm_file(path: string): number;
   function load_bin_file(path: string): number;
+  function load_bin_buffer(code: Uint8Array): number; // machine code, copied into the code slot
+  function replace_bin_buffer(id: number, code: Uint8Array): number; // replaces the code of an already loaded function, returns id
   function load_elf_file(path: string, symbol: string): number; // empty symbol string if none was passed. Parameter cannot be 'undefined'
-  function load_shared_object_file(path: string, symbol: string): number;
+  function load_archive_file(path: string, symbol: string): number[]; // from each member (.a), all functions for an empty symbol. Returns their ids
+  function load_shared_object_file(path: string, symbol: string): number; // each library is opened once, however many symbols are loaded from it
+  function load_shared_object_matching(path: string, pattern: string): number[]; // exported functions matching the fnmatch(3) pattern, all for an empty one. Returns their ids
+  function load_shared_object_buffer(library: Uint8Array, symbol: string): number; // the contents of a .so, dlopen'ed from a memfd without touching the disk
+
+  // loads all functions as ASM, either from an array, or from one buffer with the start offset of each function. Returns their ids.
+  function load_many(functions: (string | Uint8Array)[]): number[];
+  function load_many(functions: Uint8Array, offsets: Uint32Array): number[];
+  // replaces the code of the functions with ids[i] with functions[i]
+  function replace_many(ids: number[], functions: (string | Uint8Array)[]): number;
+  function replace_many(ids: number[], functions: Uint8Array, offsets: Uint32Array): number;
+  function set_max_asm_length(maxLength: number): void; // in chars, 0 for no limit. Defaults to 1024000
 
   function unload_all(): number;
   function unload_last(): number;
+  function unload_many(count: number): number; // unloads the last count functions
 
   function enable_checking(): void;
   function enable_chunk_counting(chunkSize: number): void;
+  function enable_asm_cache(numEntries: number): void; // 0 disables
+  function enable_incremental_assembly(numLines: number): void; // 0 disables
+  function enable_result_cache(numEntries: number, topUpBatches: number): void; // 0 entries disables
+  // moves the code to a random byte of codeWindow and the data to a random cache line of dataWindow before each batch. 0, 0 disables
+  function enable_layout_randomization(codeWindow: number, dataWindow: number, requireMovable: boolean): void;
+  // backs code, inputs and outputs with huge pages and / or mlocks them, falling back to normal pages. See get_memory_status
+  function set_memory_options(hugePages: boolean, lock: boolean): void;
+  // aliases[j]: the in argument out argument j is passed in place of, -1 for none. null disables it
+  function set_aliasing(aliases: number[] | null): void;
+  // strides call by call through a pool of bytes of inputs and outputs, 0 disables it
+  function set_working_set(bytes: number): void;
+  // called after each batch with one sample per function. Returning true or "stop" stops the measurement early.
+  // Live for all measure calls, whose measurement stops on what it throws, which they then throw. null disables it.
+  function set_batch_callback(callback: ((batch: number, cycles: BigUint64Array) => boolean | "stop" | void) | null): void;
   function set_bounds(bounds: BigUint64Array): void;
+  // places the code offset bytes after a multiple of alignment (a power of two up to 4096), 0 / 0 for the default
+  function set_placement(id: number, alignment: number, offset: number): void;
+  // inOffset / outOffset bytes into pages of their own, -1 and -1 restore the compact default
+  function set_data_offsets(inOffset: number, outOffset: number): void;
   function get_timer(): 0 | 1 | -1; //0: uses pmc, 1: uses RDTSCP; -1: fail
+  function get_asm_cache_stats(): { hits: number; misses: number };
+  type PageSize = "SMALL" | "TRANSPARENT_HUGE" | "HUGE";
+  type MemoryStatus = { codePages: PageSize; dataPages: PageSize; locked: boolean };
+  function get_memory_status(): MemoryStatus; // what the memory is actually backed by
+  function get_assembly_time(id: number): number; // in ns, of the last load into id
+  function get_result_cache_stats(): { hits: number; misses: number };
+  function save_result_cache(path: string): void;
+  function load_result_cache(path: string): void;
+
+  // like the JSON, but cycles are views on the native memory. See TypedMeasureResult
+  type TypedResult = {
+    stats: { numFunctions: number; numBatches: number; runtime: number; incorrect: number; timer: "PMC" | "RDTSCP" };
+    functions: { type: "ASM" | "BIN" | "ELF" | "SHARED_OBJECT"; chunks?: number; codeSize?: number; member?: string }[];
+    cycles: BigUint64Array[];
+  };
 
   function measure(batchSize: number, numBatches: number): string;
+  function measure_typed(batchSize: number, numBatches: number): TypedResult;
+  // medians[i][f]: median cycles of function f with all functions at offsets[i] into the window. best indexes offsets
+  type SweepResult = {
+    window: number;
+    offsets: number[];
+    medians: number[][];
+    functions: { min: number; max: number; median: number; best: number; moved: boolean }[];
+  };
+  // measures at numOffsets placements spread over window bytes, see set_placement
+  function measure_sweep(batchSize: number, numBatches: number, window: number, numOffsets: number): SweepResult;
+  // measures at numOffsets distances of the outputs from the inputs, spread over 4096 bytes, see set_data_offsets
+  function measure_data_sweep(batchSize: number, numBatches: number, numOffsets: number): SweepResult;
+  // cyclesPerCall[l][f]: median cycles per call of function f with a working set in levels[l]. level 0 is memory
+  type WorkingSetResult = {
+    levels: { level: number; cacheSize: number; workingSet: number }[];
+    cyclesPerCall: number[][];
+  };
+  // measures with a working set in each cache level of cpu0 and in memory, see set_working_set
+  function measure_working_set_sweep(batchSize: number, numBatches: number): WorkingSetResult;
+  // measures on a worker thread, optionally pinned to cpu
+  function measure_async(batchSize: number, numBatches: number, cpu?: number): Promise<TypedResult>;
   function destroy(): number;
 }
@@ -23,28 +23,66 @@ const require = createRequire(import.meta.url);
 const ms = require("measuresuite-native-module");
 declare function assert(value: unknown): asserts value;
 
-import type { MeasureResult, FunctionType } from "./measure.interface";
+import type {
+  MeasureResult,
+  TypedMeasureResult,
+  SweepResult,
+  WorkingSetResult,
+  MemoryStatus,
+  FunctionType,
+} from "./measure.interface";
 
 // use with caution
 export const native_ms = {
   init: ms.init,
 
   load_asm_string: ms.load_asm_string,
+  replace_asm_string: ms.replace_asm_string,
+  load_many: ms.load_many,
+  replace_many: ms.replace_many,
+  set_max_asm_length: ms.set_max_asm_length,
   load_asm_file: ms.load_asm_file,
   load_bin_file: ms.load_bin_file,
+  load_bin_buffer: ms.load_bin_buffer,
+  replace_bin_buffer: ms.replace_bin_buffer,
   load_elf_file: ms.load_elf_file,
+  load_archive_file: ms.load_archive_file,
   load_shared_object_file: ms.load_shared_object_file,
+  load_shared_object_matching: ms.load_shared_object_matching,
+  load_shared_object_buffer: ms.load_shared_object_buffer,
 
   unload_all: ms.unload_all,
   unload_last: ms.unload_last,
+  unload_many: ms.unload_many,
 
   enable_checking: ms.enable_checking,
   enable_chunk_counting: ms.enable_chunk_counting,
+  enable_asm_cache: ms.enable_asm_cache,
+  enable_incremental_assembly: ms.enable_incremental_assembly,
+  enable_result_cache: ms.enable_result_cache,
+  enable_layout_randomization: ms.enable_layout_randomization,
+  set_memory_options: ms.set_memory_options,
+  set_aliasing: ms.set_aliasing,
+  set_working_set: ms.set_working_set,
+  set_batch_callback: ms.set_batch_callback,
   set_bounds: ms.set_bounds,
+  set_placement: ms.set_placement,
+  set_data_offsets: ms.set_data_offsets,
 
   measure: ms.measure,
+  measure_typed: ms.measure_typed,
+  measure_sweep: ms.measure_sweep,
+  measure_data_sweep: ms.measure_data_sweep,
+  measure_working_set_sweep: ms.measure_working_set_sweep,
+  measure_async: ms.measure_async,
   destroy: ms.destroy,
   get_timer: ms.get_timer,
+  get_asm_cache_stats: ms.get_asm_cache_stats,
+  get_memory_status: ms.get_memory_status,
+  get_assembly_time: ms.get_assembly_time,
+  get_result_cache_stats: ms.get_result_cache_stats,
+  save_result_cache: ms.save_result_cache,
+  load_result_cache: ms.load_result_cache,
 };
 
 export class Measuresuite {
@@ -110,9 +148,22 @@ export class Measuresuite {
   }
 
   public destroy(): number {
+    this.asmSlots = [];
     return ms.destroy();
   }
 
+  // ids of the functions measure() has loaded asm strings into. They are kept
+  // loaded between calls and always are the last ones.
+  private asmSlots: number[] = [];
+
+  // unloads the slots of measure(), until only @param keep of them are left
+  private releaseAsmSlots(keep = 0): void {
+    if (this.asmSlots.length > keep) {
+      ms.unload_many(this.asmSlots.length - keep);
+      this.asmSlots.length = keep;
+    }
+  }
+
   // mapping tables
   private ft2load = new Map<FunctionType, (filename: string, symbol: string) => void>();
 
@@ -128,6 +179,119 @@ export class Measuresuite {
     ms.enable_checking();
   }
 
+  /**
+   * Calls @param callback after each batch with the fresh sample of each function, in load order.
+   * If it returns true or "stop", the measurement ends after that batch; results then only hold the batches run so far.
+   * It is called live for measure(), measureTyped() and measureAsync(), which waits for it after each batch.
+   * The instance is busy measuring meanwhile, it must not be used from the callback.
+   * If it throws, the measurement stops and the measure call throws with its message (measureAsync() rejects).
+   * null disables it.
+   */
+  public onBatch(callback: ((batch: number, cycles: BigUint64Array) => boolean | "stop" | void) | null): void {
+    ms.set_batch_callback(callback);
+  }
+
+  /**
+   * Rejects asm strings longer than @param maxLength chars, 1024000 by default. 0 lifts the limit.
+   */
+  public setMaxAsmLength(maxLength: number): void {
+    ms.set_max_asm_length(maxLength);
+  }
+
+  /**
+   * Caches the machine code of up to @param numEntries asm strings, such that measuring the same string again skips assembling.
+   * 0 disables the cache.
+   */
+  public enableAsmCache(numEntries: number): void {
+    ms.enable_asm_cache(numEntries);
+  }
+
+  public get asmCacheStats(): { hits: number; misses: number } {
+    return ms.get_asm_cache_stats();
+  }
+
+  /**
+   * Memoizes the encoding of up to @param numLines asm lines, such that only changed lines are assembled in measure().
+   * 0 disables incremental assembly.
+   */
+  public enableIncrementalAssembly(numLines: number): void {
+    ms.enable_incremental_assembly(numLines);
+  }
+
+  /**
+   * Remembers the cycles of up to @param numEntries functions, such that measuring the same machine code again (with the same parameters) reports the stored cycles.
+   * Such functions are still measured in @param topUpBatches batches, whose results replace the oldest stored ones.
+   * 0 entries disables the cache.
+   */
+  public enableResultCache(numEntries: number, topUpBatches = 0): void {
+    ms.enable_result_cache(numEntries, topUpBatches);
+  }
+
+  /**
+   * Before each batch, moves the code of each function to a random byte offset into @param codeWindow bytes, and the inputs and
+   * outputs to random cache lines of @param dataWindow bytes, such that the cycles do not depend on one particular layout.
+   * Both are powers of two up to 4096 (the data window at least 64), 0 keeps that part in place. enableLayoutRandomization(0, 0)
+   * disables it. ELF code with aligned sections (e.g. .rodata of SSE code) moves by multiples of that alignment. Shared
+   * objects and ELF code with absolute addresses into itself stay in place, or fail the measurement if @param requireMovable
+   * is set.
+   */
+  public enableLayoutRandomization(codeWindow = 64, dataWindow = 4096, requireMovable = false): void {
+    ms.enable_layout_randomization(codeWindow, dataWindow, requireMovable);
+  }
+
+  /**
+   * Backs the code and the inputs and outputs with 2 MiB pages (explicit ones if the system has some reserved, transparent ones if
+   * not) if @param hugePages is set, and mlocks them and the cycles if @param lock is set, to keep TLB misses and page faults out
+   * of the measurements. Falls back to normal pages if the system cannot provide them; memoryStatus tells what was obtained.
+   * Set it before loading code, such that the code arena can be mapped anew.
+   */
+  public setMemoryOptions({ hugePages = false, lock = false }: { hugePages?: boolean; lock?: boolean }): void {
+    ms.set_memory_options(hugePages, lock);
+  }
+
+  /**
+   * Calls the functions in place: out argument j is passed the same pointer as in argument @param aliases[j] (counting from 0,
+   * -1 for a buffer of its own), e.g. [0] for f(out, in1) with out == in1. The aliased inputs are restored before each call,
+   * which is then timed on its own. Checking compares the results of the functions called in place.
+   * Without arguments, each out argument gets a buffer of its own again.
+   */
+  public setAliasing(aliases: number[] | null = null): void {
+    ms.set_aliasing(aliases);
+  }
+
+  /**
+   * Strides call by call through a pool of @param bytes of inputs and outputs instead of reusing one set, to measure memory-bound
+   * functions at L2, L3 or memory working sets. The inputs are random (within the bounds) and refilled before each measurement.
+   * 0 goes back to reusing one set. With checking, the results of one more, untimed call on the normal inputs are compared.
+   */
+  public setWorkingSet(bytes: number): void {
+    ms.set_working_set(bytes);
+  }
+
+  public get memoryStatus(): MemoryStatus {
+    return ms.get_memory_status() as MemoryStatus;
+  }
+
+  public get resultCacheStats(): { hits: number; misses: number } {
+    return ms.get_result_cache_stats();
+  }
+
+  public saveResultCache(filename: string): void {
+    ms.save_result_cache(filename);
+  }
+
+  // the result cache must be enabled
+  public loadResultCache(filename: string): void {
+    ms.load_result_cache(filename);
+  }
+
+  /**
+   * Time in nanoseconds it took to assemble each of the functions of the last measure() call.
+   */
+  public get assemblyTimes(): number[] {
+    return this.asmSlots.map((id) => ms.get_assembly_time(id));
+  }
+
   public loadFile({
     filename,
     filetype,
@@ -146,12 +310,64 @@ export class Measuresuite {
         );
       }
     }
+    // files go before the slots of measure()
+    this.releaseAsmSlots();
     // load the file with the appropriate filetype
     const loadFunction = this.ft2load.get(filetype);
     assert(loadFunction);
     loadFunction(filename, functionSymbol ?? "");
   }
 
+  /**
+   * Loads @param functionSymbol from each member of the static archive @param filename (*.a) which defines it, or all functions of all members if it is omitted.
+   * The results report each one's member name.
+   * @returns the ids of the loaded functions
+   */
+  public loadArchive(filename: string, functionSymbol?: string): number[] {
+    // archives go before the slots of measure()
+    this.releaseAsmSlots();
+    return ms.load_archive_file(filename, functionSymbol ?? "");
+  }
+
+  /**
+   * Loads every function the shared object @param filename (*.so) exports whose name matches @param pattern,
+   * a shell wildcard like "array_*", or all of them if it is omitted. The library is opened only once.
+   * @returns the ids of the loaded functions
+   */
+  public loadSharedObject(filename: string, pattern?: string): number[] {
+    // shared objects go before the slots of measure()
+    this.releaseAsmSlots();
+    return ms.load_shared_object_matching(filename, pattern ?? "");
+  }
+
+  /**
+   * Loads @param functionSymbol from the shared object in @param library, e.g. straight from the compiler's output,
+   * without writing it to disk. Each call opens a library of its own.
+   * @returns the id of the function
+   */
+  public loadSharedObjectBuffer(library: Uint8Array, functionSymbol: string): number {
+    // shared objects go before the slots of measure()
+    this.releaseAsmSlots();
+    return ms.load_shared_object_buffer(library, functionSymbol);
+  }
+
+  /**
+   * Loads the machine code in @param code, like a BIN file but without one.
+   * @returns the id of the function, for replaceBinary().
+   */
+  public loadBinary(code: Uint8Array): number {
+    // binaries go before the slots of measure()
+    this.releaseAsmSlots();
+    return ms.load_bin_buffer(code);
+  }
+
+  /**
+   * Replaces the code of the function @param id, as returned by loadBinary(), with the machine code in @param code.
+   */
+  public replaceBinary(id: number, code: Uint8Array): void {
+    ms.replace_bin_buffer(id, code);
+  }
+
   public setBounds(bounds: string[]): void {
     if (this.argwidth !== bounds.length) {
       throw new Error("Illegal arguments. Bounds array must be same size as argwidth, or empty.");
@@ -166,42 +382,149 @@ export class Measuresuite {
     ms.set_bounds(bounds_u64);
   }
 
+  /**
+   * Places the code of the function @param id @param offset bytes after a multiple of @param alignment, a power of two up to 4096.
+   * setPlacement(id, 0, 0) restores the default, the start of its cache-line aligned slot.
+   * Shared objects, and ELF code with absolute addresses into itself, cannot be moved. ELF code with aligned sections (e.g.
+   * .rodata of SSE code) only moves to offsets which are a multiple of that alignment.
+   */
+  public setPlacement(id: number, alignment: number, offset: number): void {
+    ms.set_placement(id, alignment, offset);
+  }
+
+  /**
+   * Places the inputs @param inOffset bytes into a 4 KiB page, and the outputs of each function @param outOffset bytes into a page of their own.
+   * Loads from the inputs are held up by stores to the outputs at the same offset into a page (4K aliasing); this keeps that distance fixed.
+   * Both must be multiples of 8 below 4096. Without arguments, the compact default layout is restored.
+   */
+  public setDataOffsets(inOffset = -1, outOffset = -1): void {
+    ms.set_data_offsets(inOffset, outOffset);
+  }
+
   public measure(batchSize: number, numBatches: number, functions: string[] = []): MeasureResult | null {
-    let result: string | undefined;
+    const result = this.measureTyped(batchSize, numBatches, functions);
+    return {
+      stats: {
+        numFunctions: result.stats.numFunctions,
+        runtime: result.stats.runtime,
+        incorrect: result.stats.incorrect,
+        timer: result.stats.timer,
+      },
+      functions: result.functions,
+      cycles: result.cycles.map((c) => Array.from(c, Number)),
+    };
+  }
 
+  /**
+   * Like measure(), but the cycles are BigUint64Arrays sharing the memory the native module measured into.
+   * This skips generating, copying and parsing JSON.
+   */
+  public measureTyped(batchSize: number, numBatches: number, functions: string[] = []): TypedMeasureResult {
+    this.loadAsmSlots(functions);
     try {
-      functions.forEach(ms.load_asm_string);
+      return ms.measure_typed(batchSize, numBatches) as TypedMeasureResult;
     } catch (e) {
-      console.error("Measuresuite: in measuresuite_measure, an error occurred while loading asm strings", e);
+      console.error("Measuresuite: in measuresuite_measure, an error occurred", e);
       throw new Error(`Could not measure.${e}`);
     }
+  }
 
+  /**
+   * Measures all functions (and @param functions, like measure()) at @param numOffsets offsets spread evenly over @param window bytes,
+   * to tell the speed of the code apart from the speed of its alignment. Placements set with setPlacement() are restored afterwards.
+   * @returns the median cycles of each function at each offset, and per function their spread and the fastest offset.
+   */
+  public measureSweep(
+    batchSize: number,
+    numBatches: number,
+    window = 64,
+    numOffsets = 8,
+    functions: string[] = [],
+  ): SweepResult {
+    this.loadAsmSlots(functions);
     try {
-      result = ms.measure(batchSize, numBatches);
+      return ms.measure_sweep(batchSize, numBatches, window, numOffsets) as SweepResult;
     } catch (e) {
-      console.error("Measuresuite: in measuresuite_measure, an error occurred", e);
+      console.error("Measuresuite: in measuresuite_measure_sweep, an error occurred", e);
       throw new Error(`Could not measure.${e}`);
     }
+  }
 
-    // unload them
+  /**
+   * Measures all functions (and @param functions, like measure()) with their outputs at @param numOffsets distances from the inputs,
+   * spread evenly over a 4 KiB page, to tell 4K aliasing apart from the cost of the code. Offsets set with setDataOffsets() are restored afterwards.
+   * @returns like measureSweep(), with the offsets being the distances (out - in) mod 4096.
+   */
+  public measureDataSweep(batchSize: number, numBatches: number, numOffsets = 64, functions: string[] = []): SweepResult {
+    this.loadAsmSlots(functions);
     try {
-      functions.forEach((_) => ms.unload_last());
+      return ms.measure_data_sweep(batchSize, numBatches, numOffsets) as SweepResult;
     } catch (e) {
-      console.error(
-        "Measuresuite: in measuresuite_measure, an error occurred while unloading the functions after measuremets",
-        e,
-      );
+      console.error("Measuresuite: in measuresuite_measure_data_sweep, an error occurred", e);
+      throw new Error(`Could not measure.${e}`);
+    }
+  }
+
+  /**
+   * Measures all functions (and @param functions, like measure()) with a working set of half of each cache level of cpu0, and of
+   * twice the last level, see setWorkingSet(). The working set is restored afterwards.
+   * @returns the median cycles per call of each function at each level.
+   */
+  public measureWorkingSetSweep(batchSize: number, numBatches: number, functions: string[] = []): WorkingSetResult {
+    this.loadAsmSlots(functions);
+    try {
+      return ms.measure_working_set_sweep(batchSize, numBatches) as WorkingSetResult;
+    } catch (e) {
+      console.error("Measuresuite: in measuresuite_measure_working_set_sweep, an error occurred", e);
       throw new Error(`Could not measure.${e}`);
     }
+  }
+
+  // settles once the last queued measureAsync() call has settled
+  private asyncQueue: Promise<unknown> = Promise.resolve();
 
-    if (result) {
+  /**
+   * Like measureTyped(), but measures on a worker thread, such that the event loop is not blocked.
+   * If @param cpu is given, that thread is pinned to that cpu while measuring.
+   * Calls are queued, each one starts after the previous one has settled.
+   * Calling any other method while a call is in flight throws.
+   */
+  public measureAsync(
+    batchSize: number,
+    numBatches: number,
+    functions: string[] = [],
+    cpu?: number,
+  ): Promise<TypedMeasureResult> {
+    const run = async (): Promise<TypedMeasureResult> => {
+      this.loadAsmSlots(functions);
       try {
-        return JSON.parse(result) as MeasureResult;
+        return (await (cpu === undefined
+          ? ms.measure_async(batchSize, numBatches)
+          : ms.measure_async(batchSize, numBatches, cpu))) as TypedMeasureResult;
       } catch (e) {
-        console.error(`While JSON.parse'ing an error occurred: I tried to parse: >>${result}<<`);
-        throw e;
+        console.error("Measuresuite: in measuresuite_measure_async, an error occurred", e);
+        throw new Error(`Could not measure.${e}`);
+      }
+    };
+    const measured = this.asyncQueue.then(run, run);
+    this.asyncQueue = measured.catch(() => undefined);
+    return measured;
+  }
+
+  // re-uses the slots of the previous call, only loads / unloads the difference
+  private loadAsmSlots(functions: string[]): void {
+    try {
+      this.releaseAsmSlots(functions.length);
+      const numReplaced = this.asmSlots.length;
+      if (numReplaced > 0) {
+        ms.replace_many(this.asmSlots, functions.slice(0, numReplaced));
+      }
+      if (functions.length > numReplaced) {
+        this.asmSlots.push(...ms.load_many(functions.slice(numReplaced)));
       }
+    } catch (e) {
+      console.error("Measuresuite: in measuresuite_measure, an error occurred while loading asm strings", e);
+      throw new Error(`Could not measure.${e}`);
     }
-    return null;
   }
 }
@@ -24,18 +24,49 @@ describe("native_ms", () => {
     const props = [
       "init",
       "load_asm_string",
+      "replace_asm_string",
+      "load_many",
+      "replace_many",
+      "set_max_asm_length",
       "load_asm_file",
       "load_bin_file",
+      "load_bin_buffer",
+      "replace_bin_buffer",
       "load_elf_file",
+      "load_archive_file",
       "load_shared_object_file",
+      "load_shared_object_matching",
+      "load_shared_object_buffer",
       "unload_all",
       "unload_last",
+      "unload_many",
       "enable_checking",
       "enable_chunk_counting",
+      "enable_asm_cache",
+      "enable_incremental_assembly",
+      "enable_result_cache",
+      "enable_layout_randomization",
+      "set_memory_options",
+      "set_aliasing",
+      "set_working_set",
+      "set_batch_callback",
       "set_bounds",
+      "set_placement",
+      "set_data_offsets",
       "measure",
+      "measure_typed",
+      "measure_sweep",
+      "measure_data_sweep",
+      "measure_working_set_sweep",
+      "measure_async",
       "destroy",
       "get_timer",
+      "get_asm_cache_stats",
+      "get_memory_status",
+      "get_assembly_time",
+      "get_result_cache_stats",
+      "save_result_cache",
+      "load_result_cache",
     ] as Array<keyof typeof native_ms>;
     props.forEach((property) => {
       expect(native_ms).toHaveProperty(property);
@@ -79,6 +79,9 @@ describe("general with test_lib", () => {
 
     // Function b, is bigger and uses instructions at certain addresses, such that it breaks chunks with three instructions
     expect((functionBRes as AsmFunctionSummary).chunks).toBe(3);
+    expect((functionBRes as AsmFunctionSummary).codeSize).toBeGreaterThan(
+      (functionARes as AsmFunctionSummary).codeSize,
+    );
 
     // this gives the entire runtime for all batches in milliseconds... Really depends on the system
     expect(measurementResult.stats.runtime).toBeGreaterThan(0);
@@ -82,4 +82,110 @@ describe("general with test_lib", () => {
       expect(r).toBeGreaterThanOrEqual(10);
     });
   });
+
+  it("should measure typed", () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    const numBatches = 20;
+    const result = ms.measureTyped(100, numBatches, [functionA, functionB]);
+
+    expect(result.stats.numFunctions).toBe(3);
+    expect(result.stats.numBatches).toBe(numBatches);
+    expect(result.stats.incorrect).toBe(0);
+    expect(result.functions.map((f) => f.type)).toEqual(["SHARED_OBJECT", "ASM", "ASM"]);
+    expect(result.cycles).toHaveLength(3);
+    result.cycles.forEach((c) => {
+      expect(c).toBeInstanceOf(BigUint64Array);
+      expect(c).toHaveLength(numBatches);
+    });
+    // views on the same memory
+    expect(result.cycles[1].buffer).toBe(result.cycles[0].buffer);
+  });
+
+  it("should measure async", async () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    const [first, second] = await Promise.all([
+      ms.measureAsync(100, 10, [functionA]),
+      ms.measureAsync(100, 10, [functionA, functionB]),
+    ]);
+    expect(first.stats.numFunctions).toBe(2);
+    expect(second.stats.numFunctions).toBe(3);
+    expect(second.stats.incorrect).toBe(0);
+  });
+
+  it("should report batches and stop early", async () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    const batches: number[] = [];
+    ms.onBatch((batch, cycles) => {
+      expect(cycles).toHaveLength(2);
+      batches.push(batch);
+      return "stop";
+    });
+    const result = await ms.measureAsync(100, 100000, [functionA]);
+    expect(result.stats.numBatches).toBe(1);
+    expect(batches).toEqual([0]);
+    ms.onBatch(null);
+  });
+
+  it("should stop a synchronous measurement on the batch asking for it", () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    const batches: number[] = [];
+    ms.onBatch((batch) => {
+      batches.push(batch);
+      // only exactly "stop" stops
+      return batch === 3 ? "stop" : "stopped";
+    });
+    const result = ms.measureTyped(100, 100, [functionA]);
+    expect(result.stats.numBatches).toBe(4);
+    expect(batches).toEqual([0, 1, 2, 3]);
+    ms.onBatch(null);
+  });
+
+  it("should throw what the batch callback throws", async () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    ms.onBatch((batch) => {
+      if (batch === 1) {
+        throw new Error("from the callback");
+      }
+    });
+    expect(() => ms.measureTyped(100, 10, [functionA])).toThrow("from the callback");
+    await expect(ms.measureAsync(100, 10, [functionA])).rejects.toThrow("from the callback");
+    ms.onBatch(null);
+  });
+
+  it("should reject calls from the batch callback while measuring", () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    let error = "";
+    ms.onBatch(() => {
+      try {
+        ms.loadBinary(new Uint8Array([0xc3]));
+      } catch (e) {
+        error = (e as Error).message;
+      }
+    });
+    const result = ms.measureTyped(100, 3, [functionA]);
+    expect(error).toMatch(/busy/);
+    expect(result.stats.numBatches).toBe(3);
+    expect(result.stats.incorrect).toBe(0);
+    ms.onBatch(null);
+  });
+
+  it("should limit the asm string length", () => {
+    const limited = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    limited.setMaxAsmLength(functionA.length - 1);
+    expect(() => limited.measureTyped(100, 10, [functionA])).toThrow();
+
+    const unlimited = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    unlimited.setMaxAsmLength(0);
+    const result = unlimited.measureTyped(100, 10, ["nop\n".repeat(300000) + functionA]);
+    expect(result.stats.incorrect).toBe(0);
+  });
+
+  it("should load and replace machine code from a buffer", () => {
+    const ms = new Measuresuite(width, numArgsIn, numArgsOut, chunkSize, [], sharedObject, "increment");
+    const ret = new Uint8Array([0xc3]);
+    const id = ms.loadBinary(ret);
+    expect(id).toBe(1);
+    ms.replaceBinary(id, new Uint8Array([0x90, 0xc3]));
+    expect(() => ms.replaceBinary(id + 1, ret)).toThrow();
+  });
 });